@@ -228,7 +228,7 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
     {
         /* bank-level update */
         openRow = activateRow;
-        state = DDR3BANK_OPEN;
+        ChangeState( DDR3BANK_OPEN );
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
     }
@@ -36,6 +36,8 @@
 #include "Banks/DDR3Bank/DDR3Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "EnergyModels/EnergyModelFactory.h"
 
 #include <signal.h>
 #include <cassert>
@@ -68,6 +70,7 @@ DDR3Bank::DDR3Bank( )
     MATHeight = 512;
 
     state = DDR3BANK_CLOSED;
+    lastStateChange = 0;
     lastActivate = 0;
     openRow = 0;
 
@@ -109,10 +112,14 @@ DDR3Bank::DDR3Bank( )
     worstCaseEndurance = 0;
 
     bankId = -1;
+    untouchedSubArrays = 0;
+
+    energyModel = NULL;
 }
 
 DDR3Bank::~DDR3Bank( )
 {
+    delete energyModel;
 }
 
 void DDR3Bank::SetConfig( Config *config, bool createChildren )
@@ -121,9 +128,10 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
     if( config->KeyExists( "MATWidth" ) )
         MATWidth = static_cast<ncounter_t>( config->GetValue( "MATWidth" ) );
 
-    Params *params = new Params( );
-    params->SetParams( config );
-    SetParams( params );
+    SetParams( config->GetParams( ) );
+
+    energyModel = EnergyModelFactory::CreateEnergyModel( p->EnergyModel );
+    energyModel->SetParams( p );
 
     MATHeight = p->MATHeight;
     subArrayNum = p->ROWS / MATHeight;
@@ -166,7 +174,7 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
 
 void DDR3Bank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         AddUnitStat(bankEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -209,6 +217,10 @@ void DDR3Bank::RegisterStats( )
 
     AddStat(averageEndurance);
     AddStat(worstCaseEndurance);
+
+    /* Untouched subarrays have no stats of their own in lazy mode. */
+    if( p->LazySubArrays )
+        AddStat(untouchedSubArrays);
 }
 
 /*
@@ -233,7 +245,7 @@ bool DDR3Bank::PowerDown( NVMainRequest *request )
         if( state == DDR3BANK_OPEN )
         {
             assert( request->type == POWERDOWN_PDA );
-            state = DDR3BANK_PDA;
+            ChangeState( DDR3BANK_PDA );
         }
         else if( state == DDR3BANK_CLOSED )
         {
@@ -241,15 +253,15 @@ bool DDR3Bank::PowerDown( NVMainRequest *request )
             {
                 case POWERDOWN_PDA:
                 case POWERDOWN_PDPF:
-                    state = DDR3BANK_PDPF;
+                    ChangeState( DDR3BANK_PDPF );
                     break;
 
                 case POWERDOWN_PDPS:
-                    state = DDR3BANK_PDPS;
+                    ChangeState( DDR3BANK_PDPS );
                     break;
 
                 default:
-                    state = DDR3BANK_PDPF;
+                    ChangeState( DDR3BANK_PDPF );
                     break;
             }
         }
@@ -298,9 +310,9 @@ bool DDR3Bank::PowerUp( NVMainRequest * /*request*/ )
          */
 
         if( state == DDR3BANK_PDA )
-            state = DDR3BANK_OPEN;
+            ChangeState( DDR3BANK_OPEN );
         else
-            state = DDR3BANK_CLOSED;
+            ChangeState( DDR3BANK_CLOSED );
 
         returnValue = true;
     }
@@ -346,21 +358,10 @@ bool DDR3Bank::Activate( NVMainRequest *request )
     request->address.GetTranslatedAddress( &activateRow, NULL, NULL, NULL, NULL, &activateSubArray );
 
     /* update the timing constraints */
-    if( request->isCIM && (request->isAND_IN_LATCH || request->isNAND_IN_LATCH))
-    {
-        nextPowerDown = MAX( nextPowerDown, 
-                            GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tAND );
-    }
-    else if( request->isCIM && (request->isOR_IN_LATCH || request->isNOR_IN_LATCH))
-    {
-        nextPowerDown = MAX( nextPowerDown, 
-                            GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tOR );
-    }
-    else
-    {
-        nextPowerDown = MAX( nextPowerDown, 
-                             GetEventQueue()->GetCurrentCycle() + p->tRCD );
-    } 
+    nextPowerDown = MAX( nextPowerDown, 
+                         GetEventQueue()->GetCurrentCycle() + p->tRCD 
+                         + p->GetCIMLatency( request ) );
+
     /* issue ACTIVATE to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
 
@@ -368,7 +369,7 @@ bool DDR3Bank::Activate( NVMainRequest *request )
     {
         /* bank-level update */
         openRow = activateRow;
-        state = DDR3BANK_OPEN;
+        ChangeState( DDR3BANK_OPEN );
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
     }
@@ -455,7 +456,7 @@ bool DDR3Bank::Read( NVMainRequest *request )
             }
 
             if( activeSubArrayQueue.empty() )
-                state = DDR3BANK_CLOSED;
+                ChangeState( DDR3BANK_CLOSED );
         } // if( request->type == READ_PRECHARGE )
 
         dataCycles += p->tBURST;
@@ -547,7 +548,7 @@ bool DDR3Bank::Write( NVMainRequest *request )
             }
 
             if( activeSubArrayQueue.empty( ) )
-                state = DDR3BANK_CLOSED;
+                ChangeState( DDR3BANK_CLOSED );
         }
     }
     else
@@ -670,7 +671,7 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
     } 
 
     if( activeSubArrayQueue.empty( ) )
-        state = DDR3BANK_CLOSED;
+        ChangeState( DDR3BANK_CLOSED );
 
     precharges++;
 
@@ -966,6 +967,11 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+bool DDR3Bank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 DDR3BankState DDR3Bank::GetState( ) 
 {
     return state;
@@ -984,7 +990,7 @@ void DDR3Bank::CalculatePower( )
         return;
     }
 
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         bankPower = ( bankEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
         activePower = ( activeEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
@@ -1036,6 +1042,8 @@ void DDR3Bank::CalculateStats( )
 {
     NVMObject::CalculateStats( );
 
+    UpdateStateCycles( );
+
     double idealBandwidth;
 
     idealBandwidth = (double)(p->CLK * p->RATE * p->BusWidth);
@@ -1047,9 +1055,17 @@ void DDR3Bank::CalculateStats( )
 
     bankEnergy = activeEnergy = burstEnergy = refreshEnergy 
                = 0.0f;
+    untouchedSubArrays = 0;
 
     for( unsigned saIdx = 0; saIdx < subArrayNum; saIdx++ )
     {
+        /* A subarray which was never used has no energy. */
+        if( !IsSubArrayMaterialized( saIdx ) )
+        {
+            untouchedSubArrays++;
+            continue;
+        }
+
         StatType saEstat  = GetStat( GetChild(saIdx), "subArrayEnergy" );
         StatType actEstat = GetStat( GetChild(saIdx), "activeEnergy" );
         StatType bstEstat = GetStat( GetChild(saIdx), "burstEnergy" );
@@ -1072,6 +1088,10 @@ void DDR3Bank::CalculateStats( )
     averageEndurance = 0;
     for( ncounter_t i = 0; i < GetChildCount( ); i++ )
     {
+        /* Unworn subarrays have no worst life and an average life of 0. */
+        if( !IsSubArrayMaterialized( i ) )
+            continue;
+
         StatType subArrayWorstEndr = GetStat( GetChild(i), "worstCaseEndurance" );
         StatType subArrayAverageEndr = GetStat( GetChild(i), "averageEndurance" );
 
@@ -1083,6 +1103,13 @@ void DDR3Bank::CalculateStats( )
 }
 
 
+bool DDR3Bank::IsSubArrayMaterialized( ncounter_t saIdx )
+{
+    SubArray *subArray = dynamic_cast<SubArray *>( GetChild( saIdx )->GetTrampoline( ) );
+
+    return ( subArray == NULL || subArray->IsMaterialized( ) );
+}
+
 bool DDR3Bank::Idle( )
 {
     bool bankIdle = true;
@@ -1098,8 +1125,26 @@ bool DDR3Bank::Idle( )
     return bankIdle;
 }
 
-void DDR3Bank::Cycle( ncycle_t steps )
+void DDR3Bank::Cycle( ncycle_t /*steps*/ )
+{
+    /* State cycles are counted at state transitions, see ChangeState. */
+}
+
+void DDR3Bank::ChangeState( DDR3BankState nextState )
 {
+    UpdateStateCycles( );
+
+    state = nextState;
+}
+
+/* Charge the cycles since the last state transition to the current state. */
+void DDR3Bank::UpdateStateCycles( )
+{
+    ncycle_t currentCycle = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t steps = currentCycle - lastStateChange;
+
+    lastStateChange = currentCycle;
+
     /* Count cycle numbers for each state */
     /* Number of fast exit prechage standbys */
     if( state == DDR3BANK_PDPF )
@@ -1116,3 +1161,88 @@ void DDR3Bank::Cycle( ncycle_t steps )
     else if( state == DDR3BANK_CLOSED )
         standbyCycles += steps;
 }
+
+void DDR3Bank::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter writer( dir, StatName( ) );
+    std::vector<ncounter_t> activeSubArrays( activeSubArrayQueue.begin( ), 
+                                             activeSubArrayQueue.end( ) );
+
+    writer.Write( subArrayNum );
+    writer.WriteArray( activeSubArrays.empty( ) ? NULL : &activeSubArrays[0],
+                       activeSubArrays.size( ) );
+    writer.Write( state );
+    writer.Write( lastStateChange );
+    writer.Write( nextCommand );
+    writer.Write( dataCycles );
+    writer.Write( activeCycles );
+    writer.Write( standbyCycles );
+    writer.Write( fastExitActiveCycles );
+    writer.Write( fastExitPrechargeCycles );
+    writer.Write( slowExitPrechargeCycles );
+    writer.Write( powerCycles );
+    writer.Write( lastActivate );
+    writer.Write( nextActivate );
+    writer.Write( nextPrecharge );
+    writer.Write( nextRead );
+    writer.Write( nextWrite );
+    writer.Write( nextRefresh );
+    writer.Write( nextRefreshDone );
+    writer.Write( nextPowerDown );
+    writer.Write( nextPowerDownDone );
+    writer.Write( nextPowerUp );
+    writer.Write( writeCycle );
+    writer.Write( idleTimer );
+    writer.Write( openRow );
+    writer.Write( untouchedSubArrays );
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void DDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+    ncounter_t savedSubArrays;
+    uint64_t activeCount;
+
+    reader.Read( savedSubArrays );
+    reader.Expect( savedSubArrays, subArrayNum, "subarrays per bank" );
+
+    /* The queue length is not fixed, so read it element by element. */
+    reader.Read( activeCount );
+    activeSubArrayQueue.clear( );
+    for( uint64_t i = 0; i < activeCount; i++ )
+    {
+        ncounter_t subArray;
+
+        reader.Read( subArray );
+        activeSubArrayQueue.push_back( subArray );
+    }
+
+    reader.Read( state );
+    reader.Read( lastStateChange );
+    reader.Read( nextCommand );
+    reader.Read( dataCycles );
+    reader.Read( activeCycles );
+    reader.Read( standbyCycles );
+    reader.Read( fastExitActiveCycles );
+    reader.Read( fastExitPrechargeCycles );
+    reader.Read( slowExitPrechargeCycles );
+    reader.Read( powerCycles );
+    reader.Read( lastActivate );
+    reader.Read( nextActivate );
+    reader.Read( nextPrecharge );
+    reader.Read( nextRead );
+    reader.Read( nextWrite );
+    reader.Read( nextRefresh );
+    reader.Read( nextRefreshDone );
+    reader.Read( nextPowerDown );
+    reader.Read( nextPowerDownDone );
+    reader.Read( nextPowerUp );
+    reader.Read( writeCycle );
+    reader.Read( idleTimer );
+    reader.Read( openRow );
+    reader.Read( untouchedSubArrays );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
@@ -42,6 +42,7 @@
 #include "src/Bank.h"
 #include "src/Config.h"
 #include "src/EnduranceModel.h"
+#include "src/EnergyModel.h"
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/SubArray.h"
@@ -82,6 +83,7 @@ class DDR3Bank : public Bank
 
     virtual bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     virtual bool IssueCommand( NVMainRequest *req );
+    virtual bool IssueAtomic( NVMainRequest *req );
     virtual ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void SetConfig( Config *c, bool createChildren = true );
@@ -102,6 +104,9 @@ class DDR3Bank : public Bank
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
     virtual ncounter_t GetId( );
     virtual std::string GetName( );
 
@@ -114,6 +119,7 @@ class DDR3Bank : public Bank
     ncounter_t subArrayNum;
 
     DDR3BankState state;
+    ncycle_t lastStateChange;
     BulkCommand nextCommand;
     NVMainRequest lastOperation;
 
@@ -164,6 +170,9 @@ class DDR3Bank : public Bank
     uint64_t openRow;
 
     ncounter_t bankId;
+    ncounter_t untouchedSubArrays;
+
+    EnergyModel *energyModel;
  
     virtual bool Activate( NVMainRequest *request );
     virtual bool Read( NVMainRequest *request );
@@ -172,6 +181,10 @@ class DDR3Bank : public Bank
     virtual bool Refresh( NVMainRequest *request );
     virtual bool PowerUp( NVMainRequest *request );
     virtual bool PowerDown( NVMainRequest *request );
+
+    void ChangeState( DDR3BankState nextState );
+    bool IsSubArrayMaterialized( ncounter_t saIdx );
+    void UpdateStateCycles( );
 };
 
 };
@@ -0,0 +1,99 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/Coset/Coset.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+Coset::Coset( )
+{
+}
+
+Coset::~Coset( )
+{
+}
+
+void Coset::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    SetParams( config->GetParams( ) );
+
+    uint64_t granularity = 64;
+    if( config->KeyExists( "CosetGranularity" ) )
+        config->GetValueUL( "CosetGranularity", granularity );
+
+    uint64_t count = 4;
+    if( config->KeyExists( "CosetCount" ) )
+        config->GetValueUL( "CosetCount", count );
+
+    if( count < 2 || count > 256 )
+    {
+        std::cerr << "NVMain Error: CosetCount must be between 2 and 256." << std::endl;
+        exit(1);
+    }
+
+    SetPartitions( "CosetGranularity", granularity, count );
+
+    /* 
+     *  Every subarray draws the same cosets, so the seed should be a known
+     *  constant if you wish to reproduce results.
+     */
+    uint64_t seedValue = 1;
+    if( config->KeyExists( "CosetSeed" ) )
+        config->GetValueUL( "CosetSeed", seedValue );
+    unsigned int seed = static_cast<unsigned int>( seedValue );
+
+    uint64_t partitionMask = (partitionBits == 64) ? ~0ULL : ((1ULL << partitionBits) - 1);
+
+    cosets.resize( count );
+    cosets[0] = 0;
+    cosets[1] = partitionMask;
+
+    for( uint64_t idx = 2; idx < count; idx++ )
+    {
+        uint64_t coset = 0;
+
+        /* rand_r gives at least 15 random bits per call. */
+        for( int draw = 0; draw < 5; draw++ )
+            coset = (coset << 15) ^ static_cast<uint64_t>( ::rand_r( &seed ) );
+
+        cosets[idx] = coset & partitionMask;
+    }
+}
+
+uint64_t Coset::Encode( uint64_t value, uint64_t candidate )
+{
+    return value ^ cosets[candidate];
+}
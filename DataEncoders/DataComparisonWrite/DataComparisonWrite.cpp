@@ -0,0 +1,98 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/DataComparisonWrite/DataComparisonWrite.h"
+
+using namespace NVM;
+
+DataComparisonWrite::DataComparisonWrite( )
+{
+    wordSize = 0;
+    bitCounter = NULL;
+
+    bitsFlipped = 0;
+    silentBits = 0;
+    dataComparisonReduction = 0.0;
+}
+
+DataComparisonWrite::~DataComparisonWrite( )
+{
+}
+
+void DataComparisonWrite::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    SetParams( config->GetParams( ) );
+
+    wordSize = p->BusWidth;
+    wordSize *= p->tBURST * p->RATE;
+    wordSize /= 8;
+
+    /* The subarray has already checked the method is supported. */
+    bitCounter = GetBitCountKernel( p->BitCountMethod );
+}
+
+void DataComparisonWrite::RegisterStats( )
+{
+    AddStat(bitsFlipped);
+    AddStat(silentBits);
+    AddUnitStat(dataComparisonReduction, "%");
+}
+
+ncycle_t DataComparisonWrite::Read( NVMainRequest* /*request*/ )
+{
+    return 0;
+}
+
+ncycle_t DataComparisonWrite::Write( NVMainRequest *request )
+{
+    ncounter_t counts[2];
+
+    newLine.Load( request->data, wordSize );
+    oldLine.Load( request->oldData, wordSize );
+
+    bitCounter->countWrittenCells( newLine.GetData( ), oldLine.GetData( ), 
+                                   wordSize, counts );
+
+    bitsFlipped += counts[0] + counts[1];
+    silentBits += wordSize * 8 - counts[0] - counts[1];
+
+    return 0;
+}
+
+void DataComparisonWrite::CalculateStats( )
+{
+    if( bitsFlipped + silentBits != 0 )
+        dataComparisonReduction = (((double)bitsFlipped / (double)(bitsFlipped + silentBits))*100.0);
+    else
+        dataComparisonReduction = 100.0;
+}
@@ -37,6 +37,9 @@
 
 /* Add your decoder's include file below. */
 #include "DataEncoders/FlipNWrite/FlipNWrite.h"
+#include "DataEncoders/DataComparisonWrite/DataComparisonWrite.h"
+#include "DataEncoders/MinShift/MinShift.h"
+#include "DataEncoders/Coset/Coset.h"
 
 using namespace NVM;
 
@@ -46,6 +49,9 @@ DataEncoder *DataEncoderFactory::CreateDataEncoder( std::string encoderName )
 
     if( encoderName == "default" ) encoder = new DataEncoder( );
     else if( encoderName == "FlipNWrite" ) encoder = new FlipNWrite( );
+    else if( encoderName == "DataComparisonWrite" ) encoder = new DataComparisonWrite( );
+    else if( encoderName == "MinShift" ) encoder = new MinShift( );
+    else if( encoderName == "Coset" ) encoder = new Coset( );
 
     return encoder;
 }
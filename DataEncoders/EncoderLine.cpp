@@ -0,0 +1,151 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/EncoderLine.h"
+
+#include <cstring>
+
+using namespace NVM;
+
+namespace {
+
+inline uint64_t LowMask( ncounter_t bits )
+{
+    return (bits >= 64) ? ~0ULL : ((1ULL << bits) - 1);
+}
+
+/* Mask of the bits of word 'word' that fall in [startBit, endBit). */
+inline uint64_t RangeMask( ncounter_t word, ncounter_t startBit, ncounter_t endBit )
+{
+    ncounter_t first = word * 64;
+    uint64_t mask = ~0ULL;
+
+    if( startBit > first )
+        mask &= ~LowMask( startBit - first );
+    if( endBit < first + 64 )
+        mask &= LowMask( endBit - first );
+
+    return mask;
+}
+
+}
+
+EncoderLine::EncoderLine( )
+{
+    bytes = 0;
+}
+
+EncoderLine::~EncoderLine( )
+{
+}
+
+void EncoderLine::Load( NVMDataBlock& block, ncounter_t lineBytes )
+{
+    bytes = lineBytes;
+
+    /* The vector keeps its capacity, so only the first load allocates. */
+    words.assign( (bytes + 7) / 8 + 1, 0 );
+
+    if( block.IsValid( ) && block.rawData != NULL )
+    {
+        ncounter_t copyBytes = (block.GetSize( ) < bytes) ? block.GetSize( ) : bytes;
+
+        memcpy( &words[0], block.rawData, copyBytes );
+    }
+}
+
+void EncoderLine::Store( NVMDataBlock& block ) const
+{
+    if( block.rawData == NULL )
+        block.SetSize( bytes );
+
+    ncounter_t copyBytes = (block.GetSize( ) < bytes) ? block.GetSize( ) : bytes;
+
+    memcpy( block.rawData, &words[0], copyBytes );
+    block.SetValid( true );
+}
+
+const uint8_t *EncoderLine::GetData( ) const
+{
+    return reinterpret_cast<const uint8_t *>( &words[0] );
+}
+
+uint64_t EncoderLine::GetBits( ncounter_t startBit, ncounter_t bits ) const
+{
+    ncounter_t word = startBit / 64;
+    ncounter_t shift = startBit % 64;
+    uint64_t value = words[word] >> shift;
+
+    if( shift != 0 && shift + bits > 64 )
+        value |= words[word + 1] << (64 - shift);
+
+    return value & LowMask( bits );
+}
+
+void EncoderLine::SetBits( ncounter_t startBit, ncounter_t bits, uint64_t value )
+{
+    ncounter_t word = startBit / 64;
+    ncounter_t shift = startBit % 64;
+    uint64_t mask = LowMask( bits );
+
+    value &= mask;
+
+    words[word] = (words[word] & ~(mask << shift)) | (value << shift);
+
+    if( shift != 0 && shift + bits > 64 )
+    {
+        words[word + 1] = (words[word + 1] & ~(mask >> (64 - shift)))
+                        | (value >> (64 - shift));
+    }
+}
+
+void EncoderLine::InvertBits( ncounter_t startBit, ncounter_t endBit )
+{
+    for( ncounter_t word = startBit / 64; word * 64 < endBit; word++ )
+        words[word] ^= RangeMask( word, startBit, endBit );
+}
+
+ncounter_t EncoderLine::CountChangedBits( const EncoderLine& other, ncounter_t startBit,
+                                          ncounter_t endBit ) const
+{
+    ncounter_t count = 0;
+
+    for( ncounter_t word = startBit / 64; word * 64 < endBit; word++ )
+    {
+        uint64_t diff = (words[word] ^ other.words[word]) & RangeMask( word, startBit, endBit );
+
+        count += __builtin_popcountll( diff );
+    }
+
+    return count;
+}
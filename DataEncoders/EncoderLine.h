@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_ENCODERLINE_H__
+#define __NVMAIN_ENCODERLINE_H__
+
+#include "include/NVMDataBlock.h"
+#include "include/NVMTypes.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  A memory word held as 64-bit words so the data encoders can compare and
+ *  transform it a word or a partition at a time. Bit i of the line is bit
+ *  i % 8 of byte i / 8, as in the byte-wise code this replaces.
+ */
+class EncoderLine
+{
+  public:
+    EncoderLine( );
+    ~EncoderLine( );
+
+    /* Copy the first bytes of block. Bytes the block does not hold read as 0. */
+    void Load( NVMDataBlock& block, ncounter_t bytes );
+
+    /* Copy the line back, sizing block first if it has no data yet. */
+    void Store( NVMDataBlock& block ) const;
+
+    ncounter_t GetBytes( ) const { return bytes; }
+    const uint8_t *GetData( ) const;
+
+    /* Up to 64 bits starting at any bit of the line. */
+    uint64_t GetBits( ncounter_t startBit, ncounter_t bits ) const;
+    void SetBits( ncounter_t startBit, ncounter_t bits, uint64_t value );
+
+    void InvertBits( ncounter_t startBit, ncounter_t endBit );
+
+    /* Number of bits in [startBit, endBit) that differ from other. */
+    ncounter_t CountChangedBits( const EncoderLine& other, ncounter_t startBit,
+                                 ncounter_t endBit ) const;
+
+  private:
+    /* One word more than needed, so unaligned reads never go past the end. */
+    std::vector<uint64_t> words;
+    ncounter_t bytes;
+};
+
+};
+
+#endif
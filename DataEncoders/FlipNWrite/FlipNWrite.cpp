@@ -34,16 +34,16 @@
 #include "DataEncoders/FlipNWrite/FlipNWrite.h"
 
 #include <iostream>
+#include <cstdlib>
 
 using namespace NVM;
 
 FlipNWrite::FlipNWrite( )
 {
-    flippedAddresses.clear( );
-
     /* Clear statistics */
     bitsFlipped = 0;
     bitCompareSwapWrites = 0;
+    flipNWriteReduction = 0.0;
 }
 
 FlipNWrite::~FlipNWrite( )
@@ -56,9 +56,7 @@ FlipNWrite::~FlipNWrite( )
 
 void FlipNWrite::SetConfig( Config *config, bool /*createChildren*/ )
 {
-    Params *params = new Params( );
-    params->SetParams( config );
-    SetParams( params );
+    SetParams( config->GetParams( ) );
 
     /* Cache granularity size. */
     fpSize = config->GetValue( "FlipNWriteGranularity" );
@@ -66,53 +64,27 @@ void FlipNWrite::SetConfig( Config *config, bool /*createChildren*/ )
     /* Some default size if the parameter is not specified */
     if( fpSize == -1 )
         fpSize = 32; 
-}
-
-void FlipNWrite::RegisterStats( )
-{
-    AddStat(bitsFlipped);
-    AddStat(bitCompareSwapWrites);
-    AddUnitStat(flipNWriteReduction, "%");
-}
-
-void FlipNWrite::InvertData( NVMDataBlock& data, uint64_t startBit, uint64_t endBit )
-{
-    uint64_t wordSize;
-    int startByte, endByte;
 
     wordSize = p->BusWidth;
     wordSize *= p->tBURST * p->RATE;
     wordSize /= 8;
 
-    startByte = (int)(startBit / 8);
-    endByte = (int)((endBit - 1) / 8);
-
-    for( int i = startByte; i <= endByte; i++ )
+    if( fpSize <= 0 || static_cast<uint64_t>(fpSize) > wordSize * 8 )
     {
-        uint8_t originalByte = data.GetByte( i );
-        uint8_t shiftByte = originalByte;
-        uint8_t newByte = 0;
-
-        for( int j = 0; j < 8; j++ )
-        {
-            uint64_t currentBit = i * 8 + j;
-           
-            if( currentBit < startBit || currentBit >= endBit )
-            {
-                shiftByte = static_cast<uint8_t>(shiftByte >> 1);
-                continue;
-            }
-
-            if( !(shiftByte & 0x1) )
-            {
-                newByte = static_cast<uint8_t>(newByte | (1 << (7-j)));
-            }
+        std::cerr << "NVMain Error: FlipNWriteGranularity must be between 1 and "
+                  << wordSize * 8 << " bits." << std::endl;
+        exit(1);
+    }
 
-            shiftByte = static_cast<uint8_t>(shiftByte >> 1);
-        }
+    flipPartitions = ( wordSize * 8 ) / fpSize; 
+    maskWords = ( flipPartitions + 63 ) / 64;
+}
 
-        data.SetByte( i, newByte );
-    }
+void FlipNWrite::RegisterStats( )
+{
+    AddStat(bitsFlipped);
+    AddStat(bitCompareSwapWrites);
+    AddUnitStat(flipNWriteReduction, "%");
 }
 
 ncycle_t FlipNWrite::Read( NVMainRequest* /*request*/ )
@@ -126,143 +98,66 @@ ncycle_t FlipNWrite::Read( NVMainRequest* /*request*/ )
 
 ncycle_t FlipNWrite::Write( NVMainRequest *request ) 
 {
-    NVMDataBlock& newData = request->data;
-    NVMDataBlock& oldData = request->oldData;
-    NVMAddress address = request->address;
-
-    /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
-     *  It is up to you to ensure there are no collisions here.
-     */
     uint64_t row;
     uint64_t col;
     ncycle_t rv = 0;
 
     request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
 
-    /*
-     *  If using the default life map, we can call the DecrementLife
-     *  function which will check if the map_key already exists. If so,
-     *  the life value is decremented (write count incremented). Otherwise 
-     *  the map_key is inserted with a write count of 1.
-     */
-    uint64_t rowSize;
-    uint64_t wordSize;
-    uint64_t currentBit;
-    uint64_t flipPartitions;
-    uint64_t rowPartitions;
-    int *modifyCount;
-
-    wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
-    wordSize /= 8;
-
-    rowSize = p->COLS * wordSize;
-    rowPartitions = ( rowSize * 8 ) / fpSize;
-    
-    flipPartitions = ( wordSize * 8 ) / fpSize; 
-
-    modifyCount = new int[ flipPartitions ];
-
-    /*
-     *  Count the number of bits that are modified. If it is more than
-     *  half, then we will invert the data then write.
-     */
-    for( uint64_t i = 0; i < flipPartitions; i++ )
-        modifyCount[i] = 0;
-
-    currentBit = 0;
+    newLine.Load( request->data, wordSize );
+    oldLine.Load( request->oldData, wordSize );
 
-    /* Get what is currently in the memory (i.e., if it was previously flipped, get the flipped data. */
-    for( uint64_t i = 0; i < flipPartitions; i++ )
+    /* The flip bits of up to 64 partitions are looked up at once. */
+    for( uint64_t first = 0; first < flipPartitions; first += 64 )
     {
-        uint64_t curAddr = row * rowPartitions + col * flipPartitions + i;
+        uint64_t key = (row * p->COLS + col) * maskWords + first / 64;
+        uint64_t last = (first + 64 < flipPartitions) ? first + 64 : flipPartitions;
 
-        if( flippedAddresses.count( curAddr ) )
-        {
-            InvertData( oldData, i*fpSize, (i+1)*fpSize );
-        }
-    }
+        FlipMap::iterator it = flippedWords.find( key );
+        uint64_t flipped = (it == flippedWords.end( )) ? 0 : it->second;
+        uint64_t newFlipped = 0;
 
-    /* Check each byte to see if it was modified */
-    for( uint64_t i = 0; i < wordSize; ++i )
-    {
-        /*
-         *  If no bytes have changed we can just continue. Yes, I know this
-         *  will check the byte 8 times, but i'd rather not change the iter.
-         */
-        uint8_t oldByte, newByte;
-
-        oldByte = oldData.GetByte( i );
-        newByte = newData.GetByte( i );
-
-        if( oldByte == newByte )
-        {
-            currentBit += 8;
-            continue;
-        }
-
-        /*
-         *  If the bytes are different, then at least one bit has changed.
-         *  check each bit individually.
-         */
-        for( int j = 0; j < 8; j++ )
-        {
-            uint8_t oldBit, newBit;
-
-            oldBit = ( oldByte >> j ) & 0x1;
-            newBit = ( newByte >> j ) & 0x1;
-
-            if( oldBit != newBit )
-            {
-                modifyCount[(int)(currentBit/fpSize)]++;
-            }
-
-            currentBit++;
-        }
-    }
-
-    /*
-     *  Flip any partitions as needed and mark them as inverted or not.
-     */
-    for( uint64_t i = 0; i < flipPartitions; i++ )
-    {
-        bitCompareSwapWrites += modifyCount[i];
-
-        uint64_t curAddr = row * rowPartitions + col * flipPartitions + i;
-
-        /* Invert if more than half of the bits are modified. */
-        if( modifyCount[i] > (fpSize / 2) )
+        for( uint64_t i = first; i < last; i++ )
         {
-            InvertData( newData, i*fpSize, (i+1)*fpSize );
+            uint64_t flipBit = 1ULL << (i - first);
 
-            bitsFlipped += (fpSize - modifyCount[i]);
+            /* Get what is currently in the memory (i.e., if it was previously flipped, get the flipped data. */
+            if( flipped & flipBit )
+                oldLine.InvertBits( i*fpSize, (i+1)*fpSize );
 
             /*
-             *  Mark this address as flipped. If the data was already inverted, it
-             *  should remain as inverted for the new data.
+             *  Count the number of bits that are modified. If it is more than
+             *  half, then we will invert the data then write.
              */
-            if( !flippedAddresses.count( curAddr ) )
+            uint64_t modifyCount = newLine.CountChangedBits( oldLine, i*fpSize, (i+1)*fpSize );
+
+            bitCompareSwapWrites += modifyCount;
+
+            if( modifyCount > static_cast<uint64_t>(fpSize / 2) )
             {
-                flippedAddresses.insert( curAddr );
+                newLine.InvertBits( i*fpSize, (i+1)*fpSize );
+                newFlipped |= flipBit;
+
+                bitsFlipped += (fpSize - modifyCount);
             }
-        }
-        else
-        {
-            /*
-             *  This data is not inverted and should not be marked as such.
-             */
-            if( flippedAddresses.count( curAddr ) )
+            else
             {
-                flippedAddresses.erase( curAddr );
+                bitsFlipped += modifyCount;
             }
-
-            bitsFlipped += modifyCount[i];
         }
+
+        /* Only words with a flipped partition are kept. */
+        if( newFlipped != 0 && it != flippedWords.end( ) )
+            it->second = newFlipped;
+        else if( newFlipped != 0 )
+            flippedWords[key] = newFlipped;
+        else if( it != flippedWords.end( ) )
+            flippedWords.erase( it );
     }
 
-    delete modifyCount;
+    /* Leave what is stored in the memory in the request for the cell writes. */
+    newLine.Store( request->data );
+    oldLine.Store( request->oldData );
     
     return rv;
 }
@@ -274,3 +169,42 @@ void FlipNWrite::CalculateStats( )
     else
         flipNWriteReduction = 100.0;
 }
+
+/* Checkpoints list the flipped partitions as before. */
+void FlipNWrite::WriteCheckpoint( CheckpointWriter& writer )
+{
+    std::set< uint64_t > flippedAddresses;
+    FlipMap::iterator it;
+
+    for( it = flippedWords.begin( ); it != flippedWords.end( ); it++ )
+    {
+        uint64_t word = it->first / maskWords;
+        uint64_t first = (it->first % maskWords) * 64;
+
+        for( uint64_t bit = 0; bit < 64; bit++ )
+        {
+            if( it->second & (1ULL << bit) )
+                flippedAddresses.insert( word * flipPartitions + first + bit );
+        }
+    }
+
+    writer.Write( flippedAddresses );
+}
+
+void FlipNWrite::ReadCheckpoint( CheckpointReader& reader )
+{
+    std::set< uint64_t > flippedAddresses;
+    std::set< uint64_t >::iterator it;
+
+    reader.Read( flippedAddresses );
+
+    flippedWords.clear( );
+
+    for( it = flippedAddresses.begin( ); it != flippedAddresses.end( ); it++ )
+    {
+        uint64_t word = *it / flipPartitions;
+        uint64_t partition = *it % flipPartitions;
+
+        flippedWords[word * maskWords + partition / 64] |= 1ULL << (partition % 64);
+    }
+}
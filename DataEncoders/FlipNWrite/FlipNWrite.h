@@ -35,7 +35,9 @@
 #define __NVMAIN_FLIPNWRITE_H__
 
 #include "src/DataEncoder.h"
+#include "DataEncoders/EncoderLine.h"
 #include <set>
+#include <unordered_map>
 
 namespace NVM {
 
@@ -50,18 +52,28 @@ class FlipNWrite : public DataEncoder
     ncycle_t Read( NVMainRequest *request );
     ncycle_t Write( NVMainRequest *request );
 
+    bool DifferentialWrite( ) { return true; }
+
     void RegisterStats( );
     void CalculateStats( );
 
+    void WriteCheckpoint( CheckpointWriter& writer );
+    void ReadCheckpoint( CheckpointReader& reader );
+
   private:
-    std::set< uint64_t > flippedAddresses;
-  
+    /* Flip bits of each memory word, 64 partitions per entry. */
+    typedef std::unordered_map< uint64_t, uint64_t > FlipMap;
+    FlipMap flippedWords;
+
     uint64_t bitsFlipped;
     uint64_t bitCompareSwapWrites;
     double flipNWriteReduction;
     int fpSize;
+    uint64_t wordSize;
+    uint64_t flipPartitions;
+    uint64_t maskWords;
 
-    void InvertData( NVMDataBlock &data, uint64_t startBit, uint64_t endBit );
+    EncoderLine newLine, oldLine;
 };
 
 };
@@ -0,0 +1,87 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/MinShift/MinShift.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+MinShift::MinShift( )
+{
+    partitionMask = 0;
+}
+
+MinShift::~MinShift( )
+{
+}
+
+void MinShift::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    SetParams( config->GetParams( ) );
+
+    uint64_t granularity = 32;
+    if( config->KeyExists( "MinShiftGranularity" ) )
+        config->GetValueUL( "MinShiftGranularity", granularity );
+
+    uint64_t shifts = 4;
+    if( config->KeyExists( "MinShiftShifts" ) )
+        config->GetValueUL( "MinShiftShifts", shifts );
+
+    if( shifts == 0 || shifts > granularity )
+    {
+        std::cerr << "NVMain Error: MinShiftShifts must be between 1 and "
+                  << "MinShiftGranularity." << std::endl;
+        exit(1);
+    }
+
+    /* Each shift amount is tried as is and inverted. */
+    SetPartitions( "MinShiftGranularity", granularity, shifts * 2 );
+
+    partitionMask = (partitionBits == 64) ? ~0ULL : ((1ULL << partitionBits) - 1);
+}
+
+uint64_t MinShift::Encode( uint64_t value, uint64_t candidate )
+{
+    uint64_t shift = candidate >> 1;
+    uint64_t encoded = value;
+
+    if( shift != 0 )
+        encoded = ((value >> shift) | (value << (partitionBits - shift))) & partitionMask;
+
+    if( candidate & 1 )
+        encoded = ~encoded & partitionMask;
+
+    return encoded;
+}
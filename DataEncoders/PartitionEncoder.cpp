@@ -0,0 +1,208 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/PartitionEncoder.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+#include <cassert>
+
+using namespace NVM;
+
+PartitionEncoder::PartitionEncoder( )
+{
+    partitionBits = 0;
+    candidates = 1;
+    wordSize = 0;
+    wordPartitions = 0;
+
+    bitsFlipped = 0;
+    bitCompareSwapWrites = 0;
+    tagBitsFlipped = 0;
+    encodingReduction = 0.0;
+}
+
+PartitionEncoder::~PartitionEncoder( )
+{
+}
+
+void PartitionEncoder::SetPartitions( std::string granularityKey, uint64_t bits, 
+                                      uint64_t count )
+{
+    wordSize = p->BusWidth;
+    wordSize *= p->tBURST * p->RATE;
+    wordSize /= 8;
+
+    if( bits == 0 || bits > 64 || bits > wordSize * 8 )
+    {
+        std::cerr << "NVMain Error: " << granularityKey << " must be between 1 and "
+                  << ((wordSize * 8 < 64) ? wordSize * 8 : 64) << " bits." << std::endl;
+        exit(1);
+    }
+
+    /* Candidates are kept in a byte per partition. */
+    assert( count >= 1 && count <= 256 );
+
+    partitionBits = bits;
+    candidates = count;
+
+    /* Bits past the last full partition are written as is. */
+    wordPartitions = ( wordSize * 8 ) / partitionBits;
+}
+
+void PartitionEncoder::RegisterStats( )
+{
+    AddStat(bitsFlipped);
+    AddStat(bitCompareSwapWrites);
+    AddStat(tagBitsFlipped);
+    AddUnitStat(encodingReduction, "%");
+}
+
+ncycle_t PartitionEncoder::Read( NVMainRequest* /*request*/ )
+{
+    return 0;
+}
+
+ncycle_t PartitionEncoder::Write( NVMainRequest *request )
+{
+    uint64_t row;
+    uint64_t col;
+
+    request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
+
+    newLine.Load( request->data, wordSize );
+    oldLine.Load( request->oldData, wordSize );
+
+    uint64_t wordAddr = row * p->COLS + col;
+    EncodingMap::iterator it = encodings.find( wordAddr );
+    bool encoded = false;
+
+    for( uint64_t i = 0; i < wordPartitions; i++ )
+    {
+        uint64_t startBit = i * partitionBits;
+        uint64_t current = (it == encodings.end( )) ? 0 : it->second[i];
+
+        /* What is currently in the memory. */
+        uint64_t newValue = newLine.GetBits( startBit, partitionBits );
+        uint64_t oldValue = Encode( oldLine.GetBits( startBit, partitionBits ), current );
+
+        uint64_t best = 0;
+        uint64_t bestValue = newValue;
+        uint64_t bestCost = std::numeric_limits<uint64_t>::max( );
+
+        for( uint64_t candidate = 0; candidate < candidates; candidate++ )
+        {
+            uint64_t encodedValue = Encode( newValue, candidate );
+            uint64_t cost = __builtin_popcountll( encodedValue ^ oldValue )
+                          + __builtin_popcountll( candidate ^ current );
+
+            if( cost < bestCost )
+            {
+                best = candidate;
+                bestValue = encodedValue;
+                bestCost = cost;
+            }
+        }
+
+        bitCompareSwapWrites += __builtin_popcountll( newValue ^ oldValue );
+        bitsFlipped += __builtin_popcountll( bestValue ^ oldValue );
+        tagBitsFlipped += __builtin_popcountll( best ^ current );
+
+        newLine.SetBits( startBit, partitionBits, bestValue );
+        oldLine.SetBits( startBit, partitionBits, oldValue );
+
+        if( best != 0 && it == encodings.end( ) )
+            it = encodings.insert( std::make_pair( wordAddr, std::vector<uint8_t>( wordPartitions, 0 ) ) ).first;
+
+        if( it != encodings.end( ) )
+            it->second[i] = static_cast<uint8_t>( best );
+
+        encoded = encoded || (best != 0);
+    }
+
+    /* Only words with an encoded partition are kept. */
+    if( !encoded && it != encodings.end( ) )
+        encodings.erase( it );
+
+    /* Leave what is stored in the memory in the request for the cell writes. */
+    newLine.Store( request->data );
+    oldLine.Store( request->oldData );
+
+    return 0;
+}
+
+void PartitionEncoder::CalculateStats( )
+{
+    if( bitCompareSwapWrites != 0 )
+        encodingReduction = (((double)(bitsFlipped + tagBitsFlipped) 
+                           / (double)bitCompareSwapWrites)*100.0);
+    else
+        encodingReduction = 100.0;
+}
+
+/* Checkpoints list the candidate of each encoded partition. */
+void PartitionEncoder::WriteCheckpoint( CheckpointWriter& writer )
+{
+    std::map<uint64_t, uint64_t> partitionEncodings;
+    EncodingMap::iterator it;
+
+    for( it = encodings.begin( ); it != encodings.end( ); it++ )
+    {
+        for( uint64_t i = 0; i < wordPartitions; i++ )
+        {
+            if( it->second[i] != 0 )
+                partitionEncodings[it->first * wordPartitions + i] = it->second[i];
+        }
+    }
+
+    writer.Write( partitionEncodings );
+}
+
+void PartitionEncoder::ReadCheckpoint( CheckpointReader& reader )
+{
+    std::map<uint64_t, uint64_t> partitionEncodings;
+    std::map<uint64_t, uint64_t>::iterator it;
+
+    reader.Read( partitionEncodings );
+
+    encodings.clear( );
+
+    for( it = partitionEncodings.begin( ); it != partitionEncodings.end( ); it++ )
+    {
+        std::vector<uint8_t>& word = encodings[it->first / wordPartitions];
+
+        word.resize( wordPartitions, 0 );
+        word[it->first % wordPartitions] = static_cast<uint8_t>( it->second );
+    }
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_PARTITIONENCODER_H__
+#define __NVMAIN_PARTITIONENCODER_H__
+
+#include "src/DataEncoder.h"
+#include "DataEncoders/EncoderLine.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Base for encoders that store each partition of a memory word in one of
+ *  several candidate encodings, choosing the one that flips the fewest
+ *  cells. The candidate index is kept as tag cells next to the partition,
+ *  so changing it costs the tag bits that differ.
+ */
+class PartitionEncoder : public DataEncoder
+{
+  public:
+    PartitionEncoder( );
+    virtual ~PartitionEncoder( );
+
+    ncycle_t Read( NVMainRequest *request );
+    ncycle_t Write( NVMainRequest *request );
+
+    bool DifferentialWrite( ) { return true; }
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void WriteCheckpoint( CheckpointWriter& writer );
+    void ReadCheckpoint( CheckpointReader& reader );
+
+  protected:
+    /* Called from SetConfig once the parameters are set. At most 256 candidates. */
+    void SetPartitions( std::string granularityKey, uint64_t bits, uint64_t count );
+
+    /* 
+     *  Stored form of a partition value (partitionBits wide) under the
+     *  given candidate. Candidate 0 must store the value as is.
+     */
+    virtual uint64_t Encode( uint64_t value, uint64_t candidate ) = 0;
+
+    uint64_t partitionBits;
+    uint64_t candidates;
+
+  private:
+    uint64_t wordSize;
+    uint64_t wordPartitions;
+
+    /* Candidate of each partition of the words not stored as is. */
+    typedef std::unordered_map< uint64_t, std::vector<uint8_t> > EncodingMap;
+    EncodingMap encodings;
+
+    EncoderLine newLine, oldLine;
+
+    uint64_t bitsFlipped;
+    uint64_t bitCompareSwapWrites;
+    uint64_t tagBitsFlipped;
+    double encodingReduction;
+};
+
+};
+
+#endif
@@ -37,6 +37,8 @@
 /* Add your decoder's include file below. */
 #include "Decoders/DRCDecoder/DRCDecoder.h"
 #include "Decoders/Migrator/Migrator.h"
+#include "Decoders/StartGap/StartGap.h"
+#include "Decoders/RandomStartGap/RandomStartGap.h"
 
 using namespace NVM;
 
@@ -47,6 +49,8 @@ AddressTranslator *DecoderFactory::CreateDecoder( std::string decoder )
     if( decoder == "Default" ) trans = new AddressTranslator( );
     else if( decoder == "DRCDecoder" ) trans = new DRCDecoder( );
     else if( decoder == "Migrator" ) trans = new Migrator( );
+    else if( decoder == "StartGap" ) trans = new StartGap( );
+    else if( decoder == "RandomStartGap" ) trans = new RandomStartGap( );
 
     return trans;
 }
@@ -0,0 +1,116 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/RandomStartGap/RandomStartGap.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace NVM;
+
+RandomStartGap::RandomStartGap( )
+{
+    blockRows = 1;
+    permutedRows = 0;
+}
+
+
+RandomStartGap::~RandomStartGap( )
+{
+
+}
+
+
+void RandomStartGap::SetConfig( Config *config, bool createChildren )
+{
+    StartGap::SetConfig( config, createChildren );
+
+    /* Rows moved together; set to the CIM operand count to keep operands adjacent. */
+    if( config->KeyExists( "StartGapBlockRows" ) )
+        config->GetValueUL( "StartGapBlockRows", blockRows );
+
+    if( blockRows == 0 || blockRows > logicalRows )
+    {
+        std::cerr << "NVMain Error: StartGapBlockRows must be between 1 and "
+            << logicalRows << "." << std::endl;
+        exit(1);
+    }
+
+    /* 
+     *  Every decoder in the hierarchy builds the same table, so the seed
+     *  should be a known constant if you wish to reproduce results.
+     */
+    uint64_t seedValue = 1;
+    if( config->KeyExists( "StartGapSeed" ) )
+        config->GetValueUL( "StartGapSeed", seedValue );
+    unsigned int seed = static_cast<unsigned int>( seedValue );
+
+    /* Rows past the last full block keep their position. */
+    uint64_t blocks = logicalRows / blockRows;
+    permutedRows = blocks * blockRows;
+
+    blockMap.resize( blocks );
+    inverseMap.resize( blocks );
+
+    for( uint64_t blockIdx = 0; blockIdx < blocks; blockIdx++ )
+        blockMap[blockIdx] = blockIdx;
+
+    /* Fisher-Yates shuffle of the block order. */
+    for( uint64_t blockIdx = blocks - 1; blockIdx > 0; blockIdx-- )
+    {
+        uint64_t swapIdx = static_cast<uint64_t>( ::rand_r( &seed ) ) % (blockIdx + 1);
+        std::swap( blockMap[blockIdx], blockMap[swapIdx] );
+    }
+
+    for( uint64_t blockIdx = 0; blockIdx < blocks; blockIdx++ )
+        inverseMap[blockMap[blockIdx]] = blockIdx;
+}
+
+
+uint64_t RandomStartGap::Scramble( uint64_t logicalRow )
+{
+    if( logicalRow >= permutedRows )
+        return logicalRow;
+
+    return blockMap[logicalRow / blockRows] * blockRows + logicalRow % blockRows;
+}
+
+
+uint64_t RandomStartGap::Unscramble( uint64_t scrambledRow )
+{
+    if( scrambledRow >= permutedRows )
+        return scrambledRow;
+
+    return inverseMap[scrambledRow / blockRows] * blockRows + scrambledRow % blockRows;
+}
@@ -0,0 +1,75 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __RANDOMSTARTGAP_H__
+#define __RANDOMSTARTGAP_H__
+
+#include "Decoders/StartGap/StartGap.h"
+
+#include <vector>
+
+namespace NVM
+{
+
+
+/*
+ *  Start-Gap with a static randomized mapping. Plain Start-Gap only shifts
+ *  rows by one, so a cluster of hot rows keeps hitting neighbouring physical
+ *  rows. Here the logical rows of each region are first permuted in blocks
+ *  of StartGapBlockRows through a seeded table. Keeping CIM operand groups
+ *  inside one block keeps them co-located.
+ */
+class RandomStartGap : public StartGap
+{
+  public:
+    RandomStartGap( );
+    ~RandomStartGap( );
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+  protected:
+    uint64_t Scramble( uint64_t logicalRow );
+    uint64_t Unscramble( uint64_t scrambledRow );
+
+  private:
+    uint64_t blockRows;
+    uint64_t permutedRows;
+    std::vector<uint64_t> blockMap;
+    std::vector<uint64_t> inverseMap;
+};
+
+
+};
+
+
+#endif
@@ -0,0 +1,350 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/StartGap/StartGap.h"
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace NVM;
+
+StartGap::StartGap( )
+{
+    regionRows = 0;
+    logicalRows = 0;
+    gapInterval = 100;
+
+    numChannels = numBanks = numRanks = numSubarrays = 0;
+}
+
+
+StartGap::~StartGap( )
+{
+
+}
+
+
+void StartGap::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    numChannels = config->GetValue( "CHANNELS" );
+    numBanks = config->GetValue( "BANKS" );
+    numRanks = config->GetValue( "RANKS" );
+    numSubarrays = config->GetValue( "ROWS" ) / config->GetValue( "MATHeight" );
+
+    /* One row per subarray is held back as the gap. */
+    regionRows = config->GetValue( "MATHeight" );
+    logicalRows = regionRows - 1;
+
+    if( regionRows < 2 )
+    {
+        std::cerr << "NVMain Error: StartGap needs at least two rows per "
+            << "subarray (MATHeight)." << std::endl;
+        exit(1);
+    }
+
+    /* Number of writes to a region between gap movements (psi). */
+    if( config->KeyExists( "StartGapInterval" ) )
+        config->GetValueUL( "StartGapInterval", gapInterval );
+
+    if( gapInterval == 0 )
+    {
+        std::cerr << "NVMain Error: StartGapInterval must be positive." << std::endl;
+        exit(1);
+    }
+
+    /* The gap starts in the last row, making the initial mapping the identity. */
+    GapRegion initialRegion;
+
+    initialRegion.start = 0;
+    initialRegion.gap = logicalRows;
+    initialRegion.writes = 0;
+    initialRegion.moving = false;
+
+    regions.assign( numChannels * numRanks * numBanks * numSubarrays, initialRegion );
+}
+
+
+uint64_t StartGap::GetRegionKey( uint64_t bank, uint64_t rank, uint64_t channel, uint64_t subarray )
+{
+    return ((channel * numRanks + rank) * numBanks + bank) * numSubarrays + subarray;
+}
+
+
+StartGap::GapRegion& StartGap::GetRegion( NVMAddress& address )
+{
+    uint64_t bank, rank, channel, subarray;
+    address.GetTranslatedAddress( NULL, NULL, &bank, &rank, &channel, &subarray );
+
+    uint64_t key = GetRegionKey( bank, rank, channel, subarray );
+    assert( key < regions.size( ) );
+
+    return regions[key];
+}
+
+
+/* Only the logicalRows visible rows have a home; see Translate. */
+uint64_t StartGap::PhysicalRow( const GapRegion& region, uint64_t logicalRow )
+{
+    assert( logicalRow < logicalRows );
+
+    uint64_t physicalRow = (Scramble( logicalRow ) + region.start) % logicalRows;
+
+    if( physicalRow >= region.gap )
+        physicalRow++;
+
+    return physicalRow;
+}
+
+
+/*
+ *  The addresses are laid out over MATHeight - 1 rows per subarray: the
+ *  decoded subarray and row are folded into a row of the bank and split
+ *  again at logicalRows. The last numSubarrays rows of a bank's address
+ *  range are past the visible memory and wrap around, as addresses past
+ *  the end of memory do.
+ */
+void StartGap::VisibleRow( uint64_t *row, uint64_t *subarray )
+{
+    uint64_t bankRow = (*subarray * regionRows + *row) % (numSubarrays * logicalRows);
+
+    *subarray = bankRow / logicalRows;
+    *row = bankRow % logicalRows;
+}
+
+
+/* Physical address of a visible row; the inverse of VisibleRow. */
+uint64_t StartGap::VisibleAddress( uint64_t row, uint64_t bank, uint64_t rank, 
+                                   uint64_t channel, uint64_t subarray )
+{
+    uint64_t bankRow = subarray * logicalRows + row;
+
+    return ReverseTranslate( bankRow % regionRows, 0, bank, rank, channel, 
+                             bankRow / regionRows );
+}
+
+
+uint64_t StartGap::LogicalRow( const GapRegion& region, uint64_t physicalRow )
+{
+    if( physicalRow == region.gap )
+        return logicalRows;
+
+    if( physicalRow > region.gap )
+        physicalRow--;
+
+    return Unscramble( (physicalRow + logicalRows - region.start) % logicalRows );
+}
+
+
+void StartGap::Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank,
+                          uint64_t *rank, uint64_t *channel, uint64_t *subarray )
+{
+    AddressTranslator::Translate( address, row, col, bank, rank, channel, subarray );
+
+    if( *row >= regionRows || *subarray >= numSubarrays )
+        return;
+
+    VisibleRow( row, subarray );
+
+    uint64_t key = GetRegionKey( *bank, *rank, *channel, *subarray );
+
+    if( key >= regions.size( ) )
+        return;
+
+    *row = PhysicalRow( regions[key], *row );
+}
+
+
+/*
+ *  Counts a completed write to the region of address and returns true once
+ *  the region is due to move its gap.
+ */
+bool StartGap::RecordWrite( NVMAddress& address )
+{
+    GapRegion& region = GetRegion( address );
+
+    region.writes++;
+
+    return (region.writes >= gapInterval && !region.moving);
+}
+
+
+/*
+ *  Marks the region of address as moving and fills source with the row that
+ *  is copied into the gap. The physical address of source is that of the
+ *  logical row being moved, so it translates to the new row after MoveGap.
+ */
+bool StartGap::StartGapMove( NVMAddress& address, NVMAddress& source )
+{
+    uint64_t bank, rank, channel, subarray;
+    address.GetTranslatedAddress( NULL, NULL, &bank, &rank, &channel, &subarray );
+
+    GapRegion& region = GetRegion( address );
+
+    if( region.moving )
+        return false;
+
+    /* When the gap reaches the top row, it wraps around to the last row. */
+    uint64_t sourceRow = (region.gap == 0) ? logicalRows : region.gap - 1;
+    uint64_t sourceLogical = LogicalRow( region, sourceRow );
+
+    source.SetTranslatedAddress( sourceRow, 0, bank, rank, channel, subarray );
+    source.SetPhysicalAddress( VisibleAddress( sourceLogical, bank, rank, channel, subarray ) );
+
+    region.moving = true;
+    region.writes = 0;
+
+    return true;
+}
+
+
+/* The source row has been read; it now lives in the old gap row. */
+void StartGap::MoveGap( NVMAddress& address )
+{
+    GapRegion& region = GetRegion( address );
+
+    assert( region.moving );
+
+    if( region.gap == 0 )
+    {
+        region.gap = logicalRows;
+        region.start = (region.start + 1) % logicalRows;
+    }
+    else
+    {
+        region.gap--;
+    }
+}
+
+
+void StartGap::FinishGapMove( NVMAddress& address )
+{
+    GapRegion& region = GetRegion( address );
+
+    assert( region.moving );
+
+    region.moving = false;
+}
+
+
+/*
+ *  CIM operands are the activated row and the rows physically following it.
+ *  The remapping keeps logically consecutive rows together except across the
+ *  gap and the wrap-around point; operations that straddle either would
+ *  compute on the wrong rows.
+ */
+bool StartGap::IsColocated( NVMAddress& address, ncounter_t operandRows )
+{
+    uint64_t row, col, bank, rank, channel, subarray;
+
+    AddressTranslator::Translate( address.GetPhysicalAddress( ), &row, &col, 
+                                  &bank, &rank, &channel, &subarray );
+
+    if( row >= regionRows || subarray >= numSubarrays )
+        return true;
+
+    VisibleRow( &row, &subarray );
+
+    uint64_t key = GetRegionKey( bank, rank, channel, subarray );
+
+    if( key >= regions.size( ) )
+        return true;
+
+    GapRegion& region = regions[key];
+    uint64_t firstRow = PhysicalRow( region, row );
+
+    for( ncounter_t rowIdx = 1; rowIdx < operandRows; rowIdx++ )
+    {
+        uint64_t operandRow = row + rowIdx;
+
+        /* The next visible rows are in the next subarray. */
+        if( operandRow >= logicalRows
+            || PhysicalRow( region, operandRow ) != (firstRow + rowIdx) % regionRows )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ *  Gap movements are not checkpointed: the system is drained first, so no
+ *  region may be between StartGapMove and FinishGapMove.
+ */
+void StartGap::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter writer( dir, StatName( ) );
+
+    writer.Write( regionRows );
+    writer.Write( static_cast<uint64_t>( regions.size( ) ) );
+
+    std::vector<GapRegion>::iterator it;
+    for( it = regions.begin( ); it != regions.end( ); it++ )
+    {
+        if( it->moving )
+        {
+            std::cerr << "NVMain Error: " << StatName( ) << " cannot be "
+                      << "checkpointed while a gap is moving." << std::endl;
+            exit(1);
+        }
+
+        writer.Write( it->start );
+        writer.Write( it->gap );
+        writer.Write( it->writes );
+    }
+}
+
+
+void StartGap::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+    uint64_t savedRows, savedRegions;
+
+    reader.Read( savedRows );
+    reader.Expect( savedRows, regionRows, "MATHeight" );
+    reader.Read( savedRegions );
+    reader.Expect( savedRegions, regions.size( ), "Start-Gap regions" );
+
+    std::vector<GapRegion>::iterator it;
+    for( it = regions.begin( ); it != regions.end( ); it++ )
+    {
+        reader.Read( it->start );
+        reader.Read( it->gap );
+        reader.Read( it->writes );
+
+        it->moving = false;
+    }
+}
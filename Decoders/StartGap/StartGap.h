@@ -0,0 +1,120 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __STARTGAP_H__
+#define __STARTGAP_H__
+
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+#include "include/NVMAddress.h"
+
+#include <vector>
+
+namespace NVM
+{
+
+
+/*
+ *  Start-Gap wear leveling (Qureshi et al., MICRO 2009). Each subarray is a
+ *  region of MATHeight physical rows holding MATHeight - 1 logical rows; the
+ *  remaining row is the gap. Addresses are mapped over the logical rows
+ *  only, so the visible memory is (MATHeight - 1) / MATHeight of the
+ *  configured capacity. Every StartGapInterval writes to a region, the row
+ *  before the gap is copied into it and the gap moves down by one. Once
+ *  the gap wraps around, every logical row has shifted by one physical row.
+ *
+ *  Rows stay within their subarray, so only the row field is remapped. The
+ *  row copies themselves are issued, and reported, by the WearLeveler hook
+ *  through the memory controller.
+ */
+class StartGap : public AddressTranslator
+{
+  public:
+    StartGap( );
+    ~StartGap( );
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+    virtual void Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank, 
+                            uint64_t *rank, uint64_t *channel, uint64_t *subarray );
+    using AddressTranslator::Translate;
+
+    bool RecordWrite( NVMAddress& address );
+    bool StartGapMove( NVMAddress& address, NVMAddress& source );
+    void MoveGap( NVMAddress& address );
+    void FinishGapMove( NVMAddress& address );
+
+    bool IsColocated( NVMAddress& address, ncounter_t operandRows );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
+  protected:
+    /* 
+     *  Static remapping of logical rows applied before the rotation. Start-Gap
+     *  itself uses the identity; randomized variants override both.
+     */
+    virtual uint64_t Scramble( uint64_t logicalRow ) { return logicalRow; }
+    virtual uint64_t Unscramble( uint64_t scrambledRow ) { return scrambledRow; }
+
+    uint64_t regionRows;
+    uint64_t logicalRows;
+
+  private:
+    struct GapRegion
+    {
+        uint64_t start;
+        uint64_t gap;
+        ncounter_t writes;
+        bool moving;
+    };
+
+    std::vector<GapRegion> regions;
+
+    uint64_t numChannels, numBanks, numRanks, numSubarrays;
+    ncounter_t gapInterval;
+
+    GapRegion& GetRegion( NVMAddress& address );
+    uint64_t GetRegionKey( uint64_t bank, uint64_t rank, uint64_t channel, uint64_t subarray );
+    uint64_t PhysicalRow( const GapRegion& region, uint64_t logicalRow );
+    uint64_t LogicalRow( const GapRegion& region, uint64_t physicalRow );
+    void VisibleRow( uint64_t *row, uint64_t *subarray );
+    uint64_t VisibleAddress( uint64_t row, uint64_t bank, uint64_t rank, 
+                             uint64_t channel, uint64_t subarray );
+};
+
+
+};
+
+
+#endif
@@ -38,14 +38,6 @@ using namespace NVM;
 
 BitModel::BitModel( )
 {
-    /*
-     *  Clear the life map, which will hold all of the endurance
-     *  values for each of our rows. Do this to ensure it didn't
-     *  happen to be allocated somewhere that thinks it contains 
-     *  values.
-     */
-    life.clear( );
-
     SetGranularity( 1 );
 }
 
@@ -59,9 +51,7 @@ BitModel::~BitModel( )
 
 void BitModel::SetConfig( Config *config, bool createChildren )
 {
-    Params *params = new Params( );
-    params->SetParams( config );
-    SetParams( params );
+    SetParams( config->GetParams( ) );
 
     EnduranceModel::SetConfig( config, createChildren );
 }
@@ -118,8 +108,8 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     NVMAddress& address = request->address;
 
     /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
+     *  The default life store is indexed by a uint64_t key. 
+     *  You may map row and col to this key however you want.
      *  It is up to you to ensure there are no collisions here.
      */
     uint64_t row;
@@ -129,10 +119,10 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
     
     /*
-     *  If using the default life map, we can call the DecrementLife
-     *  function which will check if the map_key already exists. If so,
+     *  If using the default life store, we can call the DecrementLife
+     *  function which will check if the key was written before. If so,
      *  the life value is decremented (write count incremented). Otherwise 
-     *  the map_key is inserted with a write count of 1.
+     *  the key is given its initial life from the distribution.
      */
     uint64_t wordkey;
     uint64_t rowSize;
@@ -41,6 +41,7 @@ using namespace NVM;
 NormalDistribution::NormalDistribution( )
 {
     nextEndurance = 0.0f;
+    seed = 1;
 }
 
 NormalDistribution::NormalDistribution( Config *conf )
@@ -71,6 +72,7 @@ NormalDistribution::NormalDistribution( Config *conf )
     }
 
     nextEndurance = 0.0f;
+    seed = 1;
 }
 
 uint64_t NormalDistribution::GetEndurance( )
@@ -93,14 +95,16 @@ uint64_t NormalDistribution::GetEndurance( )
     }
 
     /*
-     *  rand() is a uniform distribution. Use the Box-Muller method to
-     *  convert the output from rand() to a normal distribution.
+     *  rand_r() is a uniform distribution. Use the Box-Muller method to
+     *  convert the output from rand_r() to a normal distribution. Each
+     *  distribution has its own seed, so separate simulations do not share
+     *  a stream.
      */
     w = 2.0f;
     while( w >= 1.0f )
     {
-        x1 = 2.0 * ( (double)(rand( ) % 1000000) / 1000000.0f ) - 1.0f;
-        x2 = 2.0 * ( (double)(rand( ) % 1000000) / 1000000.0f ) - 1.0f;
+        x1 = 2.0 * ( (double)(::rand_r( &seed ) % 1000000) / 1000000.0f ) - 1.0f;
+        x2 = 2.0 * ( (double)(::rand_r( &seed ) % 1000000) / 1000000.0f ) - 1.0f;
         w = x1 * x1 + x2 * x2;
     }
 
@@ -113,3 +117,16 @@ uint64_t NormalDistribution::GetEndurance( )
     
     return mean + static_cast<uint64_t>(y1 * static_cast<double>(variance));
 }
+
+/* The stream position and the second value of the last pair. */
+void NormalDistribution::WriteCheckpoint( CheckpointWriter& writer )
+{
+    writer.Write( seed );
+    writer.Write( nextEndurance );
+}
+
+void NormalDistribution::ReadCheckpoint( CheckpointReader& reader )
+{
+    reader.Read( seed );
+    reader.Read( nextEndurance );
+}
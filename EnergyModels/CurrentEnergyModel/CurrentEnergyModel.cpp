@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "EnergyModels/CurrentEnergyModel/CurrentEnergyModel.h"
+
+using namespace NVM;
+
+CurrentEnergyModel::CurrentEnergyModel( )
+{
+    uniformWriteEnergy = 0.0;
+}
+
+CurrentEnergyModel::~CurrentEnergyModel( )
+{
+}
+
+void CurrentEnergyModel::SetParams( Params *params )
+{
+    EnergyModel::SetParams( params );
+
+    double banks = static_cast<double>(p->BANKS);
+    ncycle_t tRC = p->tRAS + p->tRP;
+
+    eventEnergy[ENERGY_ACTIVATE] = ( ( p->EIDD0 * (double)tRC ) 
+                                   - ( ( p->EIDD3N * (double)(p->tRAS) )
+                                   +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / banks;
+    eventEnergy[ENERGY_READ] = ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / banks;
+    eventEnergy[ENERGY_WRITE] = ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / banks;
+    eventEnergy[ENERGY_WRITE_BIT] = 0.0;
+    eventEnergy[ENERGY_REFRESH] = ( ( p->EIDD5B - p->EIDD3N ) * (double)(p->tRFC) ) / banks;
+
+    backgroundEnergy[BACKGROUND_ACTIVE_POWERDOWN] = p->EIDD3P;
+    backgroundEnergy[BACKGROUND_PRECHARGE_POWERDOWN_FAST] = p->EIDD2P1;
+    backgroundEnergy[BACKGROUND_PRECHARGE_POWERDOWN_SLOW] = p->EIDD2P0;
+    backgroundEnergy[BACKGROUND_ACTIVE_STANDBY] = p->EIDD3N;
+    backgroundEnergy[BACKGROUND_PRECHARGE_STANDBY] = p->EIDD2N;
+
+    /*
+     *  Uniform writes take the write energy from Destiny: SET all cells to 
+     *  LRS, then RESET 3/4 of them to the HRS states. A cell holds 2 bits.
+     */
+    double totalCells = static_cast<double>(p->tBURST * p->RATE * p->BusWidth / 2);
+
+    uniformWriteEnergy = p->Eset * totalCells + p->Ereset * (3.0 * totalCells / 4.0);
+}
+
+double CurrentEnergyModel::GetCellWriteEnergy( ncounter_t /*resetCells*/, 
+                                               ncounter_t /*setCells*/,
+                                               bool uniformWrites )
+{
+    /* Otherwise the write current (IDD4W) already covers the cells. */
+    return uniformWrites ? uniformWriteEnergy : 0.0;
+}
+
+double CurrentEnergyModel::GetCIMEnergy( NVMainRequest * /*request*/ )
+{
+    /* CIM energies are given in nJ, which has no meaning in this model. */
+    return 0.0;
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "EnergyModels/FlatEnergyModel/FlatEnergyModel.h"
+
+using namespace NVM;
+
+FlatEnergyModel::FlatEnergyModel( )
+{
+}
+
+FlatEnergyModel::~FlatEnergyModel( )
+{
+}
+
+void FlatEnergyModel::SetParams( Params *params )
+{
+    EnergyModel::SetParams( params );
+
+    /* The activation senses the row, so it costs a read. */
+    eventEnergy[ENERGY_ACTIVATE] = p->Erd;
+    eventEnergy[ENERGY_READ] = p->Eopenrd;
+    eventEnergy[ENERGY_WRITE] = p->Ewr;
+    eventEnergy[ENERGY_WRITE_BIT] = p->Ewrpb;
+    eventEnergy[ENERGY_REFRESH] = p->Eref;
+
+    backgroundEnergy[BACKGROUND_ACTIVE_POWERDOWN] = p->Epda;
+    backgroundEnergy[BACKGROUND_PRECHARGE_POWERDOWN_FAST] = p->Epdpf;
+    backgroundEnergy[BACKGROUND_PRECHARGE_POWERDOWN_SLOW] = p->Epdps;
+    backgroundEnergy[BACKGROUND_ACTIVE_STANDBY] = p->Eactstdby;
+    backgroundEnergy[BACKGROUND_PRECHARGE_STANDBY] = p->Eprestdby;
+}
+
+double FlatEnergyModel::GetCellWriteEnergy( ncounter_t resetCells, ncounter_t setCells,
+                                            bool /*uniformWrites*/ )
+{
+    return p->Ereset * static_cast<double>(resetCells) 
+         + p->Eset * static_cast<double>(setCells);
+}
+
+double FlatEnergyModel::GetCIMEnergy( NVMainRequest *request )
+{
+    return p->GetCIMEnergy( request );
+}
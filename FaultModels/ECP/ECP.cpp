@@ -32,3 +32,291 @@
 *******************************************************************************/
 
 
+
+#include "FaultModels/ECP/ECP.h"
+#include "src/Params.h"
+#include "include/NVMainRequest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+const uint64_t ECP::emptyLine;
+
+ECP::ECP( )
+{
+    entriesPerLine = 6;
+    readLatency = 1;
+    writeLatency = 0;
+
+    slotMask = 0;
+    usedSlots = 0;
+
+    linesCorrected = 0;
+    linesRetired = 0;
+    entriesUsed = 0;
+    uncorrectableFaults = 0;
+    correctedReads = 0;
+    correctedWrites = 0;
+    correctionCycles = 0;
+}
+
+ECP::~ECP( )
+{
+}
+
+void ECP::SetConfig( Config *config, bool createChildren )
+{
+    SetParams( config->GetParams( ) );
+
+    if( config->KeyExists( "ECPEntries" ) )
+    {
+        int entries = config->GetValue( "ECPEntries" );
+
+        if( entries <= 0 || entries > 65535 )
+        {
+            std::cerr << "NVMain Error: ECPEntries must be between 1 and "
+                      << "65535." << std::endl;
+            exit(1);
+        }
+
+        entriesPerLine = static_cast<uint64_t>( entries );
+    }
+
+    if( config->KeyExists( "ECPReadLatency" ) )
+        readLatency = static_cast<ncycle_t>( config->GetValue( "ECPReadLatency" ) );
+
+    if( config->KeyExists( "ECPWriteLatency" ) )
+        writeLatency = static_cast<ncycle_t>( config->GetValue( "ECPWriteLatency" ) );
+
+    Resize( 64 );
+
+    FaultModel::SetConfig( config, createChildren );
+}
+
+void ECP::RegisterStats( )
+{
+    AddStat(linesCorrected);
+    AddStat(linesRetired);
+    AddStat(entriesUsed);
+    AddStat(uncorrectableFaults);
+    AddStat(correctedReads);
+    AddStat(correctedWrites);
+    AddStat(correctionCycles);
+}
+
+/*
+ *  The failed unit is pointed to by an entry of its line. Units stay worn
+ *  out, so every write changing one faults again and finds its entry, or,
+ *  on a retired line, its earlier uncorrectable fault.
+ */
+bool ECP::Fault( NVMAddress faultAddr, uint64_t faultUnit )
+{
+    uint64_t line = GetLine( faultAddr );
+    LineEntries *entries = FindLine( line );
+
+    if( entries == NULL )
+    {
+        entries = InsertLine( line );
+        linesCorrected++;
+    }
+
+    if( entries->retired )
+    {
+        if( uncorrectableUnits.insert( std::make_pair( line, faultUnit ) ).second )
+            uncorrectableFaults++;
+
+        return false;
+    }
+
+    uint64_t *linePointers = &pointers[( entries - &slots[0] ) * entriesPerLine];
+
+    for( uint64_t i = 0; i < entries->used; i++ )
+    {
+        if( linePointers[i] == faultUnit )
+            return true;
+    }
+
+    if( entries->used == entriesPerLine )
+    {
+        entries->retired = true;
+        linesRetired++;
+        uncorrectableUnits.insert( std::make_pair( line, faultUnit ) );
+        uncorrectableFaults++;
+        return false;
+    }
+
+    linePointers[entries->used] = faultUnit;
+    entries->used++;
+    entriesUsed++;
+
+    return true;
+}
+
+ncycle_t ECP::Read( NVMainRequest *request )
+{
+    return Correct( request->address, readLatency, correctedReads );
+}
+
+ncycle_t ECP::Write( NVMainRequest *request )
+{
+    return Correct( request->address, writeLatency, correctedWrites );
+}
+
+/* Accesses to lines with entries pay the latency of the correction. */
+ncycle_t ECP::Correct( NVMAddress& address, ncycle_t latency, 
+                       ncounter_t& accesses )
+{
+    /* Most lines are healthy for most of the device's life. */
+    if( usedSlots == 0 || FindLine( GetLine( address ) ) == NULL )
+        return 0;
+
+    accesses++;
+    correctionCycles += latency;
+
+    return latency;
+}
+
+uint64_t ECP::GetLine( NVMAddress& address )
+{
+    uint64_t row, col;
+
+    address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
+
+    return row * p->COLS + col;
+}
+
+uint64_t ECP::FirstSlot( uint64_t line )
+{
+    uint64_t hash = line * 0x9E3779B97F4A7C15ULL;
+
+    return ( hash ^ ( hash >> 32 ) ) & slotMask;
+}
+
+ECP::LineEntries *ECP::FindLine( uint64_t line )
+{
+    uint64_t slot = FirstSlot( line );
+
+    while( slots[slot].line != emptyLine )
+    {
+        if( slots[slot].line == line )
+            return &slots[slot];
+
+        slot = ( slot + 1 ) & slotMask;
+    }
+
+    return NULL;
+}
+
+ECP::LineEntries *ECP::InsertLine( uint64_t line )
+{
+    /* Keep the table at most half full so probe sequences stay short. */
+    if( ( usedSlots + 1 ) * 2 > slots.size( ) )
+        Resize( slots.size( ) * 2 );
+
+    uint64_t slot = FirstSlot( line );
+
+    while( slots[slot].line != emptyLine )
+        slot = ( slot + 1 ) & slotMask;
+
+    slots[slot].line = line;
+    slots[slot].used = 0;
+    slots[slot].retired = false;
+    usedSlots++;
+
+    return &slots[slot];
+}
+
+void ECP::Resize( uint64_t capacity )
+{
+    std::vector<LineEntries> oldSlots;
+    std::vector<uint64_t> oldPointers;
+    LineEntries empty = { emptyLine, 0, false };
+
+    oldSlots.swap( slots );
+    oldPointers.swap( pointers );
+
+    slots.assign( capacity, empty );
+    pointers.assign( capacity * entriesPerLine, 0 );
+    slotMask = capacity - 1;
+
+    for( uint64_t i = 0; i < oldSlots.size( ); i++ )
+    {
+        if( oldSlots[i].line == emptyLine )
+            continue;
+
+        uint64_t slot = FirstSlot( oldSlots[i].line );
+
+        while( slots[slot].line != emptyLine )
+            slot = ( slot + 1 ) & slotMask;
+
+        slots[slot] = oldSlots[i];
+        std::copy( oldPointers.begin( ) + i * entriesPerLine,
+                   oldPointers.begin( ) + ( i + 1 ) * entriesPerLine,
+                   pointers.begin( ) + slot * entriesPerLine );
+    }
+}
+
+/* Entries are saved per line; the table is rebuilt on restore. */
+void ECP::WriteCheckpoint( CheckpointWriter& writer )
+{
+    writer.Write( entriesPerLine );
+    writer.Write( usedSlots );
+
+    for( uint64_t i = 0; i < slots.size( ); i++ )
+    {
+        if( slots[i].line == emptyLine )
+            continue;
+
+        writer.Write( slots[i].line );
+        writer.Write( slots[i].retired );
+        writer.Write( slots[i].used );
+        writer.WriteArray( &pointers[i * entriesPerLine], slots[i].used );
+    }
+
+    writer.Write( uncorrectableUnits );
+}
+
+void ECP::ReadCheckpoint( CheckpointReader& reader )
+{
+    uint64_t savedEntries, lineCount;
+
+    reader.Read( savedEntries );
+    reader.Expect( savedEntries, entriesPerLine, "ECPEntries" );
+    reader.Read( lineCount );
+
+    slots.clear( );
+    pointers.clear( );
+    usedSlots = 0;
+    Resize( 64 );
+
+    linesCorrected = 0;
+    linesRetired = 0;
+    entriesUsed = 0;
+
+    for( uint64_t i = 0; i < lineCount; i++ )
+    {
+        uint64_t line;
+        bool retired;
+        uint16_t used;
+
+        reader.Read( line );
+        reader.Read( retired );
+        reader.Read( used );
+
+        LineEntries *entries = InsertLine( line );
+
+        entries->retired = retired;
+        entries->used = used;
+        reader.ReadArray( &pointers[( entries - &slots[0] ) * entriesPerLine], used );
+
+        linesCorrected++;
+        linesRetired += ( retired ? 1 : 0 );
+        entriesUsed += used;
+    }
+
+    reader.Read( uncorrectableUnits );
+    uncorrectableFaults = uncorrectableUnits.size( );
+}
@@ -32,3 +32,83 @@
 *******************************************************************************/
 
 
+
+#ifndef __ECP_H__
+#define __ECP_H__
+
+#include "src/FaultModel.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Error-correcting pointers (ECP-N). Each line has N entries, each holding
+ *  a pointer to a worn-out unit and a replacement for it. A line needing
+ *  more entries than it has is retired. Only lines with a failed unit have
+ *  entries, which are kept in an open-addressed table keyed by line. The
+ *  units of retired lines left without an entry are uncorrectable faults.
+ */
+class ECP : public FaultModel
+{
+  public:
+    ECP( );
+    ~ECP( );
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+    bool Fault( NVMAddress faultAddr, uint64_t faultUnit );
+
+    ncycle_t Read( NVMainRequest *request );
+    ncycle_t Write( NVMainRequest *request );
+
+    void RegisterStats( );
+
+    void WriteCheckpoint( CheckpointWriter& writer );
+    void ReadCheckpoint( CheckpointReader& reader );
+
+  private:
+    struct LineEntries
+    {
+        uint64_t line;
+        uint16_t used;
+        bool retired;
+    };
+
+    static const uint64_t emptyLine = ~0ULL;
+
+    uint64_t entriesPerLine;
+    ncycle_t readLatency;
+    ncycle_t writeLatency;
+
+    /* The pointers of slots[i] start at pointers[i * entriesPerLine]. */
+    std::vector<LineEntries> slots;
+    std::vector<uint64_t> pointers;
+    uint64_t slotMask;
+    uint64_t usedSlots;
+
+    /* Line and unit of each failed unit without an entry. */
+    std::set<std::pair<uint64_t, uint64_t> > uncorrectableUnits;
+
+    ncounter_t linesCorrected;
+    ncounter_t linesRetired;
+    ncounter_t entriesUsed;
+    ncounter_t uncorrectableFaults;
+    ncounter_t correctedReads;
+    ncounter_t correctedWrites;
+    ncounter_t correctionCycles;
+
+    uint64_t GetLine( NVMAddress& address );
+    uint64_t FirstSlot( uint64_t line );
+    LineEntries *FindLine( uint64_t line );
+    LineEntries *InsertLine( uint64_t line );
+    void Resize( uint64_t capacity );
+    ncycle_t Correct( NVMAddress& address, ncycle_t latency, 
+                      ncounter_t& accesses );
+};
+
+};
+
+#endif
@@ -57,9 +57,7 @@ OffChipBus::~OffChipBus( )
 
 void OffChipBus::SetConfig( Config *c, bool createChildren )
 {
-    Params *params = new Params( );
-    params->SetParams( c );
-    SetParams( params );
+    SetParams( c->GetParams( ) );
 
     conf = c;
     configSet = true;
@@ -138,6 +136,11 @@ bool OffChipBus::IssueCommand( NVMainRequest *req )
     return success;
 }
 
+bool OffChipBus::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 bool OffChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
 {
     return GetChild( req )->IsIssuable( req, reason );
@@ -55,9 +55,7 @@ OnChipBus::~OnChipBus( )
 
 void OnChipBus::SetConfig( Config *c, bool createChildren )
 {
-    Params *params = new Params( );
-    params->SetParams( c );
-    SetParams( params );
+    SetParams( c->GetParams( ) );
 
     conf = c;
     configSet = true;
@@ -126,6 +124,11 @@ bool OnChipBus::IssueCommand( NVMainRequest *req )
     return success;
 }
 
+bool OnChipBus::IssueAtomic( NVMainRequest *mop )
+{
+    return GetChild( mop )->IssueAtomic( mop );
+}
+
 bool OnChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
 {
     return GetChild( req )->IsIssuable( req, reason );
@@ -49,6 +49,7 @@ class OnChipBus : public Interconnect
     void SetConfig( Config *c, bool createChildren = true );
 
     bool IssueCommand( NVMainRequest *mop );
+    bool IssueAtomic( NVMainRequest *mop );
     bool IsIssuable( NVMainRequest *mop, FailReason *reason = NULL );
 
     void CalculateStats( );
@@ -35,6 +35,7 @@
 
 #include "MemControl/FRFCFS-WQF/FRFCFS-WQF.h"
 #include "src/EventQueue.h"
+#include "src/Tracing.h"
 
 #include <cassert>
 
@@ -242,10 +243,9 @@ bool FRFCFS_WQF::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
         rv = false;
     }
     
-    if ( request->isCIM && rv == true )
-    {
-        std::cout << "CIM request is issuable in FRFCFS_WQF::IsIssuable!" << std::endl;
-    }
+    if( request->isCIM && rv == true )
+        NVM_TRACE( TRACE_CIM, TRACE_ISSUABLE, GetEventQueue()->GetCurrentCycle(), request, 0 );
+
     return rv;
 }
 
@@ -273,8 +273,7 @@ bool FRFCFS_WQF::IssueCommand( NVMainRequest *request )
     }
     else if( request->isCIM )
     {
-        std::cout << "FRFCFS_WQF::IssueCommand received CIM request!" << std::endl;
-        std::cout << "readQueueId of CIM request: " << readQueueId << std::endl;
+        NVM_TRACE( TRACE_CIM, TRACE_ENQUEUE, request->arrivalCycle, request, readQueueId );
         
         Enqueue( readQueueId, request );
        
@@ -290,10 +289,9 @@ bool FRFCFS_WQF::IssueCommand( NVMainRequest *request )
 
 bool FRFCFS_WQF::RequestComplete( NVMainRequest * request )
 {
-    if ( request->isCIM )
-    {
-        std::cout << "FRFCFS_WQF::RequestComplete received CIM request!" << std::endl;
-    }
+    if( request->isCIM )
+        NVM_TRACE( TRACE_CIM, TRACE_COMPLETE, GetEventQueue()->GetCurrentCycle(), request, 0 );
+
     if( request->type == WRITE || request->type == WRITE_PRECHARGE )
     {
         /* 
@@ -461,10 +459,8 @@ void FRFCFS_WQF::Cycle( ncycle_t steps )
     
     NVMainRequest *nextRequest = NULL;
 
-    if (m_draining == true)
-        std::cout << "if we are draining the write, only write queue is checked" << std::endl;
-    else
-        std::cout << "else, only read queue is checked" << std::endl;
+    NVM_TRACE( TRACE_QUEUE, TRACE_DRAIN, GetEventQueue()->GetCurrentCycle(), 
+               static_cast<NVMainRequest *>( NULL ), m_draining ? 1 : 0 );
 
     /* if we are draining the write, only write queue is checked */
     if( m_draining == true || (force_drain == true && readQueue->size() == 0) )
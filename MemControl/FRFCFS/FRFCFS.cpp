@@ -34,6 +34,7 @@
 #include "MemControl/FRFCFS/FRFCFS.h"
 #include "src/EventQueue.h"
 #include "include/NVMainRequest.h"
+#include "src/Tracing.h"
 #ifndef TRACE
 #ifdef GEM5
   #include "SimInterface/Gem5Interface/Gem5Interface.h"
@@ -138,7 +139,7 @@ bool FRFCFS::IsIssuable( NVMainRequest *request/*request*/, FailReason * /*fail*
     }
     
     if( rv == true && request->isCIM )
-        std::cout << "FRFCFS::IsIssuable: CIM request is issuable!" << std::endl;
+        NVM_TRACE( TRACE_CIM, TRACE_ISSUABLE, GetEventQueue()->GetCurrentCycle(), request, 0 );
 
     return rv;
 }
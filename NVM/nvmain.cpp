@@ -37,6 +37,8 @@
 #include "src/Interconnect.h"
 #include "src/SimInterface.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "src/Tracing.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "MemControl/MemoryControllerFactory.h"
 #include "traceWriter/TraceWriterFactory.h"
@@ -67,6 +69,19 @@ NVMain::NVMain( )
     prefetcher = NULL;
     successfulPrefetches = 0;
     unsuccessfulPrefetches = 0;
+
+    latencyProfile = NULL;
+
+    statsSink = NULL;
+    statsSeriesInterval = 0;
+    lastSeriesCycle = 0;
+    seriesRecorded = false;
+
+    telemetry = NULL;
+    requestsCompleted = 0;
+    cimRequestsCompleted = 0;
+
+    ownTracer = NULL;
 }
 
 NVMain::~NVMain( )
@@ -97,6 +112,11 @@ NVMain::~NVMain( )
 
         delete [] channelConfig;
     }
+
+    delete latencyProfile;
+    delete statsSink;
+    delete telemetry;
+    delete ownTracer;
 }
 
 Config *NVMain::GetConfig( )
@@ -109,12 +129,21 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
     TranslationMethod *method;
     int channels, ranks, banks, rows, cols, subarrays;
 
-    Params *params = new Params( );
-    params->SetParams( conf );
-    SetParams( params );
+    SetParams( conf->GetParams( ) );
 
     StatName( memoryName );
 
+    if( p->LatencyHistograms && latencyProfile == NULL )
+        latencyProfile = new LatencyProfile( );
+
+    /* A memory inside another (e.g., behind a DRAM cache) shares its ring. */
+    if( GetTracer( ) == NULL )
+    {
+        ownTracer = new Tracer( );
+        ownTracer->SetConfig( conf );
+        SetTracer( ownTracer );
+    }
+
     config = conf;
     if( config->GetSimInterface( ) != NULL )
         config->GetSimInterface( )->SetConfig( conf, createChildren );
@@ -368,6 +397,28 @@ void NVMain::PrintPreTrace( NVMainRequest *request )
     }
 }
 
+/*
+ *  A subarray can't activate an invalid number of operand rows, and the
+ *  request would stay queued forever, so reject it as it enters.
+ */
+void NVMain::CheckCIMOperandRows( NVMainRequest *request )
+{
+    if( p->ValidCIMOperandRows( request ) )
+        return;
+
+    OpType op = request->GetCIMOp( );
+
+    std::cerr << "NVMain Error: CIM operation " << p->GetCIMOpName( op )
+              << " at address 0x" << std::hex 
+              << request->address.GetPhysicalAddress( ) << std::dec
+              << " requests " << p->GetCIMOperandRows( request )
+              << " operand rows but must use between " 
+              << p->GetCIMMinOperandRows( op ) << " and " 
+              << p->GetCIMMaxOperandRows( op ) 
+              << " (see CIMMaxOperandRows)." << std::endl;
+    exit(1);
+}
+
 bool NVMain::IssueCommand( NVMainRequest *request )
 {
     //FIXMEif ( request->isCIM )
@@ -390,6 +441,8 @@ bool NVMain::IssueCommand( NVMainRequest *request )
     request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
     request->bulkCmd = CMD_NOP;
 
+    CheckCIMOperandRows( request );
+
     /* Check for any successful prefetches. */
     if( CheckPrefetch( request ) )
     {
@@ -441,13 +494,17 @@ bool NVMain::IssueAtomic( NVMainRequest *request )
     request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
     request->bulkCmd = CMD_NOP;
 
+    CheckCIMOperandRows( request );
+
     /* Check for any successful prefetches. */
     if( CheckPrefetch( request ) )
     {
         return true;
     }
 
-    mc_rv = memoryControllers[channel]->IssueAtomic( request );
+    /* Go through the hook so atomic requests are visible to hooks as well. */
+    assert( GetChild( request )->GetTrampoline( ) == memoryControllers[channel] );
+    mc_rv = GetChild( request )->IssueAtomic( request );
     if( mc_rv == true )
     {
         IssuePrefetch( request );
@@ -506,6 +563,10 @@ bool NVMain::RequestComplete( NVMainRequest *request )
     }
     else
     {
+        requestsCompleted++;
+        if( request->isCIM )
+            cimRequestsCompleted++;
+
         rv = GetParent( )->RequestComplete( request );
     }
 
@@ -534,12 +595,161 @@ void NVMain::RegisterStats( )
     AddStat(totalCIMRequests);
     AddStat(successfulPrefetches);
     AddStat(unsuccessfulPrefetches);
+
+    if( latencyProfile != NULL )
+        latencyProfile->RegisterStats( GetStats( ), StatName( ) );
+
+    /* Rows are written every StatsSeriesInterval cycles, by default PeriodicStatsInterval. */
+    statsSink = StatsSink::CreateSink( config, GetStats( ) );
+    statsSeriesInterval = p->PeriodicStatsInterval;
+    if( config->KeyExists( "StatsSeriesInterval" ) )
+        statsSeriesInterval = config->GetValueUL( "StatsSeriesInterval" );
+
+    if( statsSink != NULL && statsSeriesInterval != 0 )
+    {
+        GetEventQueue( )->InsertCallback( this, 
+                (CallbackPtr)&NVMain::StatsSeriesCallback,
+                GetEventQueue( )->GetCurrentCycle( ) + statsSeriesInterval );
+    }
+
+    telemetry = Telemetry::CreateTelemetry( config, GetStats( ), StatName( ) );
+
+    if( telemetry != NULL )
+    {
+        GetEventQueue( )->InsertCallback( this, 
+                (CallbackPtr)&NVMain::TelemetryCallback,
+                GetEventQueue( )->GetCurrentCycle( ) + telemetry->GetInterval( ) );
+    }
+
+    if( ownTracer != NULL && ownTracer->GetDumpInterval( ) != 0 )
+    {
+        GetEventQueue( )->InsertCallback( this, 
+                (CallbackPtr)&NVMain::TraceDumpCallback,
+                GetEventQueue( )->GetCurrentCycle( ) + ownTracer->GetDumpInterval( ) );
+    }
 }
 
 void NVMain::CalculateStats( )
+{
+    UpdateStats( );
+
+    ncycle_t currentCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    if( statsSink != NULL && (!seriesRecorded || currentCycle != lastSeriesCycle) )
+    {
+        statsSink->Record( currentCycle );
+        lastSeriesCycle = currentCycle;
+        seriesRecorded = true;
+    }
+}
+
+void NVMain::UpdateStats( )
 {
     for( unsigned int i = 0; i < numChannels; i++ )
         memoryControllers[i]->CalculateStats( );
+
+    if( latencyProfile != NULL )
+    {
+        latencyProfile->Clear( );
+
+        for( unsigned int i = 0; i < numChannels; i++ )
+        {
+            if( memoryControllers[i]->GetLatencyProfile( ) != NULL )
+                latencyProfile->Merge( *memoryControllers[i]->GetLatencyProfile( ) );
+        }
+    }
+}
+
+void NVMain::StatsSeriesCallback( void * /*data*/ )
+{
+    CalculateStats( );
+
+    GetEventQueue( )->InsertCallback( this, 
+            (CallbackPtr)&NVMain::StatsSeriesCallback,
+            GetEventQueue( )->GetCurrentCycle( ) + statsSeriesInterval );
+}
+
+void NVMain::TelemetryCallback( void * /*data*/ )
+{
+    TelemetrySample sample;
+
+    /* Energy is only brought up to date when stats are calculated. */
+    UpdateStats( );
+
+    sample.cycle = GetEventQueue( )->GetCurrentCycle( );
+    sample.requestsCompleted = requestsCompleted;
+    sample.cimCompleted = cimRequestsCompleted;
+    sample.queueDepth = 0;
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+        sample.queueDepth += memoryControllers[i]->GetQueueDepth( );
+
+    telemetry->Publish( sample );
+
+    GetEventQueue( )->InsertCallback( this, 
+            (CallbackPtr)&NVMain::TelemetryCallback,
+            GetEventQueue( )->GetCurrentCycle( ) + telemetry->GetInterval( ) );
+}
+
+void NVMain::TraceDumpCallback( void * /*data*/ )
+{
+    std::stringstream dumpName;
+
+    dumpName << ownTracer->GetTraceFile( ) << "." << GetEventQueue( )->GetCurrentCycle( );
+    ownTracer->Dump( dumpName.str( ) );
+
+    GetEventQueue( )->InsertCallback( this, 
+            (CallbackPtr)&NVMain::TraceDumpCallback,
+            GetEventQueue( )->GetCurrentCycle( ) + ownTracer->GetDumpInterval( ) );
+}
+
+/* Writes the trace ring now, e.g., from a driver that saw something odd. */
+bool NVMain::DumpTrace( std::string filename )
+{
+    if( GetTracer( ) == NULL )
+        return false;
+
+    return GetTracer( )->Dump( filename );
+}
+
+/*
+ *  The memory is checkpointed as a whole: the clock, every module below
+ *  and, last, the stats they registered.
+ */
+void NVMain::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter writer( dir, StatName( ) );
+
+    writer.Write( GetEventQueue( )->GetCurrentCycle( ) );
+    writer.Write( GetEventQueue( )->GetLastEventCycle( ) );
+    writer.Write( requestsCompleted );
+    writer.Write( cimRequestsCompleted );
+    writer.Write( lastSeriesCycle );
+    writer.Write( seriesRecorded );
+
+    NVMObject::CreateCheckpoint( dir );
+
+    GetStats( )->CreateCheckpoint( dir );
+}
+
+void NVMain::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+    ncycle_t currentCycle, lastEventCycle;
+
+    reader.Read( currentCycle );
+    reader.Read( lastEventCycle );
+    reader.Read( requestsCompleted );
+    reader.Read( cimRequestsCompleted );
+    reader.Read( lastSeriesCycle );
+    reader.Read( seriesRecorded );
+
+    /* Move the clock first so modules may schedule at their saved times. */
+    GetEventQueue( )->RestoreCycles( currentCycle, lastEventCycle );
+
+    NVMObject::RestoreCheckpoint( dir );
+
+    GetStats( )->RestoreCheckpoint( dir );
 }
 
 void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
@@ -40,6 +40,10 @@
 #include "src/Params.h"
 #include "src/NVMObject.h"
 #include "src/Prefetcher.h"
+#include "src/LatencyProfile.h"
+#include "src/StatsSink.h"
+#include "src/Telemetry.h"
+#include "src/Tracing.h"
 #include "include/NVMainRequest.h"
 #include "traceWriter/GenericTraceWriter.h"
 #include <queue>
@@ -72,12 +76,21 @@ class NVMain : public NVMObject
     bool RequestComplete( NVMainRequest *request );
 
     bool CheckPrefetch( NVMainRequest *request );
+    void CheckCIMOperandRows( NVMainRequest *request );
 
     void RegisterStats( );
     void CalculateStats( );
+    void StatsSeriesCallback( void *data );
+    void TelemetryCallback( void *data );
+    void TraceDumpCallback( void *data );
+
+    bool DumpTrace( std::string filename );
 
     void Cycle( ncycle_t steps );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
     void EnqueuePendingMemoryRequests( NVMainRequest *request );
 
   private:
@@ -92,6 +105,25 @@ class NVMain : public NVMObject
     ncounter_t successfulPrefetches;
     ncounter_t unsuccessfulPrefetches;
 
+    /* Merged from the channels' profiles in CalculateStats. */
+    LatencyProfile *latencyProfile;
+
+    /* Time-series export, written whenever the stats are calculated. */
+    StatsSink *statsSink;
+    ncycle_t statsSeriesInterval;
+    ncycle_t lastSeriesCycle;
+    bool seriesRecorded;
+
+    /* Live snapshots for long runs; see src/Telemetry.h. */
+    Telemetry *telemetry;
+    ncounter_t requestsCompleted;
+    ncounter_t cimRequestsCompleted;
+
+    /* Trace ring of this memory system, unless a parent already has one. */
+    Tracer *ownTracer;
+
+    void UpdateStats( );
+
     unsigned int numChannels;
     double syncValue;
 
@@ -35,7 +35,9 @@
 
 #include "Ranks/StandardRank/StandardRank.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "Banks/BankFactory.h"
+#include "EnergyModels/EnergyModelFactory.h"
 
 #include <iostream>
 #include <sstream>
@@ -83,9 +85,14 @@ StandardRank::StandardRank( )
     lastActivate = NULL;
     RAWindex = 0;
 
+    energyModel = NULL;
+    for( int bgState = 0; bgState < BACKGROUND_STATE_COUNT; bgState++ )
+        backgroundEnergyRate[bgState] = 0.0;
+
     conf = NULL;
 
     state = STANDARDRANK_CLOSED;
+    lastStateChange = 0;
     backgroundEnergy = 0.0f;
 
     psInterval = 0;
@@ -95,15 +102,14 @@ StandardRank::StandardRank( )
 StandardRank::~StandardRank( )
 {
     delete [] lastActivate;
+    delete energyModel;
 }
 
 void StandardRank::SetConfig( Config *c, bool createChildren )
 {
     conf = c;
 
-    Params *params = new Params( );
-    params->SetParams( c );
-    SetParams( params );
+    SetParams( c->GetParams( ) );
 
     deviceWidth = p->DeviceWidth;
     busWidth = p->BusWidth;
@@ -131,6 +137,25 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
 
     bankCount = p->BANKS;
 
+    /* The devices of a rank are in lockstep, so their drivers are pooled. */
+    writeDriverPool.SetDrivers( p->ChipWriteDrivers * deviceCount );
+
+    /* 
+     *  Background energy per cycle in each power state. Current based models
+     *  give the energy of a single device, and all devices are in lockstep.
+     */
+    energyModel = EnergyModelFactory::CreateEnergyModel( p->EnergyModel );
+    energyModel->SetParams( p );
+
+    for( int bgState = 0; bgState < BACKGROUND_STATE_COUNT; bgState++ )
+    {
+        backgroundEnergyRate[bgState] = energyModel->GetBackgroundEnergy( 
+                                            static_cast<BackgroundState>(bgState) );
+
+        if( energyModel->IsCurrentBased( ) )
+            backgroundEnergyRate[bgState] *= (double)deviceCount;
+    }
+
     if( createChildren )
     {
         /* When selecting a child, use the bank field from the decoder. */
@@ -190,7 +215,7 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
 
 void StandardRank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         AddUnitStat(totalEnergy, "mA*t");
         AddUnitStat(backgroundEnergy, "mA*t");
@@ -278,7 +303,7 @@ bool StandardRank::Activate( NVMainRequest *request )
         GetChild( request )->IssueCommand( request );
 
         if( state == STANDARDRANK_CLOSED )
-            state = STANDARDRANK_OPEN;
+            ChangeState( STANDARDRANK_OPEN );
 
         /* move to the next counter */
         RAWindex = (RAWindex + 1) % rawNum;
@@ -430,7 +455,7 @@ bool StandardRank::Precharge( NVMainRequest *request )
     bool success = GetChild( request )->IssueCommand( request );
 
     if( Idle( ) )
-        state = STANDARDRANK_CLOSED;
+        ChangeState( STANDARDRANK_CLOSED );
 
     nextPrecharge = MAX( nextPrecharge, 
                          GetEventQueue()->GetCurrentCycle() + p->tPPD );
@@ -482,15 +507,15 @@ bool StandardRank::PowerDown( NVMainRequest *request )
     switch( request->type )
     {
         case POWERDOWN_PDA:
-            state = STANDARDRANK_PDA;
+            ChangeState( STANDARDRANK_PDA );
             break;
 
         case POWERDOWN_PDPF:
-            state = STANDARDRANK_PDPF;
+            ChangeState( STANDARDRANK_PDPF );
             break;
 
         case POWERDOWN_PDPS:
-            state = STANDARDRANK_PDPS;
+            ChangeState( STANDARDRANK_PDPS );
             break;
 
         default:
@@ -549,18 +574,18 @@ bool StandardRank::PowerUp( NVMainRequest *request )
     switch( state )
     {
         case STANDARDRANK_PDA:
-            state = STANDARDRANK_OPEN;
+            ChangeState( STANDARDRANK_OPEN );
             puTimer = p->tXP;
             break;
 
         case STANDARDRANK_PDPF:
             puTimer = p->tXP;
-            state = STANDARDRANK_CLOSED;
+            ChangeState( STANDARDRANK_CLOSED );
             break;
 
         case STANDARDRANK_PDPS:
             puTimer = p->tXPDLL;
-            state = STANDARDRANK_CLOSED;
+            ChangeState( STANDARDRANK_CLOSED );
             break;
 
         default:
@@ -596,7 +621,7 @@ bool StandardRank::Refresh( NVMainRequest *request )
         GetChild( refreshBankGroupHead+i )->IssueCommand( refReq );
     }
 
-    state = STANDARDRANK_REFRESHING;
+    ChangeState( STANDARDRANK_REFRESHING );
 
     request->owner = this;
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
@@ -849,6 +874,11 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+bool StandardRank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 /* 
  *  Other ranks should notify us when they read/write so we can ensure minimum 
  *  timings are met.
@@ -899,7 +929,7 @@ bool StandardRank::RequestComplete( NVMainRequest* req )
             case REFRESH:
                 {
                     if( Idle( ) )
-                        state = STANDARDRANK_CLOSED;
+                        ChangeState( STANDARDRANK_CLOSED );
 
                     break;
                 }
@@ -920,60 +950,67 @@ void StandardRank::Cycle( ncycle_t steps )
     for( ncounter_t childIdx = 0; childIdx < GetChildCount( ); childIdx++ )
         GetChild( childIdx )->Cycle( steps );
 
+    /* Background energy is integrated at state transitions, see ChangeState. */
+}
+
+void StandardRank::ChangeState( StandardRank_State nextState )
+{
+    UpdateBackgroundEnergy( );
+
+    state = nextState;
+}
+
+/*
+ *  Charge the cycles since the last state transition to the current state.
+ *  This is only needed when the state changes and when stats are printed,
+ *  so idle ranks don't have to be woken up to account their energy.
+ */
+void StandardRank::UpdateBackgroundEnergy( )
+{
+    ncycle_t currentCycle = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t steps = currentCycle - lastStateChange;
+
+    lastStateChange = currentCycle;
+
+    if( steps == 0 )
+        return;
+
     /* Count cycle numbers and calculate background energy for each state */
     switch( state )
     {
         /* active powerdown */
         case STANDARDRANK_PDA:
             fastExitActiveCycles += steps;
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD3P * (double)steps ) * (double)deviceCount;  
-            else
-                backgroundEnergy += ( p->Epda * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_ACTIVE_POWERDOWN] * (double)steps;
             break;
 
         /* precharge powerdown fast exit */
         case STANDARDRANK_PDPF:
             fastExitPrechargeCycles += steps;
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD2P1 * (double)steps ) * (double)deviceCount;
-            else 
-                backgroundEnergy += ( p->Epdpf * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_PRECHARGE_POWERDOWN_FAST] * (double)steps;
             break;
 
         /* precharge powerdown slow exit */
         case STANDARDRANK_PDPS:
             slowExitCycles += steps;
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD2P0 * (double)steps ) * (double)deviceCount;  
-            else 
-                backgroundEnergy += ( p->Epdps * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_PRECHARGE_POWERDOWN_SLOW] * (double)steps;
             break;
 
         /* active standby */
         case STANDARDRANK_REFRESHING:
         case STANDARDRANK_OPEN:
             activeCycles += steps;
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD3N * (double)steps ) * (double)deviceCount;  
-            else
-                backgroundEnergy += ( p->Eactstdby * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_ACTIVE_STANDBY] * (double)steps;
             break;
 
         /* precharge standby */
         case STANDARDRANK_CLOSED:
             standbyCycles += steps;
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
-            else
-                backgroundEnergy += ( p->Eprestdby * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_PRECHARGE_STANDBY] * (double)steps;
             break;
 
         default:
-            if( p->EnergyModel == "current" )
-                backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
-            else
-                backgroundEnergy += ( p->Eprestdby * (double)steps );  
+            backgroundEnergy += backgroundEnergyRate[BACKGROUND_PRECHARGE_STANDBY] * (double)steps;
             break;
     }
 }
@@ -982,6 +1019,8 @@ void StandardRank::CalculateStats( )
 {
     NVMObject::CalculateStats( );
 
+    UpdateBackgroundEnergy( );
+
     totalEnergy = activateEnergy = burstEnergy = refreshEnergy = 0.0;
     totalPower = backgroundPower = activatePower = burstPower = refreshPower = 0.0;
     reads = writes = 0;
@@ -1009,7 +1048,7 @@ void StandardRank::CalculateStats( )
     /* Get simulation time in nanoseconds (ns). Since energy is in nJ, energy / ns = W */
     double simulationTime = 1.0;
     
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         simulationTime = GetEventQueue()->GetCurrentCycle() - lastReset;
     }
@@ -1022,7 +1061,7 @@ void StandardRank::CalculateStats( )
     if( simulationTime != 0 )
     {
         /* power in W */
-        if( p->EnergyModel == "current" )
+        if( energyModel->IsCurrentBased( ) )
         {
             backgroundPower = ( backgroundEnergy / (double)deviceCount * p->Voltage ) / (double)simulationTime / 1000.0; 
             activatePower = ( activateEnergy * p->Voltage ) / (double)simulationTime / 1000.0; 
@@ -1039,7 +1078,7 @@ void StandardRank::CalculateStats( )
     }
 
     /* Current mode is measured on a per-device basis. */
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         /* energy breakdown. device is in lockstep within a rank */
         activateEnergy *= (double)deviceCount;
@@ -1065,3 +1104,47 @@ void StandardRank::ResetStats( )
     lastReset = GetEventQueue()->GetCurrentCycle();
 }
 
+
+void StandardRank::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter writer( dir, StatName( ) );
+
+    writer.Write( state );
+    writer.Write( lastStateChange );
+    writer.WriteArray( lastActivate, rawNum );
+    writer.Write( RAWindex );
+    writer.Write( nextRead );
+    writer.Write( nextWrite );
+    writer.Write( nextActivate );
+    writer.Write( nextPrecharge );
+    writer.Write( activeCycles );
+    writer.Write( standbyCycles );
+    writer.Write( fastExitActiveCycles );
+    writer.Write( fastExitPrechargeCycles );
+    writer.Write( slowExitCycles );
+    writer.Write( lastReset );
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void StandardRank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+
+    reader.Read( state );
+    reader.Read( lastStateChange );
+    reader.ReadArray( lastActivate, rawNum );
+    reader.Read( RAWindex );
+    reader.Read( nextRead );
+    reader.Read( nextWrite );
+    reader.Read( nextActivate );
+    reader.Read( nextPrecharge );
+    reader.Read( activeCycles );
+    reader.Read( standbyCycles );
+    reader.Read( fastExitActiveCycles );
+    reader.Read( fastExitPrechargeCycles );
+    reader.Read( slowExitCycles );
+    reader.Read( lastReset );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
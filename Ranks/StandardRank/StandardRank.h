@@ -38,6 +38,7 @@
 
 #include "src/Rank.h"
 #include "src/Bank.h"
+#include "src/EnergyModel.h"
 
 #include <cstdint>
 #include <list>
@@ -78,6 +79,7 @@ class StandardRank : public Rank
     void SetConfig( Config *c, bool createChildren = true );
 
     bool IssueCommand( NVMainRequest *request );
+    bool IssueAtomic( NVMainRequest *request );
     bool IsIssuable( NVMainRequest *request, FailReason *reason = NULL );
     void Notify( NVMainRequest *request );
     bool RequestComplete( NVMainRequest* );
@@ -93,17 +95,23 @@ class StandardRank : public Rank
     void CalculateStats( );
     void ResetStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     Config *conf;
     ncounter_t stateTimeout;
     uint64_t psInterval;
     StandardRank_State state;
+    ncycle_t lastStateChange;
 
     ncounter_t bankCount;
     ncounter_t deviceWidth;
     ncounter_t deviceCount;
     ncounter_t busWidth;
     ncycle_t* lastActivate;
+    EnergyModel *energyModel;
+    double backgroundEnergyRate[BACKGROUND_STATE_COUNT];
     ncounter_t RAWindex;
     ncounter_t rawNum;
     ncounter_t banksPerRefresh;
@@ -144,6 +152,9 @@ class StandardRank : public Rank
     bool PowerUp( NVMainRequest *request );
     bool CanPowerDown( NVMainRequest *request );
     bool CanPowerUp( NVMainRequest *request );
+
+    void ChangeState( StandardRank_State nextState );
+    void UpdateBackgroundEnergy( );
 };
 
 };
@@ -0,0 +1,85 @@
+#!/usr/bin/python
+
+#
+#  Prints the live telemetry of a running NVMain simulation, see
+#  src/Telemetry.h. Use -f for TelemetryMode shm and -s for socket.
+#
+
+from optparse import OptionParser
+import mmap
+import socket
+import struct
+import time
+
+
+parser = OptionParser()
+parser.add_option("-f","--file", help="Snapshot file (TelemetryMode shm)")
+parser.add_option("-s","--socket", help="Socket path (TelemetryMode socket)")
+parser.add_option("-w","--watch", type="float", default=0, help="Repeat every N seconds")
+
+(options, args) = parser.parse_args()
+
+# magic, version, statCount, nameBytes, sequence, cycle, wallNanoseconds,
+# cyclesPerSecond, requestsCompleted, cimCompleted, cimPerSecond,
+# queueDepth, energy
+header_format = "<4sIIIQQQdQQdQd"
+header_size = struct.calcsize(header_format)
+fields = ["cycle", "wallNanoseconds", "cyclesPerSecond", "requestsCompleted",
+          "cimCompleted", "cimPerSecond", "queueDepth", "energy"]
+
+
+def read_file(path):
+    with open(path, "rb") as handle:
+        block = mmap.mmap(handle.fileno(), 0, access=mmap.ACCESS_READ)
+
+        # Seqlock read: retry while the simulator is updating the snapshot.
+        while True:
+            before = struct.unpack_from("<Q", block, 16)[0]
+            data = block[:]
+            after = struct.unpack_from("<Q", block, 16)[0]
+            if before % 2 == 0 and before == after:
+                break
+            time.sleep(0.001)
+
+        block.close()
+
+    header = struct.unpack_from(header_format, data)
+    if header[0] != b"NVMX":
+        return "Snapshot is not ready yet."
+
+    stat_count = header[2]
+    values = struct.unpack_from("<%dd" % stat_count, data, header_size)
+    names = data[header_size + 8 * stat_count:].split(b"\0")
+
+    lines = ["sequence %d" % header[4]]
+    lines += ["%s %s" % (name, value) for name, value in zip(fields, header[5:])]
+    lines += ["%s %s" % (name.decode(), value) for name, value in zip(names, values)]
+    return "\n".join(lines)
+
+
+def read_socket(path):
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    client.connect(path)
+
+    reply = b""
+    while True:
+        chunk = client.recv(65536)
+        if not chunk:
+            break
+        reply += chunk
+
+    client.close()
+    return reply.decode().rstrip()
+
+
+while True:
+    if options.file:
+        print(read_file(options.file))
+    else:
+        print(read_socket(options.socket))
+
+    if options.watch <= 0:
+        break
+
+    print("")
+    time.sleep(options.watch)
@@ -50,6 +50,8 @@ class NVMainMemory(NVMInterface):
     configparams = Param.String("", "Custom NVmain parameters (defaults to '')")
     configvalues = Param.String("", "Values to NVmain paramters (defaults to '')")
     NVMainWarmUp = Param.Bool(False, "Enable to warm up the internal cache in NVMain")
+    batch_requests = Param.Bool(False, "Queue timing packets and hand them to NVMain once per clock edge")
+    batch_queue_size = Param.Unsigned(64, "Packets that may wait for a batched handoff before requesters must retry")
 
 
     def __init__(self, *args, **kwargs):
@@ -76,6 +78,10 @@ class NVMainMemory(NVMInterface):
                     self.atomic_variance = param_value
                 elif param_name == "warmup":
                     self.NVMainWarmUp = True
+                elif param_name == "batch":
+                    self.batch_requests = True
+                elif param_name == "batch-size":
+                    self.batch_queue_size = int(param_value)
                 elif param_name == "config":
                     self.config = param_value
                 elif param_name == "rowbuffer-size":
@@ -66,10 +66,11 @@ using namespace NVM;
 NVMainMemory *NVMainMemory::masterInstance = NULL;
 
 NVMainMemory::NVMainMemory(const Params &p)
-    : NVMInterface(p), clockEvent(this), respondEvent(this),
+    : NVMInterface(p), clockEvent(this), respondEvent(this), flushEvent(this),
       drainManager(NULL), lat(p.atomic_latency),
       lat_var(p.atomic_variance), nvmain_atomic(p.atomic_mode),
-      NVMainWarmUp(p.NVMainWarmUp), port(name() + ".port", *this)
+      NVMainWarmUp(p.NVMainWarmUp), batchRequests(p.batch_requests),
+      batchQueueSize(p.batch_queue_size), port(name() + ".port", *this)
 {
     std::cout << "And I've been called!" << std::endl;
     char *cfgparams;
@@ -129,6 +130,9 @@ NVMainMemory::NVMainMemory(const Params &p)
 NVMainMemory::~NVMainMemory()
 {
     std::cout << "NVMain dtor called" << std::endl;
+
+    for( size_t i = 0; i < freeMemRequests.size(); i++ )
+        delete freeMemRequests[i];
 }
 
 
@@ -305,55 +309,43 @@ gem5::AddrRangeList NVMainMemory::MemoryPort::getAddrRanges() const
 void
 NVMainMemory::SetRequestData(NVMainRequest *request, gem5::PacketPtr pkt)
 {
-    uint8_t *hostAddr;
+    unsigned size = pkt->getSize();
+
+    request->data.SetSize( size );
+    request->oldData.SetSize( size );
 
-    request->data.SetSize( pkt->getSize() );
-    request->oldData.SetSize( pkt->getSize() );
+    /* The array contents before this request are read straight into oldData. */
+    gem5::RequestPtr dataReq = std::make_shared<gem5::Request>(pkt->getAddr(), size, 0, gem5::Request::funcRequestorId);
+    gem5::Packet dataPkt(dataReq, gem5::MemCmd::ReadReq);
+    dataPkt.dataStatic( request->oldData.rawData );
+    doFunctionalAccess( &dataPkt );
 
     if (pkt->isRead() || pkt->isPIM())
-    {
-        gem5::RequestPtr dataReq = std::make_shared<gem5::Request>(pkt->getAddr(), pkt->getSize(), 0, gem5::Request::funcRequestorId);
-        gem5::PacketPtr dataPkt = new gem5::Packet(dataReq, gem5::MemCmd::ReadReq);
-        dataPkt->allocate();
-        doFunctionalAccess(dataPkt);
+        memcpy( request->data.rawData, request->oldData.rawData, size );
+    else
+        memcpy( request->data.rawData, pkt->getConstPtr<uint8_t>(), size );
+}
 
-        hostAddr = new uint8_t[ pkt->getSize() ];
-        memcpy( hostAddr, dataPkt->getPtr<uint8_t>(), pkt->getSize() );
 
-        for(int i = 0; i < pkt->getSize(); i++ )
-        {
-            request->oldData.SetByte(i, *(hostAddr + i));
-            request->data.SetByte(i, *(hostAddr + i));
-        }
+NVMainMemory::NVMainMemoryRequest *
+NVMainMemory::AllocateMemoryRequest( )
+{
+    std::vector<NVMainMemoryRequest *>& freeList = masterInstance->freeMemRequests;
 
-        delete dataPkt;
-        delete &dataReq;
-        delete [] hostAddr;
-    }
-    else
-    {
-        gem5::RequestPtr dataReq = std::make_shared<gem5::Request>(pkt->getAddr(), pkt->getSize(), 0, gem5::Request::funcRequestorId);
-        gem5::PacketPtr dataPkt = new gem5::Packet(dataReq, gem5::MemCmd::ReadReq);
-        dataPkt->allocate();
-        doFunctionalAccess(dataPkt);
+    if( freeList.empty() )
+        return new NVMainMemoryRequest;
 
-        uint8_t *hostAddrT = new uint8_t[ pkt->getSize() ];
-        memcpy( hostAddrT, dataPkt->getPtr<uint8_t>(), pkt->getSize() );
+    NVMainMemoryRequest *memRequest = freeList.back();
+    freeList.pop_back();
 
-        hostAddr = new uint8_t[ pkt->getSize() ];
-        memcpy( hostAddr, pkt->getPtr<uint8_t>(), pkt->getSize() );
+    return memRequest;
+}
 
-        for(int i = 0; i < pkt->getSize(); i++ )
-        {
-            request->oldData.SetByte(i, *(hostAddrT + i));
-            request->data.SetByte(i, *(hostAddr + i));
-        }
 
-        delete dataPkt;
-        delete &dataReq;
-        delete [] hostAddrT;
-        delete [] hostAddr;
-    }
+void
+NVMainMemory::ReleaseMemoryRequest( NVMainMemoryRequest *memRequest )
+{
+    masterInstance->freeMemRequests.push_back( memRequest );
 }
 
 
@@ -424,6 +416,11 @@ NVMainMemory::MemoryPort::recvFunctional(gem5::PacketPtr pkt)
          i != memory.responseQueue.end(); ++i )
         pkt->trySatisfyFunctional((gem5::PacketPtr) (*i));
 
+    /* Writes waiting for a flush hold newer data than the array. */
+    for( std::deque<QueuedPacket>::iterator i = masterInstance->packetQueue.begin();
+         i != masterInstance->packetQueue.end(); ++i )
+        pkt->trySatisfyFunctional(i->packet);
+
     pkt->popLabel();
 }
 
@@ -476,36 +473,73 @@ NVMainMemory::MemoryPort::recvTimingReq(gem5::PacketPtr pkt)
     // Bus latency is modeled in NVMain.
     pkt->headerDelay = pkt->payloadDelay = 0;
 
-    NVMainRequest *request = new NVMainRequest( );
-
-    bool canQueue, enqueued = false;
-    
-    memory.SetRequestData( request, pkt );
     /*
-     *  NVMain expects linear addresses, so hack: If we are not the master
-     *  instance, assume there are two channels because 3GB-4GB is skipped
-     *  in X86 and subtract 1GB.
-     *
-     *  TODO: Have each channel communicate it's address range to determine
-     *  this fix up value.
+     *  Batched handoff: reads and writes wait on the gem5 side and are
+     *  issued together at the next clock edge by FlushPackets().
      */
-    uint64_t addressFixUp = 0;
-//FIXME#if THE_ISA == X86_ISA
-    if( masterInstance != &memory )
+    if( memory.batchRequests )
     {
-        addressFixUp = 0x40000000;
+        if( !pkt->isPIM() )
+        {
+            if( masterInstance->packetQueue.size() >= memory.batchQueueSize )
+            {
+                DPRINTF(NVMain, "nvmain_mem.cc: Packet queue full, 0x%x must retry\n", pkt->getAddr( ) );
+
+                if (pkt->isRead())
+                    memory.retryRead = true;
+                else
+                    memory.retryWrite = true;
+
+                return false;
+            }
+
+            QueuedPacket queued;
+
+            queued.packet = pkt;
+            queued.instance = &memory;
+
+            masterInstance->packetQueue.push_back( queued );
+
+            if( !masterInstance->flushEvent.scheduled() )
+                masterInstance->schedule( masterInstance->flushEvent, memory.clockEdge() );
+
+            return true;
+        }
+
+        /*
+         *  PIM operands may be written by queued packets, so the PIM packet
+         *  is retried once the scheduled flush has issued them.
+         */
+        if( !masterInstance->packetQueue.empty() )
+        {
+            memory.retryRead = true;
+            return false;
+        }
     }
-//FIXME#elif THE_ISA == ARM_ISA
-//FIXME    /* 
-//FIXME     *  ARM regions are 2GB - 4GB followed by 34 GB - 64 GB. Work for up to
-//FIXME     *  34 GB of memory. Further regions from 512 GB - 992 GB.
-//FIXME     */
-//FIXME    addressFixUp = (masterInstance == &memory) ? 0x80000000 : 0x800000000;
-//FIXME#endif
+
+    bool canQueue, enqueued = false;
     
     //PIM will be here
     if (pkt->isPIM()) 
     {
+        NVMainRequest *request = new NVMainRequest( );
+
+        memory.SetRequestData( request, pkt );
+
+        /*
+         *  NVMain expects linear addresses, so hack: If we are not the master
+         *  instance, assume there are two channels because 3GB-4GB is skipped
+         *  in X86 and subtract 1GB.
+         *
+         *  TODO: Have each channel communicate it's address range to determine
+         *  this fix up value.
+         */
+        uint64_t addressFixUp = 0;
+        if( masterInstance != &memory )
+        {
+            addressFixUp = 0x40000000;
+        }
+
         DPRINTF(PIM, "Received PIM pkt in NVMain!\n");
         std::cout << "Received PIM pkt in NVMain!" << std::endl;
         //FIXMEPacket::PIMSenderState* senderState = dynamic_cast<Packet::PIMSenderState*>(pkt->senderState);
@@ -555,7 +589,7 @@ NVMainMemory::MemoryPort::recvTimingReq(gem5::PacketPtr pkt)
             enqueued = memory.masterInstance->GetChild( )->IssueCommand(request);
             assert( enqueued == true );
         
-            NVMainMemoryRequest *memRequest = new NVMainMemoryRequest;
+            NVMainMemoryRequest *memRequest = memory.AllocateMemoryRequest( );
        
             memRequest->request = request;
             memRequest->packet = pkt;
@@ -565,38 +599,7 @@ NVMainMemory::MemoryPort::recvTimingReq(gem5::PacketPtr pkt)
             DPRINTF(NVMain, "nvmain_mem.cc: Enqueued Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), "PIM" );
 
             /* See if we need to reschedule the wakeup event sooner. */
-            ncycle_t nextEvent = memory.masterInstance->m_nvmainGlobalEventQueue->GetNextEvent(NULL);
-            DPRINTF(NVMain, "NVMainMemory: Next event after issue is %d\n", nextEvent);
-            if( nextEvent < memory.nextEventCycle && masterInstance->clockEvent.scheduled() ) {
-                ncycle_t currentCycle = memory.masterInstance->m_nvmainGlobalEventQueue->GetCurrentCycle();
-                
-                //assert(nextEvent >= currentCycle);
-                ncycle_t stepCycles;
-                if( nextEvent > currentCycle )
-                    stepCycles = nextEvent - currentCycle;
-                else
-                    stepCycles = 1;
-
-                gem5::Tick nextWake = gem5::curTick() + memory.clock * static_cast<gem5::Tick>(stepCycles);
-
-                DPRINTF(NVMain, "NVMainMemory: Next event: %d CurrentCycle: %d\n", nextEvent, currentCycle);
-                DPRINTF(NVMain, "NVMainMemory: Rescheduled wake at %d after %d cycles\n", nextWake, stepCycles);
-
-                memory.nextEventCycle = nextEvent;
-                memory.ScheduleClockEvent( nextWake );
-            } else if( !masterInstance->clockEvent.scheduled() ) {
-                ncycle_t currentCycle = memory.masterInstance->m_nvmainGlobalEventQueue->GetCurrentCycle();
-
-                //assert(nextEvent >= currentCycle);
-                ncycle_t stepCycles = nextEvent - currentCycle;
-                if( stepCycles == 0 || nextEvent < currentCycle )
-                    stepCycles = 1;
-
-                gem5::Tick nextWake = gem5::curTick() + memory.clock * static_cast<gem5::Tick>(stepCycles);
-
-                memory.nextEventCycle = nextEvent;
-                memory.ScheduleClockEvent( nextWake );
-            }
+            memory.masterInstance->ScheduleNextWake( );
             
             memory.masterInstance->m_request_map.insert( std::pair<NVMainRequest *, NVMainMemoryRequest *>( request, memRequest ) );
             memory.m_requests_outstanding++;
@@ -652,135 +655,193 @@ NVMainMemory::MemoryPort::recvTimingReq(gem5::PacketPtr pkt)
     {
         // packet size of baseline cpu's packet is 64 byte
         //std::cout << "Size of packet: " << pkt->getSize() << std::endl;
-        
-        request->access = UNKNOWN_ACCESS;
-        request->address.SetPhysicalAddress(pkt->req->getPaddr() - addressFixUp);
-        request->status = MEM_REQUEST_INCOMPLETE;
-        request->type = (pkt->isRead()) ? READ : WRITE;
-        request->owner = (NVMObject *)&memory;
 
-        if(pkt->req->hasPC()) request->programCounter = pkt->req->getPC();
-        if(pkt->req->hasContextId()) request->threadId = pkt->req->contextId();
+        enqueued = memory.IssuePacket( pkt );
 
-        /* Call hooks here manually, since there is no one else to do it. */
-        std::vector<NVMObject *>& preHooks  = memory.masterInstance->GetHooks( NVMHOOK_PREISSUE );
-        std::vector<NVMObject *>& postHooks = memory.masterInstance->GetHooks( NVMHOOK_POSTISSUE );
-        std::vector<NVMObject *>::iterator it;
-
-        canQueue = memory.masterInstance->GetChild( )->IsIssuable( request );
-
-        if( canQueue )
+        if( enqueued )
+        {
+            /* See if we need to reschedule the wakeup event sooner. */
+            memory.masterInstance->ScheduleNextWake( );
+        }
+        else
         {
-            /* Call pre-issue hooks */
-            for( it = preHooks.begin(); it != preHooks.end(); it++ )
+            if (pkt->isRead())
             {
-                (*it)->SetParent( memory.masterInstance );
-                (*it)->IssueCommand( request );
+                memory.retryRead = true;
             }
+            else
+            {
+                memory.retryWrite = true;
+            }
+        }
+    }
+    return enqueued;
+}
 
-            enqueued = memory.masterInstance->GetChild( )->IssueCommand(request);
-            assert( enqueued == true );
 
-            NVMainMemoryRequest *memRequest = new NVMainMemoryRequest;
+/*
+ *  Hands a read or write packet received on this instance's port to
+ *  NVMain. Returns false, having allocated nothing, if the memory
+ *  controller can not take the request yet.
+ */
+bool
+NVMainMemory::IssuePacket(gem5::PacketPtr pkt)
+{
+    /*
+     *  NVMain expects linear addresses, so hack: If we are not the master
+     *  instance, assume there are two channels because 3GB-4GB is skipped
+     *  in X86 and subtract 1GB.
+     *
+     *  TODO: Have each channel communicate it's address range to determine
+     *  this fix up value.
+     */
+    uint64_t addressFixUp = 0;
+//FIXME#if THE_ISA == X86_ISA
+    if( masterInstance != this )
+    {
+        addressFixUp = 0x40000000;
+    }
+//FIXME#elif THE_ISA == ARM_ISA
+//FIXME    /* 
+//FIXME     *  ARM regions are 2GB - 4GB followed by 34 GB - 64 GB. Work for up to
+//FIXME     *  34 GB of memory. Further regions from 512 GB - 992 GB.
+//FIXME     */
+//FIXME    addressFixUp = (masterInstance == this) ? 0x80000000 : 0x800000000;
+//FIXME#endif
+
+    NVMainRequest *request = new NVMainRequest( );
 
-            memRequest->request = request;
-            memRequest->packet = pkt;
-            memRequest->issueTick = gem5::curTick();
-            memRequest->atomic = false;
+    request->access = UNKNOWN_ACCESS;
+    request->address.SetPhysicalAddress(pkt->req->getPaddr() - addressFixUp);
+    request->status = MEM_REQUEST_INCOMPLETE;
+    request->type = (pkt->isRead()) ? READ : WRITE;
+    request->owner = (NVMObject *)this;
 
-            DPRINTF(NVMain, "nvmain_mem.cc: Enqueued Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
+    if(pkt->req->hasPC()) request->programCounter = pkt->req->getPC();
+    if(pkt->req->hasContextId()) request->threadId = pkt->req->contextId();
 
-            /* See if we need to reschedule the wakeup event sooner. */
-            ncycle_t nextEvent = memory.masterInstance->m_nvmainGlobalEventQueue->GetNextEvent(NULL);
-            DPRINTF(NVMain, "NVMainMemory: Next event after issue is %d\n", nextEvent);
-            if( nextEvent < memory.nextEventCycle && masterInstance->clockEvent.scheduled() )
-            {
-                ncycle_t currentCycle = memory.masterInstance->m_nvmainGlobalEventQueue->GetCurrentCycle();
+    if( !masterInstance->GetChild( )->IsIssuable( request ) )
+    {
+        DPRINTF(NVMain, "nvmain_mem.cc: Can not enqueue Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
+        DPRINTF(NVMainMin, "nvmain_mem.cc: Can not enqueue Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
 
-                //assert(nextEvent >= currentCycle);
-                ncycle_t stepCycles;
-                if( nextEvent > currentCycle )
-                    stepCycles = nextEvent - currentCycle;
-                else
-                    stepCycles = 1;
+        delete request;
+        return false;
+    }
 
-                gem5::Tick nextWake = gem5::curTick() + memory.clock * static_cast<gem5::Tick>(stepCycles);
+    /* The data is only gathered once the request is known to be accepted. */
+    SetRequestData( request, pkt );
 
-                DPRINTF(NVMain, "NVMainMemory: Next event: %d CurrentCycle: %d\n", nextEvent, currentCycle);
-                DPRINTF(NVMain, "NVMainMemory: Rescheduled wake at %d after %d cycles\n", nextWake, stepCycles);
+    /* Call hooks here manually, since there is no one else to do it. */
+    std::vector<NVMObject *>& preHooks  = masterInstance->GetHooks( NVMHOOK_PREISSUE );
+    std::vector<NVMObject *>& postHooks = masterInstance->GetHooks( NVMHOOK_POSTISSUE );
+    std::vector<NVMObject *>::iterator it;
 
-                memory.nextEventCycle = nextEvent;
-                memory.ScheduleClockEvent( nextWake );
-            }
-            else if( !masterInstance->clockEvent.scheduled() )
-            {
-                ncycle_t currentCycle = memory.masterInstance->m_nvmainGlobalEventQueue->GetCurrentCycle();
+    /* Call pre-issue hooks */
+    for( it = preHooks.begin(); it != preHooks.end(); it++ )
+    {
+        (*it)->SetParent( masterInstance );
+        (*it)->IssueCommand( request );
+    }
 
-                //assert(nextEvent >= currentCycle);
-                ncycle_t stepCycles = nextEvent - currentCycle;
-                if( stepCycles == 0 || nextEvent < currentCycle )
-                    stepCycles = 1;
+    bool enqueued = masterInstance->GetChild( )->IssueCommand(request);
+    assert( enqueued == true );
 
-                gem5::Tick nextWake = gem5::curTick() + memory.clock * static_cast<gem5::Tick>(stepCycles);
+    NVMainMemoryRequest *memRequest = AllocateMemoryRequest( );
 
-                memory.nextEventCycle = nextEvent;
-                memory.ScheduleClockEvent( nextWake );
-            }
+    memRequest->request = request;
+    memRequest->packet = pkt;
+    memRequest->issueTick = gem5::curTick();
+    memRequest->atomic = false;
 
-            memory.masterInstance->m_request_map.insert( std::pair<NVMainRequest *, NVMainMemoryRequest *>( request, memRequest ) );
-            memory.m_requests_outstanding++;
+    DPRINTF(NVMain, "nvmain_mem.cc: Enqueued Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
 
-            /*
-             *  It seems gem5 will block until the packet gets a response, so create a copy of the request, so
-             *  the memory controller has it, then delete the original copy to respond to the packet.
-             */
-            if( request->type == WRITE )
-            {
-                NVMainMemoryRequest *requestCopy = new NVMainMemoryRequest( );
+    masterInstance->m_request_map.insert( std::pair<NVMainRequest *, NVMainMemoryRequest *>( request, memRequest ) );
+    m_requests_outstanding++;
 
-                requestCopy->request = new NVMainRequest( );
-                *(requestCopy->request) = *request;
-                requestCopy->packet = pkt;
-                requestCopy->issueTick = gem5::curTick();
-                requestCopy->atomic = false;
+    /*
+     *  It seems gem5 will block until the packet gets a response, so create a copy of the request, so
+     *  the memory controller has it, then delete the original copy to respond to the packet.
+     */
+    if( request->type == WRITE )
+    {
+        NVMainMemoryRequest *requestCopy = AllocateMemoryRequest( );
 
-                memRequest->packet = NULL;
+        requestCopy->request = new NVMainRequest( );
+        *(requestCopy->request) = *request;
+        requestCopy->packet = pkt;
+        requestCopy->issueTick = gem5::curTick();
+        requestCopy->atomic = false;
 
-                memory.masterInstance->m_request_map.insert( std::pair<NVMainRequest *, NVMainMemoryRequest *>( requestCopy->request, requestCopy ) );
-                memory.m_requests_outstanding++;
+        memRequest->packet = NULL;
 
-                memory.RequestComplete( requestCopy->request );
-            }
+        masterInstance->m_request_map.insert( std::pair<NVMainRequest *, NVMainMemoryRequest *>( requestCopy->request, requestCopy ) );
+        m_requests_outstanding++;
 
-            /* Call post-issue hooks. */
-            if( request != NULL )
-            {
-                for( it = postHooks.begin(); it != postHooks.end(); it++ )
-                {
-                    (*it)->SetParent( &memory );
-                    (*it)->IssueCommand( request );
-                }
-            }
-        }
-        else
-        {
-            DPRINTF(NVMain, "nvmain_mem.cc: Can not enqueue Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
-            DPRINTF(NVMainMin, "nvmain_mem.cc: Can not enqueue Mem request for 0x%x of type %s\n", request->address.GetPhysicalAddress( ), ((pkt->isRead()) ? "READ" : "WRITE") );
+        RequestComplete( requestCopy->request );
+    }
 
-            if (pkt->isRead())
-            {
-                memory.retryRead = true;
-            }
-            else
+    /* Call post-issue hooks. */
+    for( it = postHooks.begin(); it != postHooks.end(); it++ )
+    {
+        (*it)->SetParent( this );
+        (*it)->IssueCommand( request );
+    }
+
+    return true;
+}
+
+
+/*
+ *  Issues the packets queued since the last flush. NVMain is brought up
+ *  to the current tick once and the wakeup event is rescheduled once for
+ *  the whole batch. Packets the memory controller can not take yet stay
+ *  queued, in order, until a request completes.
+ */
+void NVMainMemory::FlushPackets( )
+{
+    assert( masterInstance == this );
+    assert( gem5::curTick() >= lastWakeup );
+
+    ncycle_t stepCycles = (gem5::curTick() - lastWakeup) / clock;
+
+    m_nvmainGlobalEventQueue->Cycle( stepCycles );
+    lastWakeup += clock * static_cast<gem5::Tick>(stepCycles);
+
+    size_t issued = 0;
+
+    while( !packetQueue.empty() )
+    {
+        QueuedPacket& queued = packetQueue.front();
+
+        if( !queued.instance->IssuePacket( queued.packet ) )
+            break;
+
+        packetQueue.pop_front();
+        issued++;
+    }
+
+    DPRINTF(NVMain, "NVMainMemory: Flushed %d packets, %d still queued\n", issued, packetQueue.size());
+
+    if( issued > 0 )
+        ScheduleNextWake( );
+
+    /* Ports turned away while the queue was full may send again. */
+    if( packetQueue.size() < batchQueueSize )
+    {
+        for( auto retryIter = allInstances.begin(); 
+             retryIter != allInstances.end(); retryIter++ )
+        {
+            if( (*retryIter)->retryRead || (*retryIter)->retryWrite )
             {
-                memory.retryWrite = true;
+                (*retryIter)->retryRead = false;
+                (*retryIter)->retryWrite = false;
+                (*retryIter)->port.sendRetryReq();
             }
-
-            delete request;
-            request = NULL;
         }
     }
-    return enqueued;
+
+    CheckDrainState( );
 }
 
 
@@ -810,7 +871,7 @@ void NVMainMemory::doFunctionalAccess(gem5::PacketPtr pkt)
 
 gem5::DrainState NVMainMemory::drain()
 {
-    if( !masterInstance->m_request_map.empty() )
+    if( !masterInstance->m_request_map.empty() || !masterInstance->packetQueue.empty() )
     {
         return gem5::DrainState::Draining;
     }
@@ -903,7 +964,7 @@ bool NVMainMemory::RequestComplete(NVM::NVMainRequest *req)
             ownerInstance->ScheduleResponse( );
 
             delete req;
-            delete memRequest;
+            ReleaseMemoryRequest( memRequest );
         }
         else
         {
@@ -913,13 +974,13 @@ bool NVMainMemory::RequestComplete(NVM::NVMainRequest *req)
             CheckDrainState( );
 
             delete req;
-            delete memRequest;
+            ReleaseMemoryRequest( memRequest );
         }
     }
     else
     {
         delete req;
-        delete memRequest;
+        ReleaseMemoryRequest( memRequest );
     }
 
 
@@ -927,6 +988,10 @@ bool NVMainMemory::RequestComplete(NVM::NVMainRequest *req)
     //assert(m_requests_outstanding > 0);
     m_requests_outstanding--;
 
+    /* Queued packets the memory controller turned away may fit now. */
+    if( !masterInstance->packetQueue.empty() && !masterInstance->flushEvent.scheduled() )
+        masterInstance->schedule( masterInstance->flushEvent, clockEdge(gem5::Cycles(1)) );
+
     return true;
 }
 
@@ -962,7 +1027,8 @@ void NVMainMemory::SendResponses( )
 
 void NVMainMemory::CheckDrainState( )
 {
-    if( drainManager != NULL && masterInstance->m_request_map.empty() )
+    if( drainManager != NULL && masterInstance->m_request_map.empty()
+        && masterInstance->packetQueue.empty() )
     {
         DPRINTF(NVMain, "NVMainMemory: Drain completed.\n");
         DPRINTF(NVMainMin, "NVMainMemory: Drain completed.\n");
@@ -989,6 +1055,41 @@ void NVMainMemory::ScheduleClockEvent( gem5::Tick nextWake )
 }
 
 
+/*
+ *  Moves the wakeup event earlier if NVMain now has an event sooner than
+ *  the one it was scheduled for. With nothing pending in NVMain, no
+ *  wakeup is scheduled until the next request arrives.
+ */
+void NVMainMemory::ScheduleNextWake( )
+{
+    ncycle_t nextEvent = m_nvmainGlobalEventQueue->GetNextEvent(NULL);
+
+    DPRINTF(NVMain, "NVMainMemory: Next event after issue is %d\n", nextEvent);
+
+    if( nextEvent == std::numeric_limits<ncycle_t>::max() )
+        return;
+
+    if( clockEvent.scheduled() && nextEvent >= nextEventCycle )
+        return;
+
+    ncycle_t currentCycle = m_nvmainGlobalEventQueue->GetCurrentCycle();
+
+    ncycle_t stepCycles;
+    if( nextEvent > currentCycle )
+        stepCycles = nextEvent - currentCycle;
+    else
+        stepCycles = 1;
+
+    gem5::Tick nextWake = gem5::curTick() + clock * static_cast<gem5::Tick>(stepCycles);
+
+    DPRINTF(NVMain, "NVMainMemory: Next event: %d CurrentCycle: %d\n", nextEvent, currentCycle);
+    DPRINTF(NVMain, "NVMainMemory: Rescheduled wake at %d after %d cycles\n", nextWake, stepCycles);
+
+    nextEventCycle = nextEvent;
+    ScheduleClockEvent( nextWake );
+}
+
+
 void NVMainMemory::serialize(gem5::CheckpointOut &cp) const
 {
     if (masterInstance != this)
@@ -97,13 +97,17 @@ class NVMainMemory : public gem5::memory::NVMInterface, public NVM::NVMObject
 
     void tick();
     void SendResponses( );
+    void FlushPackets( );
     gem5::EventWrapper<NVMainMemory, &NVMainMemory::tick> clockEvent;
     gem5::EventWrapper<NVMainMemory, &NVMainMemory::SendResponses> respondEvent;
+    gem5::EventWrapper<NVMainMemory, &NVMainMemory::FlushPackets> flushEvent;
 
     void CheckDrainState( );
     void ScheduleResponse( );
     void ScheduleClockEvent( gem5::Tick );
+    void ScheduleNextWake( );
     void SetRequestData(NVM::NVMainRequest *request, gem5::PacketPtr pkt);
+    bool IssuePacket( gem5::PacketPtr pkt );
 
     class NVMainStatPrinter : public gem5::CallbackQueue
     {
@@ -135,6 +139,16 @@ class NVMainMemory : public gem5::memory::NVMInterface, public NVM::NVMObject
         bool atomic;
     };
 
+    /* A timing packet waiting for the next flush, with the port it came in on. */
+    struct QueuedPacket
+    {
+        gem5::PacketPtr packet;
+        NVMainMemory *instance;
+    };
+
+    NVMainMemoryRequest *AllocateMemoryRequest( );
+    void ReleaseMemoryRequest( NVMainMemoryRequest *memRequest );
+
     gem5::DrainManager *drainManager;
 
     NVM::NVMain *m_nvmainPtr;
@@ -161,6 +175,8 @@ class NVMainMemory : public gem5::memory::NVMInterface, public NVM::NVMObject
     uint64_t RATE;
 
     bool NVMainWarmUp;
+    bool batchRequests;
+    unsigned batchQueueSize;
 
     NVMainStatPrinter statPrinter;
     NVMainStatReseter statReseter;
@@ -204,6 +220,8 @@ class NVMainMemory : public gem5::memory::NVMInterface, public NVM::NVMObject
     std::deque<gem5::PacketPtr> responseQueue;
     std::vector<gem5::PacketPtr> pendingDelete;
     std::map<NVM::NVMainRequest *, NVMainMemoryRequest *> m_request_map;
+    std::deque<QueuedPacket> packetQueue;
+    std::vector<NVMainMemoryRequest *> freeMemRequests;
 
   protected:
 
@@ -64,73 +64,82 @@ testdata = json.load(json_data)
 
 
 #
-# Run all tests with each trace
+# Run all tests with each trace. Tests naming their own trace run once
+# with it, in file order, so later tests may reuse an earlier one's output.
 #
+runs = []
 
 for trace in testdata["traces"]:
-
     for idx, test in enumerate(testdata["tests"]):
-        faillog = testdata["tests"][idx]["name"] + ".out"
-
-        # Reset log each time for correct stat comparison
-        testlog = open(options.tempfile, 'w')
-
-        command = [nvmainexec, testdata["tests"][idx]["config"], trace, testdata["tests"][idx]["cycles"]]
-        command.extend(testdata["tests"][idx]["overrides"].split(" "))
-        sys.stdout.write("Testing " + testdata["tests"][idx]["name"] + " with " + trace + " ... ")
-        sys.stdout.flush()
-
-        try:
-            subprocess.check_call(command, stdout=testlog, stderr=subprocess.STDOUT)
-        except subprocess.CalledProcessError as e:
-            expectedrc = testdata["tests"][idx]["returncode"]
-            if e.returncode != expectedrc:
-                print("[Failed RC=%u]" % e.returncode)
-                shutil.copyfile(options.tempfile, faillog)
-                continue
-
-        testlog.close()
-
-        checkcount = 0
-        checkcounter = 0
-        passedchecks = []
-        
-        for check in testdata["tests"][idx]["checks"]:
-            checkcount = checkcount + 1
-
-        with open(options.tempfile, 'r') as flog:
-            for line in flog:
-                for check in testdata["tests"][idx]["checks"]:
-                    if check in line:
-                        checkcounter = checkcounter + 1
-                        passedchecks.append(check)
-                    elif check[0] == 'i':  # Skip for general stat checks
-                        # See if the stat is there, but the value is slightly off
-                        checkstat = check.split(' ')[0]
-                        fval = re.compile("[0-9.]")
-                        checkvalue = float(''.join(c for c in check.split(' ')[1] if fval.match(c)))
-                        if checkstat in line:
-                            refvalue = float(''.join(c for c in line.split(' ')[1] if fval.match(c)))
-                            try:
-                                fuzz = max( (1.0 - (checkvalue / refvalue)) * 100.0, (1.0 - (refvalue / checkvalue)) * 100.0)
-                                if fuzz < options.max_fuzz:
-                                    checkcounter = checkcounter + 1
-                                    passedchecks.append(check)
-                                else:
-                                    print("Stat '%s' has value '%s' while reference has '%s'. Fuzz = %f" % (checkstat, checkvalue, refvalue, fuzz))
-                            except ZeroDivisionError:
-                                print("Warning: Stat '%s' has reference value (%s) or check value (%s) of zero." % (checkstat, refvalue, checkvalue))
-
-        if checkcounter == checkcount:
-            print("[Passed %d/%d]" % (checkcounter, checkcount))
-            shutil.copyfile(options.tempfile, faillog)
-        else:
-            print("[Failed %d/%d]" % (checkcounter, checkcount))
+        if not "trace" in test:
+            runs.append((idx, trace))
+
+for idx, test in enumerate(testdata["tests"]):
+    if "trace" in test:
+        runs.append((idx, test["trace"]))
+
+for idx, trace in runs:
+    faillog = testdata["tests"][idx]["name"] + ".out"
+
+    # Reset log each time for correct stat comparison
+    testlog = open(options.tempfile, 'w')
+
+    command = [nvmainexec, testdata["tests"][idx]["config"], trace, testdata["tests"][idx]["cycles"]]
+    command.extend(testdata["tests"][idx]["overrides"].split(" "))
+    sys.stdout.write("Testing " + testdata["tests"][idx]["name"] + " with " + trace + " ... ")
+    sys.stdout.flush()
+
+    try:
+        subprocess.check_call(command, stdout=testlog, stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        expectedrc = testdata["tests"][idx]["returncode"]
+        if e.returncode != expectedrc:
+            print("[Failed RC=%u]" % e.returncode)
             shutil.copyfile(options.tempfile, faillog)
+            continue
+
+    testlog.close()
 
+    checkcount = 0
+    checkcounter = 0
+    passedchecks = []
+    
+    for check in testdata["tests"][idx]["checks"]:
+        checkcount = checkcount + 1
+
+    with open(options.tempfile, 'r') as flog:
+        for line in flog:
             for check in testdata["tests"][idx]["checks"]:
-                if not check in passedchecks:
-                    print("Check %s failed." % check)
+                if check in line:
+                    checkcounter = checkcounter + 1
+                    passedchecks.append(check)
+                elif check[0] == 'i':  # Skip for general stat checks
+                    # See if the stat is there, but the value is slightly off
+                    checkstat = check.split(' ')[0]
+                    fval = re.compile("[0-9.]")
+                    checkvalue = float(''.join(c for c in check.split(' ')[1] if fval.match(c)))
+                    if checkstat in line:
+                        refvalue = float(''.join(c for c in line.split(' ')[1] if fval.match(c)))
+                        try:
+                            fuzz = max( (1.0 - (checkvalue / refvalue)) * 100.0, (1.0 - (refvalue / checkvalue)) * 100.0)
+                            if fuzz < options.max_fuzz:
+                                checkcounter = checkcounter + 1
+                                passedchecks.append(check)
+                            else:
+                                print("Stat '%s' has value '%s' while reference has '%s'. Fuzz = %f" % (checkstat, checkvalue, refvalue, fuzz))
+                        except ZeroDivisionError:
+                            print("Warning: Stat '%s' has reference value (%s) or check value (%s) of zero." % (checkstat, refvalue, checkvalue))
+
+    if checkcounter == checkcount:
+        print("[Passed %d/%d]" % (checkcounter, checkcount))
+        shutil.copyfile(options.tempfile, faillog)
+    else:
+        print("[Failed %d/%d]" % (checkcounter, checkcount))
+        shutil.copyfile(options.tempfile, faillog)
+
+        for check in testdata["tests"][idx]["checks"]:
+            if not check in passedchecks:
+                print("Check %s failed." % check)
 
 
 
@@ -37,6 +37,7 @@
 #include "Utils/Visualizer/Visualizer.h"
 #include "Utils/PostTrace/PostTrace.h"
 #include "Utils/CoinMigrator/CoinMigrator.h"
+#include "Utils/WearLeveler/WearLeveler.h"
 
 
 using namespace NVM;
@@ -49,6 +50,7 @@ NVMObject *HookFactory::CreateHook( std::string hookName )
     if( hookName == "Visualizer" ) hook = new Visualizer( );
     else if( hookName == "PostTrace" ) hook = new PostTrace( );
     else if( hookName == "CoinMigrator" ) hook = new CoinMigrator( );
+    else if( hookName == "WearLeveler" ) hook = new WearLeveler( );
     //else if( hookName == "MyHook" ) hook = new MyHook( );
 
     if( hook != NULL )
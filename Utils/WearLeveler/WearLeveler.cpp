@@ -0,0 +1,371 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/WearLeveler/WearLeveler.h"
+#include "Decoders/StartGap/StartGap.h"
+#include "src/MemoryController.h"
+#include "src/SubArray.h"
+#include "src/SimInterface.h"
+#include "src/EventQueue.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace NVM;
+
+/* Retries run after the controllers have moved this cycle's requests on. */
+const int gapRetryPriority = commandQueuePriority + 1;
+
+WearLeveler::WearLeveler( )
+{
+    /*
+     *  Writes are counted when they complete, before the memory controller
+     *  frees its own requests. Atomic writes are counted after they are done.
+     */
+    SetHookType( NVMHOOK_BOTHISSUE );
+
+    config = NULL;
+    numCols = 0;
+
+    demandWrites = 0;
+    gapMoves = 0;
+    gapWriteOverhead = 0.0;
+    cimColocationViolations = 0;
+    queueWaits = 0;
+    movesInFlight = 0;
+
+    /* Lets the event queue call back a hook, which is nobody's child. */
+    retryHook = new NVMObject_hook( this );
+}
+
+
+WearLeveler::~WearLeveler( )
+{
+    delete retryHook;
+}
+
+
+void WearLeveler::Init( Config *conf )
+{
+    config = conf;
+
+    /* Gap movements copy entire rows. */
+    numCols = config->GetValue( "COLS" );
+
+    AddStat(demandWrites);
+    AddStat(gapMoves);
+    AddStat(gapWriteOverhead);
+    AddStat(cimColocationViolations);
+    AddStat(queueWaits);
+}
+
+
+StartGap *WearLeveler::GetStartGap( )
+{
+    if( !NVMTypeMatches(MemoryController) )
+        return NULL;
+
+    StartGap *decoder = dynamic_cast<StartGap *>(parent->GetTrampoline( )->GetDecoder( ));
+
+    if( decoder == NULL )
+    {
+        std::cerr << "NVMain Error: WearLeveler requires the StartGap or "
+            << "RandomStartGap decoder." << std::endl;
+        exit(1);
+    }
+
+    return decoder;
+}
+
+
+bool WearLeveler::IssueAtomic( NVMainRequest *request )
+{
+    if( GetCurrentHookType( ) == NVMHOOK_POSTISSUE )
+    {
+        StartGap *decoder = GetStartGap( );
+
+        if( decoder != NULL )
+            CheckRequest( decoder, request, true );
+    }
+
+    return true;
+}
+
+
+bool WearLeveler::IssueCommand( NVMainRequest * /*request*/ )
+{
+    return true;
+}
+
+
+/*
+ *  A gap move is not seen by the memory's own request count, so the copy
+ *  must finish before the system can be checkpointed.
+ */
+bool WearLeveler::Idle( )
+{
+    return movesInFlight == 0 && pendingRequests.empty( );
+}
+
+
+bool WearLeveler::RequestComplete( NVMainRequest *request )
+{
+    if( GetCurrentHookType( ) != NVMHOOK_PREISSUE )
+        return true;
+
+    StartGap *decoder = GetStartGap( );
+
+    if( decoder == NULL )
+        return true;
+
+    NVMObject *savedParent = parent->GetTrampoline( );
+
+    if( request->owner == savedParent && request->tag == WL_READ_TAG )
+    {
+        /* The source row is buffered, so the gap can move now. */
+        decoder->MoveGap( request->address );
+        MoveFunctionalRow( decoder, request );
+
+        /* Write it into the old gap. The controller deletes the read. */
+        NVMainRequest *writeRequest = new NVMainRequest( );
+        *writeRequest = *request;
+
+        writeRequest->type = WRITE;
+        writeRequest->tag = WL_WRITE_TAG;
+
+        IssueGapRequest( writeRequest );
+    }
+    else if( request->owner == savedParent && request->tag == WL_WRITE_TAG )
+    {
+        decoder->FinishGapMove( request->address );
+        CountGapMove( );
+        movesInFlight--;
+    }
+    else if( request->owner != savedParent )
+    {
+        CheckRequest( decoder, request, false );
+    }
+
+    IssuePendingRequests( );
+
+    return true;
+}
+
+
+void WearLeveler::CheckRequest( StartGap *decoder, NVMainRequest *request, bool atomic )
+{
+    if( request->isCIM )
+    {
+        Params *p = parent->GetTrampoline( )->GetParams( );
+
+        if( !decoder->IsColocated( request->address, p->GetCIMOperandRows( request ) ) )
+            cimColocationViolations++;
+    }
+
+    if( request->type == WRITE || request->type == WRITE_PRECHARGE )
+    {
+        demandWrites++;
+        gapWriteOverhead = static_cast<double>(gapMoves) / static_cast<double>(demandWrites);
+
+        if( decoder->RecordWrite( request->address ) )
+            StartGapMove( decoder, request, atomic );
+    }
+}
+
+
+void WearLeveler::StartGapMove( StartGap *decoder, NVMainRequest *request, bool atomic )
+{
+    /* 
+     *  Note: requests are issued to the memory controller directly, so this
+     *  hook does not see them until they complete.
+     */
+    NVMObject *savedParent = parent->GetTrampoline( );
+    NVMAddress source;
+
+    if( !decoder->StartGapMove( request->address, source ) )
+        return;
+
+    if( atomic )
+    {
+        /* Atomic mode has no timing, so only the write to the gap is modeled. */
+        NVMainRequest moveRequest;
+
+        moveRequest.address = source;
+        moveRequest.owner = savedParent;
+        moveRequest.burstCount = numCols;
+        SetGapData( &moveRequest );
+
+        decoder->MoveGap( source );
+        MoveFunctionalRow( decoder, &moveRequest );
+
+        moveRequest.type = WRITE;
+        moveRequest.tag = WL_WRITE_TAG;
+        savedParent->IssueAtomic( &moveRequest );
+
+        decoder->FinishGapMove( source );
+        CountGapMove( );
+    }
+    else
+    {
+        NVMainRequest *readRequest = new NVMainRequest( );
+
+        readRequest->address = source;
+        readRequest->type = READ;
+        readRequest->tag = WL_READ_TAG;
+        readRequest->burstCount = numCols;
+        readRequest->owner = savedParent;
+        SetGapData( readRequest );
+
+        movesInFlight++;
+        IssueGapRequest( readRequest );
+    }
+}
+
+
+/*
+ *  The copy writes the row's data over the stale contents of the gap, which
+ *  are taken as zero as for any other write without old data.
+ */
+void WearLeveler::SetGapData( NVMainRequest *request )
+{
+    Params *p = parent->GetTrampoline( )->GetParams( );
+    uint64_t wordSize = p->BusWidth * p->tBURST * p->RATE / 8;
+
+    request->oldData.SetSize( wordSize );
+    memset( request->oldData.rawData, 0, wordSize );
+
+    if( config->GetSimInterface( ) == NULL
+        || !config->GetSimInterface( )->GetDataAtAddress( 
+                request->address.GetPhysicalAddress( ), &request->data ) )
+    {
+        request->data.SetSize( wordSize );
+        memset( request->data.rawData, 0, wordSize );
+    }
+}
+
+
+/*
+ *  request is still translated to the row it was read from, while the
+ *  decoder already maps its address to the old gap.
+ */
+void WearLeveler::MoveFunctionalRow( StartGap *decoder, NVMainRequest *request )
+{
+    NVMObject *savedParent = parent->GetTrampoline( );
+
+    if( !savedParent->GetParams( )->FunctionalCIM )
+        return;
+
+    uint64_t sourceRow, destRow, col, bank, rank, channel, subarray;
+
+    request->address.GetTranslatedAddress( &sourceRow, NULL, NULL, NULL, NULL, NULL );
+    decoder->Translate( request->address.GetPhysicalAddress( ), &destRow, &col,
+                        &bank, &rank, &channel, &subarray );
+
+    NVMObject *curObject = NULL;
+    FindModuleChildType( request, SubArray, curObject, savedParent );
+
+    SubArray *subArray = dynamic_cast<SubArray *>( curObject );
+
+    if( subArray != NULL )
+        subArray->MoveFunctionalRow( sourceRow, destRow );
+}
+
+
+void WearLeveler::CountGapMove( )
+{
+    gapMoves++;
+    gapWriteOverhead = static_cast<double>(gapMoves) / static_cast<double>(demandWrites);
+}
+
+
+void WearLeveler::IssueGapRequest( NVMainRequest *request )
+{
+    if( !request->owner->IssueCommand( request ) )
+    {
+        pendingRequests.push_back( request );
+        queueWaits++;
+
+        ScheduleRetry( request->owner );
+    }
+}
+
+
+/*
+ *  A queue slot freed by a completion is usually refilled by the next demand
+ *  request before any hook sees it, so rejected moves are retried every
+ *  cycle until the controller takes them.
+ */
+void WearLeveler::ScheduleRetry( NVMObject *controller )
+{
+    EventQueue *queue = controller->GetEventQueue( );
+    ncycle_t when = queue->GetCurrentCycle( ) + 1;
+
+    if( !queue->FindCallback( this, (CallbackPtr)&WearLeveler::RetryCallback,
+                              when, NULL, gapRetryPriority ) )
+    {
+        queue->InsertCallback( retryHook, (CallbackPtr)&WearLeveler::RetryCallback,
+                               when, NULL, gapRetryPriority );
+    }
+}
+
+
+void WearLeveler::RetryCallback( void * /*data*/ )
+{
+    IssuePendingRequests( );
+}
+
+
+void WearLeveler::IssuePendingRequests( )
+{
+    std::list<NVMainRequest *>::iterator it = pendingRequests.begin( );
+
+    while( it != pendingRequests.end( ) )
+    {
+        if( (*it)->owner->IssueCommand( *it ) )
+        {
+            it = pendingRequests.erase( it );
+        }
+        else
+        {
+            ScheduleRetry( (*it)->owner );
+            ++it;
+        }
+    }
+}
+
+
+void WearLeveler::Cycle( ncycle_t /*steps*/ )
+{
+
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_WEARLEVELER_H__
+#define __NVMAIN_UTILS_WEARLEVELER_H__
+
+#include "src/NVMObject.h"
+#include "src/Params.h"
+#include "include/NVMainRequest.h"
+
+#include <list>
+
+namespace NVM {
+
+#define WL_READ_TAG GetTagGenerator( )->CreateTag("WLREAD")
+#define WL_WRITE_TAG GetTagGenerator( )->CreateTag("WLWRITE")
+
+class StartGap;
+
+/*
+ *  Drives a StartGap decoder from each memory controller. Completed writes
+ *  are counted per region; when a region is due, the row next to its gap is
+ *  read and written back into the gap with ordinary requests so the copy
+ *  costs the same time, energy and wear as any other access.
+ *
+ *  gapWriteOverhead is the number of row copies per demand write. Lifetime
+ *  is compared through the endurance model's worstCaseEndurance and the
+ *  throughput cost through the controller's latency statistics.
+ */
+class WearLeveler : public NVMObject
+{
+  public:
+    WearLeveler( );
+    ~WearLeveler( );
+
+    void Init( Config *config );
+
+    bool IssueAtomic( NVMainRequest *request );
+    bool IssueCommand( NVMainRequest *request );
+    bool RequestComplete( NVMainRequest *request );
+    bool Idle( );
+
+    void Cycle( ncycle_t steps );
+
+  private:
+    Config *config;
+    ncounter_t numCols;
+
+    /* Gap movement requests waiting for room in their controller's queue. */
+    std::list<NVMainRequest *> pendingRequests;
+    ncounter_t movesInFlight;
+    NVMObject_hook *retryHook;
+
+    ncounter_t demandWrites;
+    ncounter_t gapMoves;
+    double gapWriteOverhead;
+    ncounter_t cimColocationViolations;
+    ncounter_t queueWaits;
+
+    StartGap *GetStartGap( );
+    void CheckRequest( StartGap *decoder, NVMainRequest *request, bool atomic );
+    void StartGapMove( StartGap *decoder, NVMainRequest *request, bool atomic );
+    void SetGapData( NVMainRequest *request );
+    void MoveFunctionalRow( StartGap *decoder, NVMainRequest *request );
+    void CountGapMove( );
+    void IssueGapRequest( NVMainRequest *request );
+    void IssuePendingRequests( );
+    void ScheduleRetry( NVMObject *controller );
+    void RetryCallback( void *data );
+};
+
+};
+
+#endif
@@ -33,6 +33,12 @@
 
 #include "include/NVMHelpers.h"
 
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+
 namespace NVM {
 
 int mlog2( int num )
@@ -61,4 +67,57 @@ std::string GetFilePath( std::string file )
     return file.substr( 0, last_sep+1 );
 } 
 
+/*
+ *  Seed of a module's own random stream: the configured seed mixed with
+ *  the module's name (FNV-1a). Modules draw from their own stream, so
+ *  results do not depend on which thread or simulation drew first.
+ */
+unsigned int MakeSeed( uint64_t seed, std::string name )
+{
+    uint64_t hash = 14695981039346656037ULL ^ seed;
+
+    for( size_t idx = 0; idx < name.size( ); idx++ )
+    {
+        hash ^= static_cast<unsigned char>( name[idx] );
+        hash *= 1099511628211ULL;
+    }
+
+    return static_cast<unsigned int>( hash ^ ( hash >> 32 ) );
+}
+
+/*
+ *  Opens a file that is mapped shared to back a store. The file is locked
+ *  for as long as it is open, so two stores given the same name (e.g., in
+ *  separate simulations) fail instead of truncating each other's mapping.
+ *  A file left by an earlier run is not locked and is emptied.
+ */
+int OpenBackingFile( std::string file, std::string contents )
+{
+    int fd = open( file.c_str( ), O_RDWR | O_CREAT, 0600 );
+
+    if( fd < 0 )
+    {
+        std::cerr << "NVMain Error: Could not open " << contents
+                  << " backing file `" << file << "'!" << std::endl;
+        exit(1);
+    }
+
+    if( flock( fd, LOCK_EX | LOCK_NB ) != 0 )
+    {
+        std::cerr << "NVMain Error: The " << contents << " backing file `" 
+                  << file << "' is in use by another simulation. Give each "
+                  << "simulation its own file." << std::endl;
+        exit(1);
+    }
+
+    if( ftruncate( fd, 0 ) != 0 )
+    {
+        std::cerr << "NVMain Error: Could not empty " << contents
+                  << " backing file `" << file << "'!" << std::endl;
+        exit(1);
+    }
+
+    return fd;
+}
+
 };
@@ -43,6 +43,8 @@ namespace NVM {
 
 int mlog2( int num );
 std::string GetFilePath( std::string file );
+unsigned int MakeSeed( uint64_t seed, std::string name );
+int OpenBackingFile( std::string file, std::string contents );
 
 template <typename T1, typename T2>
 std::string PyDictHistogram( std::map<T1, T2> iiMap )
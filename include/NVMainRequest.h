@@ -72,6 +72,13 @@ enum OpType
     CACHED_WRITE    /* Check if write is cached anywhere in hierarchy. */
 };
 
+/* 
+ *  The compute-in-memory operations are contiguous at the start of OpType.
+ *  Per-operation tables (e.g., CIM timing and energy in Params) are indexed
+ *  by ( op - NOT_IN_ARRAY ).
+ */
+const int CIM_OP_COUNT = XOR_IN_LATCH - NOT_IN_ARRAY + 1;
+
 enum MemRequestStatus 
 { 
     MEM_REQUEST_INCOMPLETE, /* Incomplete request */
@@ -147,6 +154,7 @@ class NVMainRequest
         isNAND_IN_LATCH = false;
         isNOR_IN_LATCH = false;
         isXOR_IN_LATCH = false;
+        cimOperandRows = 0;
         programCounter = 0; 
         burstCount = 1;
         writeProgress = 0;
@@ -166,6 +174,7 @@ class NVMainRequest
     bool isNAND_IN_LATCH;
     bool isNOR_IN_LATCH;
     bool isXOR_IN_LATCH;
+    ncounter_t cimOperandRows;     //< Number of rows activated as CIM operands (0 = config default)
     NVMAddress address;            //< Address of request
     OpType type;                   //< Operation type of request (read, write, etc)
     BulkCommand bulkCmd;           //< Bulk Commands (i.e., Read+Precharge, Write+Precharge, etc)
@@ -191,6 +200,9 @@ class NVMainRequest
     ncycle_t writeProgress;        //< Number of cycles remaining for write request
     ncycle_t cancellations;        //< Number of times this request was cancelled
 
+    OpType GetCIMOp( ) const;
+    void SetCIMOp( OpType op );
+
     const NVMainRequest& operator=( const NVMainRequest& );
     bool operator<( NVMainRequest m ) const;
 
@@ -232,6 +244,7 @@ const NVMainRequest& NVMainRequest::operator=( const NVMainRequest& m )
     isNAND_IN_LATCH = m.isNAND_IN_LATCH;
     isNOR_IN_LATCH = m.isNOR_IN_LATCH;
     isXOR_IN_LATCH = m.isXOR_IN_LATCH;
+    cimOperandRows = m.cimOperandRows;
     pfTrigger = m.pfTrigger;
     programCounter = m.programCounter;
     owner = m.owner;
@@ -244,6 +257,37 @@ const NVMainRequest& NVMainRequest::operator=( const NVMainRequest& m )
     return *this; 
 }
 
+/* Returns the CIM operation this request performs, or NOP if it is not CIM. */
+inline
+OpType NVMainRequest::GetCIMOp( ) const
+{
+    if( !isCIM )                return NOP;
+    else if( isNOT_IN_ARRAY )   return NOT_IN_ARRAY;
+    else if( isAND_IN_ARRAY )   return AND_IN_ARRAY;
+    else if( isAND_IN_LATCH )   return AND_IN_LATCH;
+    else if( isOR_IN_LATCH )    return OR_IN_LATCH;
+    else if( isNAND_IN_LATCH )  return NAND_IN_LATCH;
+    else if( isNOR_IN_LATCH )   return NOR_IN_LATCH;
+    else if( isXOR_IN_LATCH )   return XOR_IN_LATCH;
+
+    return NOP;
+}
+
+/* Turns this request into the CIM READ that performs op. */
+inline
+void NVMainRequest::SetCIMOp( OpType op )
+{
+    type = READ;
+    isCIM = true;
+    isNOT_IN_ARRAY = ( op == NOT_IN_ARRAY );
+    isAND_IN_ARRAY = ( op == AND_IN_ARRAY );
+    isAND_IN_LATCH = ( op == AND_IN_LATCH );
+    isOR_IN_LATCH = ( op == OR_IN_LATCH );
+    isNAND_IN_LATCH = ( op == NAND_IN_LATCH );
+    isNOR_IN_LATCH = ( op == NOR_IN_LATCH );
+    isXOR_IN_LATCH = ( op == XOR_IN_LATCH );
+}
+
 inline
 bool NVMainRequest::operator<( NVMainRequest m ) const
 {
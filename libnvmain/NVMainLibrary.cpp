@@ -0,0 +1,455 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "libnvmain/NVMainLibrary.h"
+#include "src/Config.h"
+#include "src/EventQueue.h"
+#include "src/TagGenerator.h"
+#include "NVM/nvmain.h"
+#include "SimInterface/NullInterface/NullInterface.h"
+#include "Utils/HookFactory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+using namespace NVM;
+
+/* System construction touches process-wide state, so it is never concurrent. */
+std::mutex NVMainLibrary::setupMutex;
+
+NVMainLibrary::NVMainLibrary( )
+{
+    config = NULL;
+    nvmain = NULL;
+    simInterface = NULL;
+    mainEventQueue = NULL;
+    globalEventQueue = NULL;
+    stats = NULL;
+    tagGenerator = NULL;
+
+    cpuPerMemoryCycle = 1.0;
+    inFlight = 0;
+
+    ring.resize( 1024 );
+    ringHead = 0;
+    ringCount = 0;
+}
+
+NVMainLibrary::~NVMainLibrary( )
+{
+    std::deque<LibraryRequest *>::iterator it;
+
+    for( it = pending.begin( ); it != pending.end( ); it++ )
+        delete (*it);
+
+    /* NVMain owns the config from SetConfig on. */
+    if( nvmain != NULL )
+        delete nvmain;
+    else
+        delete config;
+
+    delete simInterface;
+    delete mainEventQueue;
+    delete globalEventQueue;
+    delete stats;
+    delete tagGenerator;
+}
+
+void NVMainLibrary::SetConfig( Config *conf )
+{
+    std::lock_guard<std::mutex> setupLock( setupMutex );
+
+    config = conf;
+    stats = new Stats( );
+    simInterface = new NullInterface( );
+    nvmain = new NVMain( );
+    mainEventQueue = new EventQueue( );
+    globalEventQueue = new GlobalEventQueue( );
+    tagGenerator = new TagGenerator( 1000 );
+
+    config->SetSimInterface( simInterface );
+    SetEventQueue( mainEventQueue );
+    SetGlobalEventQueue( globalEventQueue );
+    SetStats( stats );
+    SetTagGenerator( tagGenerator );
+
+    std::vector<std::string>& hookList = config->GetHooks( );
+
+    for( size_t i = 0; i < hookList.size( ); i++ )
+    {
+        NVMObject *hook = HookFactory::CreateHook( hookList[i] );
+        
+        if( hook != NULL )
+        {
+            AddHook( hook );
+            hook->SetParent( this );
+            hook->Init( config );
+        }
+        else
+        {
+            std::cout << "Warning: Could not create a hook named `" 
+                << hookList[i] << "'." << std::endl;
+        }
+    }
+
+    AddChild( nvmain );
+    nvmain->SetParent( this );
+
+    globalEventQueue->SetFrequency( config->GetEnergy( "CPUFreq" ) * 1000000.0 );
+    globalEventQueue->AddSystem( nvmain, config );
+
+    simInterface->SetConfig( config, true );
+    nvmain->SetConfig( config, "defaultMemory", true );
+
+    cpuPerMemoryCycle = globalEventQueue->GetFrequency( ) 
+                      / mainEventQueue->GetFrequency( );
+
+    config->CheckKeys( );
+}
+
+size_t NVMainLibrary::Submit( const nvmain_request_t *requests, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+    {
+        const nvmain_request_t& in = requests[i];
+
+        if( in.op > NVMAIN_OP_XOR_IN_LATCH )
+            return i;
+
+        LibraryRequest *request = new LibraryRequest( );
+
+        request->id = in.id;
+        request->cycle = in.cycle;
+        request->result = in.result;
+        request->resultSize = in.data_size;
+
+        request->address.SetPhysicalAddress( in.address );
+        request->bulkCmd = CMD_NOP;
+        request->threadId = in.thread_id;
+        request->status = MEM_REQUEST_INCOMPLETE;
+        request->owner = this;
+
+        if( in.op == NVMAIN_OP_READ )
+        {
+            request->type = READ;
+        }
+        else if( in.op == NVMAIN_OP_WRITE )
+        {
+            request->type = WRITE;
+        }
+        else
+        {
+            /* The nvmain_op_t CIM ops are in OpType order. */
+            request->SetCIMOp( static_cast<OpType>( NOT_IN_ARRAY + 
+                                   ( in.op - NVMAIN_OP_NOT_IN_ARRAY ) ) );
+            request->cimOperandRows = in.operand_rows;
+        }
+
+        if( in.data != NULL && in.data_size != 0 )
+        {
+            request->data.SetSize( in.data_size );
+            memcpy( request->data.rawData, in.data, in.data_size );
+        }
+
+        if( in.old_data != NULL && in.data_size != 0 )
+        {
+            request->oldData.SetSize( in.data_size );
+            memcpy( request->oldData.rawData, in.old_data, in.data_size );
+        }
+
+        pending.push_back( request );
+    }
+
+    return count;
+}
+
+/* Issues the requests that are due; true if the oldest one had to wait. */
+bool NVMainLibrary::IssuePending( )
+{
+    uint64_t now = globalEventQueue->GetCurrentCycle( );
+
+    while( !pending.empty( ) )
+    {
+        LibraryRequest *request = pending.front( );
+
+        if( request->cycle > now )
+            return false;
+
+        if( !GetChild( )->IsIssuable( request ) )
+            return true;
+
+        pending.pop_front( );
+
+        request->issue = now;
+        inFlight++;
+
+        GetChild( )->IssueCommand( request );
+    }
+
+    return false;
+}
+
+uint64_t NVMainLibrary::Advance( uint64_t cycle )
+{
+    for( ;; )
+    {
+        bool stalled = IssuePending( );
+        uint64_t now = globalEventQueue->GetCurrentCycle( );
+
+        if( now >= cycle )
+            break;
+
+        /* Run to the next arrival, or retry every cycle while stalled. */
+        uint64_t next = cycle;
+
+        if( stalled )
+            next = now + 1;
+        else if( !pending.empty( ) && pending.front( )->cycle < next )
+            next = pending.front( )->cycle;
+
+        globalEventQueue->Cycle( next - now );
+    }
+
+    return globalEventQueue->GetCurrentCycle( );
+}
+
+uint64_t NVMainLibrary::Finish( )
+{
+    while( !pending.empty( ) || inFlight > 0 )
+    {
+        uint64_t now = globalEventQueue->GetCurrentCycle( );
+        uint64_t next = globalEventQueue->GetNextEvent( );
+
+        if( !pending.empty( ) )
+            next = std::min( next, pending.front( )->cycle );
+
+        if( next == std::numeric_limits<uint64_t>::max( ) )
+            break;
+
+        Advance( std::max( next, now + 1 ) );
+    }
+
+    return globalEventQueue->GetCurrentCycle( );
+}
+
+void NVMainLibrary::PushCompletion( const nvmain_completion_t& completion )
+{
+    if( ringCount == ring.size( ) )
+    {
+        std::vector<nvmain_completion_t> grown( ring.size( ) * 2 );
+
+        for( size_t i = 0; i < ringCount; i++ )
+            grown[i] = ring[(ringHead + i) % ring.size( )];
+
+        ring.swap( grown );
+        ringHead = 0;
+    }
+
+    ring[(ringHead + ringCount) % ring.size( )] = completion;
+    ringCount++;
+}
+
+size_t NVMainLibrary::Poll( nvmain_completion_t *completions, size_t max )
+{
+    size_t count = std::min( max, ringCount );
+    size_t first = std::min( count, ring.size( ) - ringHead );
+
+    /* At most two copies: up to the end of the ring, then from its start. */
+    memcpy( completions, &ring[ringHead], first * sizeof(nvmain_completion_t) );
+    memcpy( completions + first, &ring[0], (count - first) * sizeof(nvmain_completion_t) );
+
+    ringHead = (ringHead + count) % ring.size( );
+    ringCount -= count;
+
+    return count;
+}
+
+uint64_t NVMainLibrary::FrontEndCycle( ncycle_t memoryCycle )
+{
+    return static_cast<uint64_t>( static_cast<double>( memoryCycle ) * cpuPerMemoryCycle );
+}
+
+uint64_t NVMainLibrary::GetCurrentCycle( )
+{
+    return globalEventQueue->GetCurrentCycle( );
+}
+
+size_t NVMainLibrary::GetOutstanding( )
+{
+    return pending.size( ) + inFlight;
+}
+
+void NVMainLibrary::PrintStats( std::ostream& stream )
+{
+    GetChild( )->CalculateStats( );
+    stats->PrintAll( stream );
+}
+
+bool NVMainLibrary::DumpTrace( std::string filename )
+{
+    return nvmain->DumpTrace( filename );
+}
+
+bool NVMainLibrary::RequestComplete( NVMainRequest *req )
+{
+    /* This is the top-level module, so there are no more parents to fallback. */
+    assert( req->owner == this );
+
+    LibraryRequest *request = static_cast<LibraryRequest *>( req );
+    nvmain_completion_t completion;
+
+    completion.id = request->id;
+    completion.cycle = request->cycle;
+    completion.issue_cycle = request->issue;
+    completion.completion_cycle = FrontEndCycle( GetEventQueue( )->GetCurrentCycle( ) );
+
+    if( request->result != NULL && request->data.rawData != NULL )
+    {
+        memcpy( request->result, request->data.rawData, 
+                std::min<uint64_t>( request->resultSize, request->data.GetSize( ) ) );
+    }
+
+    PushCompletion( completion );
+
+    inFlight--;
+
+    delete request;
+
+    return true;
+}
+
+void NVMainLibrary::Cycle( ncycle_t /*steps*/ )
+{
+
+}
+
+
+struct nvmain_sim
+{
+    NVMainLibrary library;
+};
+
+extern "C" {
+
+int nvmain_api_version( void )
+{
+    return NVMAIN_API_VERSION;
+}
+
+nvmain_sim_t *nvmain_create( const char *config_file, 
+                             const char *const *overrides, size_t override_count )
+{
+    Config *config = new Config( );
+
+    config->Read( config_file );
+
+    for( size_t i = 0; i < override_count; i++ )
+    {
+        std::string clPair = overrides[i];
+        std::string clParam = clPair.substr( 0, clPair.find_first_of( "=" ) );
+        std::string clValue = clPair.substr( clPair.find_first_of( "=" ) + 1, std::string::npos );
+
+        config->SetValue( clParam, clValue );
+    }
+
+    nvmain_sim_t *sim = new nvmain_sim_t;
+    sim->library.SetConfig( config );
+
+    return sim;
+}
+
+void nvmain_destroy( nvmain_sim_t *sim )
+{
+    delete sim;
+}
+
+size_t nvmain_submit( nvmain_sim_t *sim, const nvmain_request_t *requests, 
+                      size_t count )
+{
+    return sim->library.Submit( requests, count );
+}
+
+uint64_t nvmain_advance( nvmain_sim_t *sim, uint64_t cycle )
+{
+    return sim->library.Advance( cycle );
+}
+
+uint64_t nvmain_drain( nvmain_sim_t *sim )
+{
+    return sim->library.Finish( );
+}
+
+size_t nvmain_poll( nvmain_sim_t *sim, nvmain_completion_t *completions, 
+                    size_t max )
+{
+    return sim->library.Poll( completions, max );
+}
+
+uint64_t nvmain_current_cycle( nvmain_sim_t *sim )
+{
+    return sim->library.GetCurrentCycle( );
+}
+
+size_t nvmain_outstanding( nvmain_sim_t *sim )
+{
+    return sim->library.GetOutstanding( );
+}
+
+int nvmain_print_stats( nvmain_sim_t *sim, const char *path )
+{
+    if( path == NULL )
+    {
+        sim->library.PrintStats( std::cout );
+        return 0;
+    }
+
+    std::ofstream statStream( path, std::ofstream::out | std::ofstream::app );
+
+    if( !statStream.is_open( ) )
+        return -1;
+
+    sim->library.PrintStats( statStream );
+
+    return 0;
+}
+
+int nvmain_dump_trace( nvmain_sim_t *sim, const char *path )
+{
+    return sim->library.DumpTrace( path ) ? 0 : -1;
+}
+
+}
@@ -0,0 +1,123 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __LIBNVMAIN_NVMAINLIBRARY_H__
+#define __LIBNVMAIN_NVMAINLIBRARY_H__
+
+#include "src/NVMObject.h"
+#include "include/NVMainRequest.h"
+#include "libnvmain/nvmain_c.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+class Config;
+class NVMain;
+class EventQueue;
+class GlobalEventQueue;
+class SimInterface;
+class TagGenerator;
+
+/* A request from the C interface, which keeps what its completion needs. */
+class LibraryRequest : public NVMainRequest
+{
+  public:
+    LibraryRequest( ) : id(0), cycle(0), issue(0), result(NULL), resultSize(0) { }
+
+    uint64_t id;
+    uint64_t cycle;
+    uint64_t issue;
+    uint8_t *result;
+    uint32_t resultSize;
+};
+
+/*
+ *  The front end behind nvmain_c.h; it takes the place of TraceMain at the
+ *  top of the hierarchy. Submitted requests wait in arrival order and are
+ *  issued as the simulation advances; completions go into a ring that
+ *  grows when it is full, so none are dropped.
+ */
+class NVMainLibrary : public NVMObject
+{
+  public:
+    NVMainLibrary( );
+    ~NVMainLibrary( );
+
+    void SetConfig( Config *conf );
+
+    size_t Submit( const nvmain_request_t *requests, size_t count );
+    uint64_t Advance( uint64_t cycle );
+    uint64_t Finish( );
+    size_t Poll( nvmain_completion_t *completions, size_t max );
+
+    uint64_t GetCurrentCycle( );
+    size_t GetOutstanding( );
+    void PrintStats( std::ostream& stream );
+    bool DumpTrace( std::string filename );
+
+    bool RequestComplete( NVMainRequest *request );
+    void Cycle( ncycle_t steps );
+
+  private:
+    Config *config;
+    NVMain *nvmain;
+    SimInterface *simInterface;
+    EventQueue *mainEventQueue;
+    GlobalEventQueue *globalEventQueue;
+    Stats *stats;
+    TagGenerator *tagGenerator;
+
+    /* Front-end cycles per memory cycle. */
+    double cpuPerMemoryCycle;
+
+    std::deque<LibraryRequest *> pending;
+    size_t inFlight;
+
+    std::vector<nvmain_completion_t> ring;
+    size_t ringHead;
+    size_t ringCount;
+
+    bool IssuePending( );
+    void PushCompletion( const nvmain_completion_t& completion );
+    uint64_t FrontEndCycle( ncycle_t memoryCycle );
+
+    static std::mutex setupMutex;
+};
+
+};
+
+#endif
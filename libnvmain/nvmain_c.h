@@ -0,0 +1,143 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __LIBNVMAIN_NVMAIN_C_H__
+#define __LIBNVMAIN_NVMAIN_C_H__
+
+/*
+ *  C interface of libnvmain, for driving NVMain from another simulator's
+ *  CPU model. Requests are handed over in batches and completions are read
+ *  back from a ring in batches, so the cost of crossing the interface is
+ *  paid per batch rather than per request.
+ *
+ *  Cycles are front-end (CPUFreq) cycles, as in trace files. A simulation
+ *  is not thread-safe, but separate simulations may run on separate
+ *  threads: each has its own trace ring, and random draws come from
+ *  per-module streams seeded by RandomSeed. Configuration errors end the
+ *  process, as in the trace simulator.
+ *
+ *  The structures below only grow at the end; check nvmain_api_version( )
+ *  against NVMAIN_API_VERSION when loading the library dynamically.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NVMAIN_API_VERSION 2
+
+typedef struct nvmain_sim nvmain_sim_t;
+
+typedef enum nvmain_op
+{
+    NVMAIN_OP_READ = 0,
+    NVMAIN_OP_WRITE,
+    /* Compute-in-memory operations; the result is returned like a read. */
+    NVMAIN_OP_NOT_IN_ARRAY,
+    NVMAIN_OP_AND_IN_ARRAY,
+    NVMAIN_OP_AND_IN_LATCH,
+    NVMAIN_OP_OR_IN_LATCH,
+    NVMAIN_OP_NAND_IN_LATCH,
+    NVMAIN_OP_NOR_IN_LATCH,
+    NVMAIN_OP_XOR_IN_LATCH
+} nvmain_op_t;
+
+typedef struct nvmain_request
+{
+    uint64_t id;            /* Returned in the completion. */
+    uint64_t address;       /* Physical address. */
+    uint64_t cycle;         /* Arrival cycle; requests are issued in order. */
+    uint32_t op;            /* nvmain_op_t */
+    uint32_t operand_rows;  /* CIM operand rows, 0 for the configured default. */
+    uint32_t thread_id;
+    uint32_t data_size;     /* Bytes in data, old_data and result. */
+    const uint8_t *data;    /* Written data, or NULL. */
+    const uint8_t *old_data;/* Data being overwritten, or NULL. */
+    uint8_t *result;        /* Filled with the read/CIM data on completion, or NULL. */
+} nvmain_request_t;
+
+typedef struct nvmain_completion
+{
+    uint64_t id;
+    uint64_t cycle;             /* Arrival cycle of the request. */
+    uint64_t issue_cycle;       /* Cycle the memory controller accepted it. */
+    uint64_t completion_cycle;
+} nvmain_completion_t;
+
+int nvmain_api_version( void );
+
+/* overrides are "Key=Value" strings, as on the trace simulator command line. */
+nvmain_sim_t *nvmain_create( const char *config_file, 
+                             const char *const *overrides, size_t override_count );
+void nvmain_destroy( nvmain_sim_t *sim );
+
+/*
+ *  Queues requests to be issued once their cycle is reached. Returns the
+ *  number queued, which is less than count only if a request has an
+ *  unknown op; requests from that one on are not queued.
+ */
+size_t nvmain_submit( nvmain_sim_t *sim, const nvmain_request_t *requests, 
+                      size_t count );
+
+/* Simulates until cycle (if in the future) and returns the current cycle. */
+uint64_t nvmain_advance( nvmain_sim_t *sim, uint64_t cycle );
+
+/* Simulates until every submitted request completed; returns the cycle. */
+uint64_t nvmain_drain( nvmain_sim_t *sim );
+
+/* Copies up to max completions, oldest first, and returns how many. */
+size_t nvmain_poll( nvmain_sim_t *sim, nvmain_completion_t *completions, 
+                    size_t max );
+
+uint64_t nvmain_current_cycle( nvmain_sim_t *sim );
+
+/* Requests submitted but not yet completed. */
+size_t nvmain_outstanding( nvmain_sim_t *sim );
+
+/* Prints the stats to path (appending), or to stdout if path is NULL. */
+int nvmain_print_stats( nvmain_sim_t *sim, const char *path );
+
+/* 
+ *  Writes the simulation's trace ring (see TraceCategories) to path now.
+ *  Returns 0 on success. Since API version 2.
+ */
+int nvmain_dump_trace( nvmain_sim_t *sim, const char *path );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
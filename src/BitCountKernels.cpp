@@ -0,0 +1,528 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/BitCountKernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITCOUNT_KERNELS_X86
+#endif
+
+using namespace NVM;
+
+namespace {
+
+const uint64_t evenBits = 0x5555555555555555ULL;
+
+/* 
+ *  Lines are byte arrays, so load through memcpy rather than casting to
+ *  wider types. Tails are zero-padded, which adds no 1 bits and only
+ *  00 cells (00 cells are derived from the total, so that is harmless).
+ */
+inline uint64_t LoadWord( const uint8_t *data, ncounter_t bytes )
+{
+    uint64_t word = 0;
+
+    memcpy( &word, data, (bytes < 8) ? bytes : 8 );
+
+    return word;
+}
+
+inline ncounter_t Popcount64( uint64_t x )
+{
+    x = x - ((x >> 1) & evenBits);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return static_cast<ncounter_t>( (x * 0x0101010101010101ULL) >> 56 );
+}
+
+ncounter_t CountOnesPortable( const uint8_t *data, ncounter_t bytes )
+{
+    ncounter_t count = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+        count += Popcount64( LoadWord( data + i, bytes - i ) );
+
+    return count;
+}
+
+void CountMLC2CellsPortable( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t c01 = 0, c10 = 0, c11 = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t lo = word & evenBits;
+        uint64_t hi = (word >> 1) & evenBits;
+
+        c01 += Popcount64( lo & ~hi );
+        c10 += Popcount64( hi & ~lo );
+        c11 += Popcount64( hi & lo );
+    }
+
+    counts[0] = bytes * 4 - c01 - c10 - c11;
+    counts[1] = c01;
+    counts[2] = c10;
+    counts[3] = c11;
+}
+
+void CountWrittenCellsPortable( const uint8_t *data, const uint8_t *oldData,
+                                ncounter_t bytes, ncounter_t counts[2] )
+{
+    ncounter_t reset = 0, set = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t oldWord = LoadWord( oldData + i, bytes - i );
+
+        reset += Popcount64( oldWord & ~word );
+        set += Popcount64( word & ~oldWord );
+    }
+
+    counts[0] = reset;
+    counts[1] = set;
+}
+
+/* A cell changed if either of its bits did; count those by new value. */
+void CountMLC2WrittenCellsPortable( const uint8_t *data, const uint8_t *oldData,
+                                    ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t c00 = 0, c01 = 0, c10 = 0, c11 = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t diff = word ^ LoadWord( oldData + i, bytes - i );
+        uint64_t changed = (diff | (diff >> 1)) & evenBits;
+        uint64_t lo = word & evenBits;
+        uint64_t hi = (word >> 1) & evenBits;
+
+        c00 += Popcount64( changed & ~(lo | hi) );
+        c01 += Popcount64( changed & lo & ~hi );
+        c10 += Popcount64( changed & hi & ~lo );
+        c11 += Popcount64( changed & hi & lo );
+    }
+
+    counts[0] = c00;
+    counts[1] = c01;
+    counts[2] = c10;
+    counts[3] = c11;
+}
+
+#if defined(BITCOUNT_KERNELS_X86)
+/*
+ *  The x86 variants are compiled for their ISA extension regardless of the
+ *  global flags and are only selected if the host reports support.
+ */
+__attribute__((target("popcnt")))
+ncounter_t CountOnesPOPCNT( const uint8_t *data, ncounter_t bytes )
+{
+    ncounter_t count = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+        count += __builtin_popcountll( LoadWord( data + i, bytes - i ) );
+
+    return count;
+}
+
+__attribute__((target("popcnt")))
+void CountMLC2CellsPOPCNT( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t c01 = 0, c10 = 0, c11 = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t lo = word & evenBits;
+        uint64_t hi = (word >> 1) & evenBits;
+
+        c01 += __builtin_popcountll( lo & ~hi );
+        c10 += __builtin_popcountll( hi & ~lo );
+        c11 += __builtin_popcountll( hi & lo );
+    }
+
+    counts[0] = bytes * 4 - c01 - c10 - c11;
+    counts[1] = c01;
+    counts[2] = c10;
+    counts[3] = c11;
+}
+
+__attribute__((target("popcnt")))
+void CountWrittenCellsPOPCNT( const uint8_t *data, const uint8_t *oldData,
+                              ncounter_t bytes, ncounter_t counts[2] )
+{
+    ncounter_t reset = 0, set = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t oldWord = LoadWord( oldData + i, bytes - i );
+
+        reset += __builtin_popcountll( oldWord & ~word );
+        set += __builtin_popcountll( word & ~oldWord );
+    }
+
+    counts[0] = reset;
+    counts[1] = set;
+}
+
+__attribute__((target("popcnt")))
+void CountMLC2WrittenCellsPOPCNT( const uint8_t *data, const uint8_t *oldData,
+                                  ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t c00 = 0, c01 = 0, c10 = 0, c11 = 0;
+
+    for( ncounter_t i = 0; i < bytes; i += 8 )
+    {
+        uint64_t word = LoadWord( data + i, bytes - i );
+        uint64_t diff = word ^ LoadWord( oldData + i, bytes - i );
+        uint64_t changed = (diff | (diff >> 1)) & evenBits;
+        uint64_t lo = word & evenBits;
+        uint64_t hi = (word >> 1) & evenBits;
+
+        c00 += __builtin_popcountll( changed & ~(lo | hi) );
+        c01 += __builtin_popcountll( changed & lo & ~hi );
+        c10 += __builtin_popcountll( changed & hi & ~lo );
+        c11 += __builtin_popcountll( changed & hi & lo );
+    }
+
+    counts[0] = c00;
+    counts[1] = c01;
+    counts[2] = c10;
+    counts[3] = c11;
+}
+
+/* Per-byte popcount via a nibble lookup, summed into four 64-bit lanes. */
+__attribute__((target("avx2")))
+inline __m256i Popcount256( __m256i v )
+{
+    const __m256i lookup = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+    const __m256i lowNibble = _mm256_set1_epi8( 0x0F );
+
+    __m256i lo = _mm256_and_si256( v, lowNibble );
+    __m256i hi = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), lowNibble );
+    __m256i perByte = _mm256_add_epi8( _mm256_shuffle_epi8( lookup, lo ),
+                                       _mm256_shuffle_epi8( lookup, hi ) );
+
+    return _mm256_sad_epu8( perByte, _mm256_setzero_si256( ) );
+}
+
+__attribute__((target("avx2")))
+inline ncounter_t Sum256( __m256i v )
+{
+    uint64_t lanes[4];
+
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), v );
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2,popcnt")))
+ncounter_t CountOnesAVX2( const uint8_t *data, ncounter_t bytes )
+{
+    ncounter_t vecBytes = bytes & ~static_cast<ncounter_t>( 31 );
+    __m256i acc = _mm256_setzero_si256( );
+
+    for( ncounter_t i = 0; i < vecBytes; i += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + i ) );
+        acc = _mm256_add_epi64( acc, Popcount256( v ) );
+    }
+
+    return Sum256( acc ) + CountOnesPOPCNT( data + vecBytes, bytes - vecBytes );
+}
+
+__attribute__((target("avx2,popcnt")))
+void CountMLC2CellsAVX2( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t vecBytes = bytes & ~static_cast<ncounter_t>( 31 );
+    const __m256i even = _mm256_set1_epi64x( static_cast<long long>( evenBits ) );
+    __m256i acc01 = _mm256_setzero_si256( );
+    __m256i acc10 = _mm256_setzero_si256( );
+    __m256i acc11 = _mm256_setzero_si256( );
+
+    for( ncounter_t i = 0; i < vecBytes; i += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + i ) );
+        __m256i lo = _mm256_and_si256( v, even );
+        __m256i hi = _mm256_and_si256( _mm256_srli_epi64( v, 1 ), even );
+
+        acc01 = _mm256_add_epi64( acc01, Popcount256( _mm256_andnot_si256( hi, lo ) ) );
+        acc10 = _mm256_add_epi64( acc10, Popcount256( _mm256_andnot_si256( lo, hi ) ) );
+        acc11 = _mm256_add_epi64( acc11, Popcount256( _mm256_and_si256( hi, lo ) ) );
+    }
+
+    CountMLC2CellsPOPCNT( data + vecBytes, bytes - vecBytes, counts );
+
+    counts[1] += Sum256( acc01 );
+    counts[2] += Sum256( acc10 );
+    counts[3] += Sum256( acc11 );
+    counts[0] = bytes * 4 - counts[1] - counts[2] - counts[3];
+}
+
+__attribute__((target("avx2,popcnt")))
+void CountWrittenCellsAVX2( const uint8_t *data, const uint8_t *oldData,
+                            ncounter_t bytes, ncounter_t counts[2] )
+{
+    ncounter_t vecBytes = bytes & ~static_cast<ncounter_t>( 31 );
+    __m256i accReset = _mm256_setzero_si256( );
+    __m256i accSet = _mm256_setzero_si256( );
+
+    for( ncounter_t i = 0; i < vecBytes; i += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + i ) );
+        __m256i o = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( oldData + i ) );
+
+        accReset = _mm256_add_epi64( accReset, Popcount256( _mm256_andnot_si256( v, o ) ) );
+        accSet = _mm256_add_epi64( accSet, Popcount256( _mm256_andnot_si256( o, v ) ) );
+    }
+
+    CountWrittenCellsPOPCNT( data + vecBytes, oldData + vecBytes, bytes - vecBytes, counts );
+
+    counts[0] += Sum256( accReset );
+    counts[1] += Sum256( accSet );
+}
+
+__attribute__((target("avx2,popcnt")))
+void CountMLC2WrittenCellsAVX2( const uint8_t *data, const uint8_t *oldData,
+                                ncounter_t bytes, ncounter_t counts[4] )
+{
+    ncounter_t vecBytes = bytes & ~static_cast<ncounter_t>( 31 );
+    const __m256i even = _mm256_set1_epi64x( static_cast<long long>( evenBits ) );
+    __m256i acc00 = _mm256_setzero_si256( );
+    __m256i acc01 = _mm256_setzero_si256( );
+    __m256i acc10 = _mm256_setzero_si256( );
+    __m256i acc11 = _mm256_setzero_si256( );
+
+    for( ncounter_t i = 0; i < vecBytes; i += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + i ) );
+        __m256i o = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( oldData + i ) );
+        __m256i diff = _mm256_xor_si256( v, o );
+        __m256i changed = _mm256_and_si256( _mm256_or_si256( diff, _mm256_srli_epi64( diff, 1 ) ), even );
+        __m256i lo = _mm256_and_si256( v, even );
+        __m256i hi = _mm256_and_si256( _mm256_srli_epi64( v, 1 ), even );
+
+        acc00 = _mm256_add_epi64( acc00, Popcount256( _mm256_andnot_si256( _mm256_or_si256( lo, hi ), changed ) ) );
+        acc01 = _mm256_add_epi64( acc01, Popcount256( _mm256_and_si256( changed, _mm256_andnot_si256( hi, lo ) ) ) );
+        acc10 = _mm256_add_epi64( acc10, Popcount256( _mm256_and_si256( changed, _mm256_andnot_si256( lo, hi ) ) ) );
+        acc11 = _mm256_add_epi64( acc11, Popcount256( _mm256_and_si256( changed, _mm256_and_si256( hi, lo ) ) ) );
+    }
+
+    CountMLC2WrittenCellsPOPCNT( data + vecBytes, oldData + vecBytes, bytes - vecBytes, counts );
+
+    counts[0] += Sum256( acc00 );
+    counts[1] += Sum256( acc01 );
+    counts[2] += Sum256( acc10 );
+    counts[3] += Sum256( acc11 );
+}
+
+/*
+ *  AVX-512 VPOPCNTDQ; tails are handled with masked loads. The zero-masked
+ *  forms of the shifts and the lane sum through memory avoid the intrinsics
+ *  built on _mm512_undefined, which trip -Wuninitialized in some GCCs.
+ */
+__attribute__((target("avx512f")))
+inline ncounter_t Sum512( __m512i v )
+{
+    uint64_t lanes[8];
+
+    _mm512_storeu_si512( lanes, v );
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3]
+         + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+ncounter_t CountOnesAVX512( const uint8_t *data, ncounter_t bytes )
+{
+    __m512i acc = _mm512_setzero_si512( );
+
+    for( ncounter_t i = 0; i < bytes; i += 64 )
+    {
+        ncounter_t left = bytes - i;
+        __mmask64 mask = (left >= 64) ? ~0ULL : ((1ULL << left) - 1);
+        __m512i v = _mm512_maskz_loadu_epi8( mask, data + i );
+
+        acc = _mm512_add_epi64( acc, _mm512_popcnt_epi64( v ) );
+    }
+
+    return Sum512( acc );
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+void CountMLC2CellsAVX512( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] )
+{
+    const __m512i even = _mm512_set1_epi64( static_cast<long long>( evenBits ) );
+    __m512i acc01 = _mm512_setzero_si512( );
+    __m512i acc10 = _mm512_setzero_si512( );
+    __m512i acc11 = _mm512_setzero_si512( );
+
+    for( ncounter_t i = 0; i < bytes; i += 64 )
+    {
+        ncounter_t left = bytes - i;
+        __mmask64 mask = (left >= 64) ? ~0ULL : ((1ULL << left) - 1);
+        __m512i v = _mm512_maskz_loadu_epi8( mask, data + i );
+        __m512i lo = _mm512_and_si512( v, even );
+        __m512i hi = _mm512_and_si512( _mm512_maskz_srli_epi64( ~0, v, 1 ), even );
+
+        acc01 = _mm512_add_epi64( acc01, _mm512_popcnt_epi64( _mm512_maskz_andnot_epi64( ~0, hi, lo ) ) );
+        acc10 = _mm512_add_epi64( acc10, _mm512_popcnt_epi64( _mm512_maskz_andnot_epi64( ~0, lo, hi ) ) );
+        acc11 = _mm512_add_epi64( acc11, _mm512_popcnt_epi64( _mm512_and_si512( hi, lo ) ) );
+    }
+
+    counts[1] = Sum512( acc01 );
+    counts[2] = Sum512( acc10 );
+    counts[3] = Sum512( acc11 );
+    counts[0] = bytes * 4 - counts[1] - counts[2] - counts[3];
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+void CountWrittenCellsAVX512( const uint8_t *data, const uint8_t *oldData,
+                              ncounter_t bytes, ncounter_t counts[2] )
+{
+    __m512i accReset = _mm512_setzero_si512( );
+    __m512i accSet = _mm512_setzero_si512( );
+
+    for( ncounter_t i = 0; i < bytes; i += 64 )
+    {
+        ncounter_t left = bytes - i;
+        __mmask64 mask = (left >= 64) ? ~0ULL : ((1ULL << left) - 1);
+        __m512i v = _mm512_maskz_loadu_epi8( mask, data + i );
+        __m512i o = _mm512_maskz_loadu_epi8( mask, oldData + i );
+
+        accReset = _mm512_add_epi64( accReset, _mm512_popcnt_epi64( _mm512_maskz_andnot_epi64( ~0, v, o ) ) );
+        accSet = _mm512_add_epi64( accSet, _mm512_popcnt_epi64( _mm512_maskz_andnot_epi64( ~0, o, v ) ) );
+    }
+
+    counts[0] = Sum512( accReset );
+    counts[1] = Sum512( accSet );
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq")))
+void CountMLC2WrittenCellsAVX512( const uint8_t *data, const uint8_t *oldData,
+                                  ncounter_t bytes, ncounter_t counts[4] )
+{
+    const __m512i even = _mm512_set1_epi64( static_cast<long long>( evenBits ) );
+    __m512i acc00 = _mm512_setzero_si512( );
+    __m512i acc01 = _mm512_setzero_si512( );
+    __m512i acc10 = _mm512_setzero_si512( );
+    __m512i acc11 = _mm512_setzero_si512( );
+
+    for( ncounter_t i = 0; i < bytes; i += 64 )
+    {
+        ncounter_t left = bytes - i;
+        __mmask64 mask = (left >= 64) ? ~0ULL : ((1ULL << left) - 1);
+        __m512i v = _mm512_maskz_loadu_epi8( mask, data + i );
+        __m512i o = _mm512_maskz_loadu_epi8( mask, oldData + i );
+        __m512i diff = _mm512_xor_si512( v, o );
+        __m512i changed = _mm512_and_si512( _mm512_or_si512( diff, _mm512_maskz_srli_epi64( ~0, diff, 1 ) ), even );
+        __m512i lo = _mm512_and_si512( v, even );
+        __m512i hi = _mm512_and_si512( _mm512_maskz_srli_epi64( ~0, v, 1 ), even );
+
+        acc00 = _mm512_add_epi64( acc00, _mm512_popcnt_epi64( _mm512_maskz_andnot_epi64( ~0, _mm512_or_si512( lo, hi ), changed ) ) );
+        acc01 = _mm512_add_epi64( acc01, _mm512_popcnt_epi64( _mm512_and_si512( changed, _mm512_maskz_andnot_epi64( ~0, hi, lo ) ) ) );
+        acc10 = _mm512_add_epi64( acc10, _mm512_popcnt_epi64( _mm512_and_si512( changed, _mm512_maskz_andnot_epi64( ~0, lo, hi ) ) ) );
+        acc11 = _mm512_add_epi64( acc11, _mm512_popcnt_epi64( _mm512_and_si512( changed, _mm512_and_si512( hi, lo ) ) ) );
+    }
+
+    counts[0] = Sum512( acc00 );
+    counts[1] = Sum512( acc01 );
+    counts[2] = Sum512( acc10 );
+    counts[3] = Sum512( acc11 );
+}
+#endif
+
+const BitCountKernel portableKernel = 
+    { "portable", CountOnesPortable, CountMLC2CellsPortable,
+      CountWrittenCellsPortable, CountMLC2WrittenCellsPortable };
+
+#if defined(BITCOUNT_KERNELS_X86)
+const BitCountKernel popcntKernel = 
+    { "popcnt", CountOnesPOPCNT, CountMLC2CellsPOPCNT,
+      CountWrittenCellsPOPCNT, CountMLC2WrittenCellsPOPCNT };
+const BitCountKernel avx2Kernel = 
+    { "avx2", CountOnesAVX2, CountMLC2CellsAVX2,
+      CountWrittenCellsAVX2, CountMLC2WrittenCellsAVX2 };
+const BitCountKernel avx512Kernel = 
+    { "avx512", CountOnesAVX512, CountMLC2CellsAVX512,
+      CountWrittenCellsAVX512, CountMLC2WrittenCellsAVX512 };
+
+bool HostSupports( const BitCountKernel *kernel )
+{
+    __builtin_cpu_init( );
+
+    if( kernel == &popcntKernel )
+        return __builtin_cpu_supports( "popcnt" );
+    else if( kernel == &avx2Kernel )
+        return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "popcnt" );
+    else if( kernel == &avx512Kernel )
+        return __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" )
+            && __builtin_cpu_supports( "avx512vpopcntdq" );
+
+    return true;
+}
+#endif
+
+}
+
+const BitCountKernel *NVM::GetBitCountKernel( std::string name )
+{
+#if defined(BITCOUNT_KERNELS_X86)
+    /* Fastest first, for "auto". */
+    const BitCountKernel *kernels[] = 
+        { &avx512Kernel, &avx2Kernel, &popcntKernel, &portableKernel };
+
+    for( unsigned int idx = 0; idx < sizeof(kernels) / sizeof(kernels[0]); idx++ )
+    {
+        if( name != "auto" && name != kernels[idx]->name )
+            continue;
+
+        if( HostSupports( kernels[idx] ) )
+            return kernels[idx];
+        else if( name != "auto" )
+            return NULL;
+    }
+#else
+    if( name == "auto" || name == portableKernel.name )
+        return &portableKernel;
+#endif
+
+    return NULL;
+}
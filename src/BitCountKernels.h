@@ -0,0 +1,81 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_BITCOUNTKERNELS_H__
+#define __NVM_BITCOUNTKERNELS_H__
+
+#include "include/NVMTypes.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace NVM {
+
+/*
+ *  Bit counting kernels used to compute the write energy and MLC write
+ *  time of a line, either of every cell or only of the changed cells.
+ *  Lines may be any number of bytes and need not be aligned.
+ */
+struct BitCountKernel
+{
+    const char *name;
+
+    /* Number of 1 bits in data[0 .. bytes). */
+    ncounter_t (*countOnes)( const uint8_t *data, ncounter_t bytes );
+
+    /* Number of 2-bit cells holding 00, 01, 10 and 11, in that order. */
+    void (*countMLC2Cells)( const uint8_t *data, ncounter_t bytes, 
+                            ncounter_t counts[4] );
+
+    /* 
+     *  Cells a differential write programs, i.e., those that differ from
+     *  oldData: counts[0] go from 1 to 0 and counts[1] from 0 to 1.
+     */
+    void (*countWrittenCells)( const uint8_t *data, const uint8_t *oldData,
+                               ncounter_t bytes, ncounter_t counts[2] );
+
+    /* Changed 2-bit cells by their new value (00, 01, 10 and 11). */
+    void (*countMLC2WrittenCells)( const uint8_t *data, const uint8_t *oldData,
+                                   ncounter_t bytes, ncounter_t counts[4] );
+};
+
+/*
+ *  Returns the fastest kernel the host supports for "auto", otherwise the
+ *  named kernel (portable, popcnt, avx2 or avx512). Returns NULL if the
+ *  name is unknown or the host can not run that kernel.
+ */
+const BitCountKernel *GetBitCountKernel( std::string name );
+
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/CIMKernels.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CIM_KERNELS_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CIM_KERNELS_NEON
+#endif
+
+using namespace NVM;
+
+namespace {
+
+enum CIMBitOp
+{
+    CIM_BIT_AND,
+    CIM_BIT_OR,
+    CIM_BIT_XOR
+};
+
+/* dst = dst <op> src over 'words' 64-bit words. */
+typedef void (*CIMAccumulateFn)( CIMBitOp, uint64_t *, const uint64_t *, ncounter_t );
+/* dst = ~dst over 'words' 64-bit words. */
+typedef void (*CIMInvertFn)( uint64_t *, ncounter_t );
+
+void AccumulatePortable( CIMBitOp op, uint64_t *dst, const uint64_t *src,
+                         ncounter_t words )
+{
+    ncounter_t i;
+
+    switch( op )
+    {
+        case CIM_BIT_AND: for( i = 0; i < words; i++ ) dst[i] &= src[i]; break;
+        case CIM_BIT_OR:  for( i = 0; i < words; i++ ) dst[i] |= src[i]; break;
+        case CIM_BIT_XOR: for( i = 0; i < words; i++ ) dst[i] ^= src[i]; break;
+    }
+}
+
+void InvertPortable( uint64_t *dst, ncounter_t words )
+{
+    for( ncounter_t i = 0; i < words; i++ )
+        dst[i] = ~dst[i];
+}
+
+#if defined(CIM_KERNELS_X86)
+/*
+ *  The AVX2 variants are compiled for AVX2 regardless of the global flags and
+ *  only called if the host reports AVX2 support. Tails shorter than a vector
+ *  fall back to the portable loop.
+ */
+__attribute__((target("avx2")))
+void AccumulateAVX2( CIMBitOp op, uint64_t *dst, const uint64_t *src,
+                     ncounter_t words )
+{
+    ncounter_t vecWords = words & ~static_cast<ncounter_t>( 3 );
+    ncounter_t i;
+
+    for( i = 0; i < vecWords; i += 4 )
+    {
+        __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( dst + i ) );
+        __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( src + i ) );
+
+        if( op == CIM_BIT_AND )     a = _mm256_and_si256( a, b );
+        else if( op == CIM_BIT_OR ) a = _mm256_or_si256( a, b );
+        else                        a = _mm256_xor_si256( a, b );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), a );
+    }
+
+    AccumulatePortable( op, dst + vecWords, src + vecWords, words - vecWords );
+}
+
+__attribute__((target("avx2")))
+void InvertAVX2( uint64_t *dst, ncounter_t words )
+{
+    ncounter_t vecWords = words & ~static_cast<ncounter_t>( 3 );
+    __m256i ones = _mm256_set1_epi64x( -1 );
+
+    for( ncounter_t i = 0; i < vecWords; i += 4 )
+    {
+        __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( dst + i ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ),
+                             _mm256_xor_si256( a, ones ) );
+    }
+
+    InvertPortable( dst + vecWords, words - vecWords );
+}
+#endif
+
+#if defined(CIM_KERNELS_NEON)
+void AccumulateNEON( CIMBitOp op, uint64_t *dst, const uint64_t *src,
+                     ncounter_t words )
+{
+    ncounter_t vecWords = words & ~static_cast<ncounter_t>( 1 );
+    ncounter_t i;
+
+    for( i = 0; i < vecWords; i += 2 )
+    {
+        uint64x2_t a = vld1q_u64( dst + i );
+        uint64x2_t b = vld1q_u64( src + i );
+
+        if( op == CIM_BIT_AND )     a = vandq_u64( a, b );
+        else if( op == CIM_BIT_OR ) a = vorrq_u64( a, b );
+        else                        a = veorq_u64( a, b );
+
+        vst1q_u64( dst + i, a );
+    }
+
+    AccumulatePortable( op, dst + vecWords, src + vecWords, words - vecWords );
+}
+
+void InvertNEON( uint64_t *dst, ncounter_t words )
+{
+    ncounter_t vecWords = words & ~static_cast<ncounter_t>( 1 );
+
+    for( ncounter_t i = 0; i < vecWords; i += 2 )
+    {
+        uint32x4_t a = vreinterpretq_u32_u64( vld1q_u64( dst + i ) );
+        vst1q_u64( dst + i, vreinterpretq_u64_u32( vmvnq_u32( a ) ) );
+    }
+
+    InvertPortable( dst + vecWords, words - vecWords );
+}
+#endif
+
+struct CIMKernelTable
+{
+    CIMAccumulateFn accumulate;
+    CIMInvertFn invert;
+
+    CIMKernelTable( )
+    {
+        accumulate = AccumulatePortable;
+        invert = InvertPortable;
+
+#if defined(CIM_KERNELS_X86)
+        __builtin_cpu_init( );
+        if( __builtin_cpu_supports( "avx2" ) )
+        {
+            accumulate = AccumulateAVX2;
+            invert = InvertAVX2;
+        }
+#elif defined(CIM_KERNELS_NEON)
+        accumulate = AccumulateNEON;
+        invert = InvertNEON;
+#endif
+    }
+};
+
+const CIMKernelTable& GetKernels( )
+{
+    static CIMKernelTable kernels;
+
+    return kernels;
+}
+
+}
+
+void NVM::CIMRowKernel( OpType op, uint64_t *dst, uint64_t **rows,
+                        ncounter_t numRows, ncounter_t words )
+{
+    const CIMKernelTable& kernels = GetKernels( );
+    CIMBitOp bitOp = CIM_BIT_AND;
+    bool invert = false;
+
+    assert( numRows > 0 );
+
+    switch( op )
+    {
+        case NOT_IN_ARRAY:  bitOp = CIM_BIT_AND; invert = true;  break;
+        case AND_IN_ARRAY:
+        case AND_IN_LATCH:  bitOp = CIM_BIT_AND; invert = false; break;
+        case NAND_IN_LATCH: bitOp = CIM_BIT_AND; invert = true;  break;
+        case OR_IN_LATCH:   bitOp = CIM_BIT_OR;  invert = false; break;
+        case NOR_IN_LATCH:  bitOp = CIM_BIT_OR;  invert = true;  break;
+        case XOR_IN_LATCH:  bitOp = CIM_BIT_XOR; invert = false; break;
+        default:            assert( false ); break;
+    }
+
+    /* NOT only senses its first operand row. */
+    if( op == NOT_IN_ARRAY )
+        numRows = 1;
+
+    memcpy( dst, rows[0], words * sizeof(uint64_t) );
+
+    for( ncounter_t rowIdx = 1; rowIdx < numRows; rowIdx++ )
+        kernels.accumulate( bitOp, dst, rows[rowIdx], words );
+
+    if( invert )
+        kernels.invert( dst, words );
+}
@@ -0,0 +1,199 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Checkpoint.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace NVM;
+
+const uint32_t CheckpointWriter::Version;
+
+static const char CheckpointMagic[4] = { 'N', 'V', 'M', 'C' };
+
+static std::string CheckpointPath( const std::string& dir, const std::string& name )
+{
+    return dir + "/" + name + ".cpt";
+}
+
+CheckpointWriter::CheckpointWriter( const std::string& dir, const std::string& name )
+{
+    path = CheckpointPath( dir, name );
+    stream.open( path.c_str( ), std::ofstream::out | std::ofstream::trunc 
+                                | std::ofstream::binary );
+
+    if( !stream.is_open( ) )
+    {
+        std::cerr << "NVMain Error: Could not write checkpoint file " << path
+                  << std::endl;
+        exit(1);
+    }
+
+    stream.write( CheckpointMagic, sizeof(CheckpointMagic) );
+    Write( Version );
+    Write( name );
+}
+
+CheckpointWriter::~CheckpointWriter( )
+{
+    stream.close( );
+
+    if( stream.fail( ) )
+    {
+        std::cerr << "NVMain Error: Failed writing checkpoint file " << path
+                  << std::endl;
+        exit(1);
+    }
+}
+
+void CheckpointWriter::Write( const std::string& value )
+{
+    Write( static_cast<uint64_t>( value.size( ) ) );
+    stream.write( value.data( ), static_cast<std::streamsize>( value.size( ) ) );
+}
+
+void CheckpointWriter::BeginSection( )
+{
+    sectionStart = stream.tellp( );
+    Write( static_cast<uint64_t>( 0 ) );
+}
+
+void CheckpointWriter::EndSection( )
+{
+    std::streampos end = stream.tellp( );
+    uint64_t length = static_cast<uint64_t>( end - sectionStart ) - sizeof(uint64_t);
+
+    stream.seekp( sectionStart );
+    Write( length );
+    stream.seekp( end );
+}
+
+CheckpointReader::CheckpointReader( const std::string& dir, const std::string& name )
+{
+    char magic[sizeof(CheckpointMagic)];
+    uint32_t version;
+    std::string savedName;
+
+    path = CheckpointPath( dir, name );
+    stream.open( path.c_str( ), std::ifstream::in | std::ifstream::binary );
+
+    if( !stream.is_open( ) )
+    {
+        std::cerr << "NVMain Error: Could not read checkpoint file " << path
+                  << std::endl;
+        exit(1);
+    }
+
+    stream.read( magic, sizeof(magic) );
+    Check( );
+
+    if( memcmp( magic, CheckpointMagic, sizeof(magic) ) != 0 )
+    {
+        std::cerr << "NVMain Error: " << path << " is not a checkpoint file."
+                  << std::endl;
+        exit(1);
+    }
+
+    Read( version );
+
+    if( version != CheckpointWriter::Version )
+    {
+        std::cerr << "NVMain Error: Checkpoint file " << path << " has version "
+                  << version << ", expected " << CheckpointWriter::Version 
+                  << "." << std::endl;
+        exit(1);
+    }
+
+    Read( savedName );
+
+    if( savedName != name )
+    {
+        std::cerr << "NVMain Error: Checkpoint file " << path << " belongs to "
+                  << savedName << "." << std::endl;
+        exit(1);
+    }
+}
+
+CheckpointReader::~CheckpointReader( )
+{
+    stream.close( );
+}
+
+void CheckpointReader::Read( std::string& value )
+{
+    uint64_t length;
+
+    Read( length );
+    value.resize( length );
+    if( length > 0 )
+        stream.read( &value[0], static_cast<std::streamsize>( length ) );
+    Check( );
+}
+
+void CheckpointReader::Expect( uint64_t saved, uint64_t configured, const char *what )
+{
+    if( saved != configured )
+    {
+        std::cerr << "NVMain Error: Checkpoint file " << path << " was taken with "
+                  << what << " " << saved << ", but it is configured as " 
+                  << configured << "." << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t CheckpointReader::BeginSection( )
+{
+    uint64_t length;
+
+    Read( length );
+
+    return length;
+}
+
+void CheckpointReader::SkipSection( uint64_t length )
+{
+    stream.seekg( static_cast<std::streamoff>( length ), std::ifstream::cur );
+    Check( );
+}
+
+void CheckpointReader::Check( )
+{
+    if( !stream.good( ) )
+    {
+        std::cerr << "NVMain Error: Checkpoint file " << path << " is truncated."
+                  << std::endl;
+        exit(1);
+    }
+}
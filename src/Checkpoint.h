@@ -0,0 +1,183 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_CHECKPOINT_H__
+#define __NVMAIN_CHECKPOINT_H__
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  Versioned binary checkpoint files. Every object with state writes its own
+ *  file, named after its StatName, into the checkpoint directory. Each file
+ *  starts with a magic number, the format version and the object name, so a
+ *  restore refuses files from another format version or another object.
+ *
+ *  Checkpoints are taken with the system drained: no request is in flight,
+ *  so queues are empty and only timing, architectural and statistics state
+ *  is saved. Values are written in host byte order.
+ */
+class CheckpointWriter
+{
+  public:
+    static const uint32_t Version = 5;
+
+    CheckpointWriter( const std::string& dir, const std::string& name );
+    ~CheckpointWriter( );
+
+    template<typename T> void Write( const T& value )
+    {
+        stream.write( reinterpret_cast<const char *>( &value ), sizeof(T) );
+    }
+    void Write( const std::string& value );
+
+    template<typename T> void WriteArray( const T *values, uint64_t count )
+    {
+        Write( count );
+        stream.write( reinterpret_cast<const char *>( values ), 
+                      static_cast<std::streamsize>( sizeof(T) * count ) );
+    }
+
+    template<typename K, typename V> void Write( const std::map<K, V>& values )
+    {
+        typename std::map<K, V>::const_iterator it;
+
+        Write( static_cast<uint64_t>( values.size( ) ) );
+        for( it = values.begin( ); it != values.end( ); it++ )
+        {
+            Write( it->first );
+            Write( it->second );
+        }
+    }
+
+    template<typename T> void Write( const std::set<T>& values )
+    {
+        typename std::set<T>::const_iterator it;
+
+        Write( static_cast<uint64_t>( values.size( ) ) );
+        for( it = values.begin( ); it != values.end( ); it++ )
+            Write( *it );
+    }
+
+    /* 
+     *  A section is prefixed with its length so a reader can skip it, e.g.,
+     *  the saved value of a stat that no longer exists.
+     */
+    void BeginSection( );
+    void EndSection( );
+
+  private:
+    std::string path;
+    std::ofstream stream;
+    std::streampos sectionStart;
+};
+
+class CheckpointReader
+{
+  public:
+    CheckpointReader( const std::string& dir, const std::string& name );
+    ~CheckpointReader( );
+
+    template<typename T> void Read( T& value )
+    {
+        stream.read( reinterpret_cast<char *>( &value ), sizeof(T) );
+        Check( );
+    }
+    void Read( std::string& value );
+
+    /* The saved count must match count, i.e., the same configuration. */
+    template<typename T> void ReadArray( T *values, uint64_t count )
+    {
+        uint64_t savedCount;
+
+        Read( savedCount );
+        Expect( savedCount, count, "array length" );
+        stream.read( reinterpret_cast<char *>( values ), 
+                     static_cast<std::streamsize>( sizeof(T) * count ) );
+        Check( );
+    }
+
+    template<typename K, typename V> void Read( std::map<K, V>& values )
+    {
+        uint64_t count;
+
+        values.clear( );
+        Read( count );
+        for( uint64_t i = 0; i < count; i++ )
+        {
+            K key;
+            V value;
+
+            Read( key );
+            Read( value );
+            values.insert( std::make_pair( key, value ) );
+        }
+    }
+
+    template<typename T> void Read( std::set<T>& values )
+    {
+        uint64_t count;
+
+        values.clear( );
+        Read( count );
+        for( uint64_t i = 0; i < count; i++ )
+        {
+            T value;
+
+            Read( value );
+            values.insert( value );
+        }
+    }
+
+    /* Exits if a saved dimension differs from the configured one. */
+    void Expect( uint64_t saved, uint64_t configured, const char *what );
+
+    uint64_t BeginSection( );
+    void SkipSection( uint64_t length );
+
+  private:
+    std::string path;
+    std::ifstream stream;
+
+    void Check( );
+};
+
+};
+
+#endif
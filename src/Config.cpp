@@ -39,19 +39,73 @@
 #include <cstdlib>
 #include <assert.h>
 #include <limits>
+#include <algorithm>
+#include <cctype>
 #include "src/Config.h"
+#include "src/Params.h"
 
 using namespace NVM;
 
+const ConfigKey CompiledConfig::InvalidKey = std::numeric_limits<ConfigKey>::max( );
+
+CompiledConfig::CompiledConfig( const std::map<std::string, std::string>& values )
+{
+    std::map<std::string, std::string>::const_iterator it;
+
+    names.reserve( values.size( ) );
+    entries.reserve( values.size( ) );
+
+    for( it = values.begin( ); it != values.end( ); it++ )
+    {
+        ConfigValue entry;
+
+        entry.text = it->second;
+        entry.valueUL = strtoul( it->second.c_str( ), NULL, 10 );
+        entry.value = atoi( it->second.c_str( ) );
+        entry.energy = (double)atof( it->second.c_str( ) );
+        entry.flag = ( it->second == "true" );
+
+        index[it->first] = static_cast<ConfigKey>( entries.size( ) );
+        names.push_back( it->first );
+        entries.push_back( entry );
+    }
+}
+
+ConfigKey CompiledConfig::Intern( const std::string& key ) const
+{
+    std::unordered_map<std::string, ConfigKey>::const_iterator it;
+
+    it = index.find( key );
+
+    return ( it == index.end( ) ) ? InvalidKey : it->second;
+}
+
 Config::Config( )
 {
     simPtr = NULL;
     useDebugLog = false;
+    params = NULL;
+    compiled = NULL;
+    recordKeys = false;
+    queried.reset( new ConfigUsage( ) );
 }
 
 
 Config::~Config( )
 {
+    std::vector<Params *>::iterator it;
+
+    for( it = staleParams.begin( ); it != staleParams.end( ); it++ )
+        delete (*it);
+
+    delete params;
+
+    std::vector<CompiledConfig *>::iterator cit;
+
+    for( cit = staleCompiled.begin( ); cit != staleCompiled.end( ); cit++ )
+        delete (*cit);
+
+    delete compiled;
 }
 
 Config::Config(const Config& conf)
@@ -66,6 +120,16 @@ Config::Config(const Config& conf)
 
     fileName = conf.fileName;
     simPtr = conf.simPtr;
+    useDebugLog = false;
+    params = NULL;
+    compiled = NULL;
+    recordKeys = false;
+
+    /* 
+     *  Copies (e.g., per-channel configs) share the record of which keys
+     *  were read, so a key read only through a copy still counts as used.
+     */
+    queried = conf.queried;
 
     std::vector<std::string> tmpVec(conf.hookList);
     std::vector<std::string>::iterator vit;
@@ -93,6 +157,8 @@ void Config::Read( std::string filename )
 
     this->fileName = filename;
 
+    InvalidateParams( );
+
     if( configFile.is_open( ) ) 
     {
         while( !configFile.eof( ) ) 
@@ -179,178 +245,325 @@ void Config::Read( std::string filename )
     SetDebugLog( );
 }
 
-bool Config::KeyExists( std::string key )
+/*
+ *  Parsing the config into Params is expensive, so every object built from
+ *  the same config shares one snapshot instead of parsing its own copy.
+ *  The snapshot must be treated as read-only.
+ */
+Params *Config::GetParams( )
 {
-    std::map<std::string, std::string>::iterator i;
+    if( params == NULL )
+    {
+        params = new Params( );
+        params->SetParams( this );
+    }
 
-    if( values.empty( ) )
-        return false;
+    return params;
+}
 
-    i = values.find( key );
+/*
+ *  Same sharing rule as GetParams: the table is built on first use and kept
+ *  until the config changes. Callers may hold the pointer and intern keys
+ *  once, so it must be treated as read-only.
+ */
+const CompiledConfig *Config::Compile( )
+{
+    if( compiled == NULL )
+    {
+        compiled = new CompiledConfig( values );
+
+        /* Only ConfigCheck warn and strict need the keys that were read. */
+        std::map<std::string, std::string>::iterator it = values.find( "ConfigCheck" );
+        recordKeys = ( it != values.end( ) && it->second != "none" );
+    }
+
+    return compiled;
+}
+
+/*
+ *  Objects created before a config change keep the snapshot they were
+ *  given, so an outdated snapshot is kept alive until the config is freed.
+ */
+void Config::InvalidateParams( )
+{
+    if( params != NULL )
+    {
+        staleParams.push_back( params );
+        params = NULL;
+    }
+
+    if( compiled != NULL )
+    {
+        staleCompiled.push_back( compiled );
+        compiled = NULL;
+    }
+}
+
+/* Case-insensitive edit distance, used to suggest the key that was meant. */
+static size_t KeyDistance( const std::string& a, const std::string& b )
+{
+    std::vector<size_t> row( b.size( ) + 1 );
+
+    for( size_t j = 0; j <= b.size( ); j++ )
+        row[j] = j;
+
+    for( size_t i = 1; i <= a.size( ); i++ )
+    {
+        size_t diag = row[0];
+        row[0] = i;
+
+        for( size_t j = 1; j <= b.size( ); j++ )
+        {
+            size_t above = row[j];
+            bool same = ( tolower( a[i-1] ) == tolower( b[j-1] ) );
+
+            row[j] = std::min( std::min( row[j] + 1, row[j-1] + 1 ),
+                               diag + ( same ? 0 : 1 ) );
+            diag = above;
+        }
+    }
+
+    return row[b.size( )];
+}
+
+/*
+ *  Run once the whole system has been configured. Any key that is set but
+ *  was never read is either meant for a module that is not in use or is
+ *  misspelled; in the latter case the intended key was almost certainly
+ *  looked up and found missing, so it is offered as a suggestion.
+ *
+ *  ConfigCheck selects the behavior: "none" (default) skips the check,
+ *  "warn" prints the unused keys and "strict" also exits on a misspelling.
+ */
+void Config::CheckKeys( )
+{
+    std::string mode = "none";
+
+    if( KeyExists( "ConfigCheck" ) )
+        mode = GetString( "ConfigCheck" );
+
+    if( mode == "none" )
+        return;
+
+    if( mode != "warn" && mode != "strict" )
+    {
+        std::cerr << "NVMain Error: Unknown ConfigCheck mode '" << mode
+                  << "'. Use none, warn or strict." << std::endl;
+        exit(1);
+    }
+
+    std::map<std::string, std::string>::iterator it;
+    std::unordered_set<std::string>::iterator qit;
+    bool misspelled = false;
+
+    std::lock_guard<std::mutex> guard( queried->lock );
+
+    for( it = values.begin( ); it != values.end( ); it++ )
+    {
+        if( queried->keys.count( it->first ) )
+            continue;
+
+        std::string suggestion;
+        size_t bestDistance = std::max( (size_t)1, std::min( (size_t)2, it->first.size( ) / 4 ) ) + 1;
+
+        for( qit = queried->keys.begin( ); qit != queried->keys.end( ); qit++ )
+        {
+            if( values.count( *qit ) )
+                continue;
+
+            size_t distance = KeyDistance( it->first, *qit );
+
+            if( distance < bestDistance 
+                || ( distance == bestDistance && !suggestion.empty( ) && *qit < suggestion ) )
+            {
+                bestDistance = distance;
+                suggestion = *qit;
+            }
+        }
+
+        std::cout << "Config: Warning: Key " << it->first << " is never used";
+        if( !suggestion.empty( ) )
+        {
+            std::cout << ". Did you mean " << suggestion << "?";
+            misspelled = true;
+        }
+        std::cout << std::endl;
+    }
 
-    if( i == values.end( ) )
+    if( mode == "strict" && misspelled )
+    {
+        std::cerr << "NVMain Error: Misspelled configuration keys found." << std::endl;
+        exit(1);
+    }
+}
+
+/*
+ *  Every getter funnels through here. With ConfigCheck on, the name is
+ *  recorded whether or not the key is set, so CheckKeys can tell unused
+ *  keys from mistyped ones.
+ */
+const ConfigValue *Config::Lookup( const std::string& key )
+{
+    const CompiledConfig *table = Compile( );
+
+    if( recordKeys )
+    {
+        std::lock_guard<std::mutex> guard( queried->lock );
+        queried->keys.insert( key );
+    }
+
+    ConfigKey id = table->Intern( key );
+
+    if( id == CompiledConfig::InvalidKey )
+        return NULL;
+
+    return &table->Get( id );
+}
+
+bool Config::KeyExists( std::string key )
+{
+    if( values.empty( ) )
         return false;
 
-    return true;
+    return ( Lookup( key ) != NULL );
 }
 
 
 void Config::GetString( std::string key, std::string& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    const ConfigValue *entry = Lookup( key );
+
+    if( entry == NULL && !warned.count( key ) )
     {   
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value 
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
-    else if( KeyExists( key ) )
+    else if( entry != NULL )
     {
-        value = GetString( key );
+        value = entry->text;
     }
 }
 
 
 std::string Config::GetString( std::string key )
 {
-    std::map<std::string, std::string>::iterator i;
-    std::string value;
-
     if( values.empty( ) )
     {
         std::cerr << "Configuration has not been read yet." << std::endl;
         return "";
     }
 
-    i = values.find( key );
+    const ConfigValue *entry = Lookup( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
 
-
-    /*
-     *  Find returns map::end if the element is not found. We will use -1 as
-     *  the error code. Functions calling this function should check for -1
-     *  for possible configuration file problems.
-     *
-     *  If the key is found, return the second element (the key value).
-     */
-    if( i == values.end( ) )
-        value = "";
-    else
-        value = i->second;
-
-    return value;
+    return ( entry == NULL ) ? "" : entry->text;
 }
 
 
 void Config::SetString( std::string key, std::string value )
 {
+    InvalidateParams( );
     values.insert( std::pair<std::string, std::string>( key, value ) );
 }
 
 void Config::GetValueUL( std::string key, uint64_t& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    const ConfigValue *entry = Lookup( key );
+
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
-    else if( KeyExists( key ) )
+    else if( entry != NULL )
     {
-        value = GetValueUL( key );
+        value = entry->valueUL;
     }
 }
 
 uint64_t Config::GetValueUL( std::string key )
 {
-    std::map<std::string, std::string>::iterator i;
-    uint64_t value;
-
     if( values.empty( ) )
     {
         std::cerr << "Configuration has not been read yet." << std::endl;
         return std::numeric_limits<uint64_t>::max( );
     }
 
-    i = values.find( key );
+    const ConfigValue *entry = Lookup( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
 
     /*
-     *  Find returns map::end if the element is not found. We will use -1 as
-     *  the error code. Functions calling this function should check for -1
-     *  for possible configuration file problems.
-     *
-     *  If the key is found, return the second element (the key value).
+     *  A missing key reads as -1. Functions calling this function should
+     *  check for -1 for possible configuration file problems.
      */
-    if( i == values.end( ) )
-        value = std::numeric_limits<uint64_t>::max( );
-    else
-        value = strtoul( i->second.c_str( ), NULL, 10 );
-
-    return value;
+    return ( entry == NULL ) ? std::numeric_limits<uint64_t>::max( ) 
+                             : entry->valueUL;
 }
 
 void Config::GetValue( std::string key, int& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    const ConfigValue *entry = Lookup( key );
+
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
-    else if( KeyExists( key ) )
+    else if( entry != NULL )
     {
-        value = GetValue( key );
+        value = entry->value;
     }
 }
 
 int Config::GetValue( std::string key )
 {
-    std::map<std::string, std::string>::iterator i;
-    int value;
-
     if( values.empty( ) )
     {
         std::cerr << "Configuration has not been read yet." << std::endl;
         return -1;
     }
 
-    i = values.find( key );
+    const ConfigValue *entry = Lookup( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
 
     /*
-     *  Find returns map::end if the element is not found. We will use -1 as
-     *  the error code. Functions calling this function should check for -1
-     *  for possible configuration file problems.
-     *
-     *  If the key is found, return the second element (the key value).
+     *  A missing key reads as -1. Functions calling this function should
+     *  check for -1 for possible configuration file problems.
      */
-    if( i == values.end( ) )
-        value = -1;
-    else
-        value = atoi( i->second.c_str( ) );
-
-    return value;
+    return ( entry == NULL ) ? -1 : entry->value;
 }
 
 void Config::SetValue( std::string key, std::string value )
 {
     std::map<std::string, std::string>::iterator i;
 
+    InvalidateParams( );
+
+    /* Hooks may be added from the command line as in the config file. */
+    if( key == "AddHook" )
+    {
+        hookList.push_back( value );
+        return;
+    }
+
     i = values.find( key );
 
     if( i != values.end( ) )
@@ -361,86 +574,77 @@ void Config::SetValue( std::string key, std::string value )
 
 void Config::GetEnergy( std::string key, double& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    const ConfigValue *entry = Lookup( key );
+
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
-    else if( KeyExists( key ) )
+    else if( entry != NULL )
     {
-        value = GetEnergy( key );
+        value = entry->energy;
     }
 }
 
 double Config::GetEnergy( std::string key )
 {
-    std::map<std::string, std::string>::iterator i;
-    double value;
-
     if( values.empty( ) )
     {
         std::cerr << "Configuration has not been read yet." << std::endl;
         return -1;
     }
 
-    i = values.find( key );
+    const ConfigValue *entry = Lookup( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1.0' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
 
     /*
-     *  Find returns map::end if the element is not found. We will use -1 as
-     *  the error code. Functions calling this function should check for -1
-     *  for possible configuration file problems.
-     *
-     *  If the key is found, return the second element (the key value).
+     *  A missing key reads as -1. Functions calling this function should
+     *  check for -1 for possible configuration file problems.
      */
-    if( i == values.end( ) )
-        value = -1.0;
-    else
-        value = (double)atof( i->second.c_str( ) );
-
-    return value;
+    return ( entry == NULL ) ? -1.0 : entry->energy;
 }
 
 void Config::SetEnergy( std::string key, std::string energy )
 {
+    InvalidateParams( );
     values.insert( std::pair<std::string, std::string>( key, energy ) );
 }
 
 void Config::GetBool( std::string key, bool& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    const ConfigValue *entry = Lookup( key );
+
+    if( entry == NULL && !warned.count( key ) )
     {
         std::string defaultValue = (value ? "true" : "false");
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << defaultValue
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
-    else if( KeyExists( key ) )
+    else if( entry != NULL )
     {
-        value = GetBool( key );
+        value = entry->flag;
     }
 }
 
 bool Config::GetBool( std::string key )
 {
-    bool rv = false;
+    const ConfigValue *entry = Lookup( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( entry == NULL && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using 'false' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
     }
 
-    if( KeyExists( key ) && GetString( key ) == "true" )
-        rv = true;
-
-    return rv;
+    return ( entry != NULL && entry->flag );
 }
 
 void Config::SetBool( std::string key, bool value )
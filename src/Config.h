@@ -38,12 +38,69 @@
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
 #include <fstream>
+#include <stdint.h>
 
 #include "src/SimInterface.h"
 
 namespace NVM {
 
+class Params;
+
+/*
+ *  A config value with every conversion done once, at compile time, so a
+ *  lookup never parses the string again. The conversions match the ones
+ *  Config has always used (strtoul, atoi, atof and == "true").
+ */
+struct ConfigValue
+{
+    std::string text;
+    uint64_t valueUL;
+    int value;
+    double energy;
+    bool flag;
+};
+
+typedef uint32_t ConfigKey;
+
+/*
+ *  Immutable, typed snapshot of a Config. Keys are interned to dense ids so
+ *  code that reads a key repeatedly can resolve it once and index the table
+ *  from then on.
+ */
+class CompiledConfig
+{
+  public:
+    static const ConfigKey InvalidKey;
+
+    CompiledConfig( const std::map<std::string, std::string>& values );
+
+    ConfigKey Intern( const std::string& key ) const;
+    bool Has( ConfigKey key ) const { return key < entries.size( ); }
+    const ConfigValue& Get( ConfigKey key ) const { return entries[key]; }
+    const std::string& KeyName( ConfigKey key ) const { return names[key]; }
+    size_t Size( ) const { return entries.size( ); }
+
+  private:
+    std::unordered_map<std::string, ConfigKey> index;
+    std::vector<std::string> names;
+    std::vector<ConfigValue> entries;
+};
+
+/* 
+ *  Names of the keys that were looked up. Shared by a config and every copy
+ *  made from it, which may be used from different threads.
+ */
+struct ConfigUsage
+{
+    std::mutex lock;
+    std::unordered_set<std::string> keys;
+};
+
 class Config 
 {
   public:
@@ -75,6 +132,15 @@ class Config
 
     bool KeyExists( std::string key );
 
+    /* Read-only Params parsed from this config, shared by all its users. */
+    Params *GetParams( );
+
+    /* Typed key table for this config; rebuilt lazily after any change. */
+    const CompiledConfig *Compile( );
+
+    /* Report keys that were set but never read by anything. */
+    void CheckKeys( );
+
     std::vector<std::string>& GetHooks( );
 
     void Print( );
@@ -97,6 +163,15 @@ class Config
     SimInterface *simPtr;
     std::ofstream debugLogFile;
     bool useDebugLog;
+    Params *params;
+    std::vector<Params *> staleParams;
+    CompiledConfig *compiled;
+    std::vector<CompiledConfig *> staleCompiled;
+    std::shared_ptr<ConfigUsage> queried;
+    bool recordKeys;
+
+    const ConfigValue *Lookup( const std::string& key );
+    void InvalidateParams( );
 
 };
 
@@ -55,8 +55,18 @@ class DataEncoder : public NVMObject
     virtual ncycle_t Read( NVMainRequest *request );
     virtual ncycle_t Write( NVMainRequest *request );
 
+    /* 
+     *  Whether only the cells that differ from the old data are programmed.
+     *  Write() leaves the stored form of the new and old data in the request.
+     */
+    virtual bool DifferentialWrite( ) { return false; }
+
     virtual void PrintStats( ) { }
 
+    /* Saved with the owning subarray's checkpoint. */
+    virtual void WriteCheckpoint( CheckpointWriter& ) { }
+    virtual void ReadCheckpoint( CheckpointReader& ) { }
+
     virtual void Cycle( ncycle_t steps );
 
 };
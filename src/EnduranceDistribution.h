@@ -35,6 +35,7 @@
 #define __ENDURANCEDISTRIBUTION_H__
 
 #include "src/Config.h"
+#include "src/Checkpoint.h"
 
 namespace NVM {
 
@@ -46,6 +47,12 @@ class EnduranceDistribution
 
      virtual uint64_t GetEndurance( ) = 0;
 
+     /* Distributions that draw random numbers use their own stream. */
+     virtual void SetSeed( unsigned int /*seed*/ ) { }
+
+     virtual void WriteCheckpoint( CheckpointWriter& ) { }
+     virtual void ReadCheckpoint( CheckpointReader& ) { }
+
 };
 
 };
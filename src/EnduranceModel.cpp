@@ -34,6 +34,7 @@
 #include "src/EnduranceModel.h"
 #include "Endurance/EnduranceDistributionFactory.h"
 #include "src/FaultModel.h"
+#include "include/NVMHelpers.h"
 #include <iostream>
 #include <limits>
 
@@ -41,7 +42,9 @@ using namespace NVM;
 
 EnduranceModel::EnduranceModel( )
 {
-    life.clear( );
+    lifeCells = 0;
+    lifeTotal = 0;
+    lifeWorst = std::numeric_limits< uint64_t >::max( );
 
     granularity = 0;
 }
@@ -50,43 +53,37 @@ void EnduranceModel::SetConfig( Config *config, bool /*createChildren*/ )
 {
     enduranceDist = EnduranceDistributionFactory::CreateEnduranceDistribution( 
             config->GetString( "EnduranceDist" ), config );
+    if( enduranceDist != NULL )
+        enduranceDist->SetSeed( MakeSeed( config->GetParams( )->RandomSeed, StatName( ) ) );
+
+    /* One file per model, named after the owning subarray. */
+    if( config->KeyExists( "EnduranceBackingFile" ) )
+        life.SetBackingFile( config->GetString( "EnduranceBackingFile" ) 
+                             + "." + StatName( ) );
 }
 
 /*
- *  Finds the worst life in the life map. If you do not use the life
- *  map, you will need to overload this function to return the worst
- *  case life for statistics reporting.
+ *  Returns the worst life in the life store. The life of a cell only goes
+ *  down, so DecrementLife keeps the minimum as it goes. If you do not use
+ *  the life store, you will need to overload this function to return the
+ *  worst case life for statistics reporting.
  */
 uint64_t EnduranceModel::GetWorstLife( )
 {
-    std::map<uint64_t, uint64_t>::iterator i;
-    uint64_t min = std::numeric_limits< uint64_t >::max( );
-
-    for( i = life.begin( ); i != life.end( ); i++ )
-    {
-        if( i->second < min )
-            min = i->second;
-    }
-
-    return min;
+    return lifeWorst;
 }
 
 /*
- *  Finds the worst life in the life map. If you do not use the life
- *  map, you will need to overload this function to return the worst
- *  case life for statistics reporting.
+ *  Returns the average life in the life store from the running total kept
+ *  by DecrementLife. If you do not use the life store, you will need to
+ *  overload this function to return the average life for statistics.
  */
 uint64_t EnduranceModel::GetAverageLife( )
 {
-    std::map<uint64_t, uint64_t>::iterator i;
-    uint64_t total = 0;
     uint64_t average = 0;
 
-    for( i = life.begin( ); i != life.end( ); i++ )
-        total += i->second;
-
-    if( life.size( ) != 0 )
-        average = total / life.size( );
+    if( lifeCells != 0 )
+        average = lifeTotal / lifeCells;
     else
         average = 0;
 
@@ -95,36 +92,43 @@ uint64_t EnduranceModel::GetAverageLife( )
 
 bool EnduranceModel::DecrementLife( uint64_t addr )
 {
-    std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
+    uint32_t *counter = life.GetCounter( addr, true );
     bool rv = true;
 
-    if( i == life.end( ) )
+    if( *counter == 0 )
     {
-          /* Generate a random number using the specified distribution */
-          life.insert( std::pair<uint64_t, uint64_t>( addr, enduranceDist->GetEndurance( ) ) );
+        /* Generate a random number using the specified distribution */
+        *counter = LifeStore::Encode( enduranceDist->GetEndurance( ) );
+        lifeCells++;
+        lifeTotal += LifeStore::Decode( *counter );
     }
     else
     {
         /* If the life is 0, leave it at that.  */
-        if( i->second != 0 )
+        if( LifeStore::Decode( *counter ) != 0 )
         {
-            i->second = i->second - 1;
+            *counter = *counter - 1;
+            lifeTotal--;
         }
         else
         {
+            failedUnits.push_back( addr );
             rv = false;
         }
     }
 
+    if( LifeStore::Decode( *counter ) < lifeWorst )
+        lifeWorst = LifeStore::Decode( *counter );
+
     return rv;
 }
 
 bool EnduranceModel::IsDead( uint64_t addr )
 {
-    std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
+    uint32_t *counter = life.GetCounter( addr, false );
     bool rv = false;
 
-    if( i != life.end( ) && i->second == 0 )
+    if( counter != NULL && *counter != 0 && LifeStore::Decode( *counter ) == 0 )
     {
         rv = true;
     }
@@ -147,3 +151,66 @@ uint64_t EnduranceModel::GetGranularity( )
 void EnduranceModel::Cycle( ncycle_t )
 {
 }
+
+/*
+ *  Only the cells written so far have a life entry. Lives are drawn from the
+ *  distribution on first write, and the random sequence itself is not saved.
+ *  Entries are (key, life) pairs, the layout a std::map of them was saved in.
+ */
+void EnduranceModel::WriteCheckpoint( CheckpointWriter& writer )
+{
+    writer.Write( lifeCells );
+
+    for( uint64_t i = 0; i < life.GetPageCount( ); i++ )
+    {
+        uint64_t firstKey;
+        uint32_t *page = life.GetPage( i, &firstKey );
+
+        for( uint64_t j = 0; j < LifeStore::pageEntries; j++ )
+        {
+            if( page[j] != 0 )
+            {
+                writer.Write( firstKey + j );
+                writer.Write( LifeStore::Decode( page[j] ) );
+            }
+        }
+    }
+
+    writer.Write( enduranceDist != NULL );
+    if( enduranceDist != NULL )
+        enduranceDist->WriteCheckpoint( writer );
+}
+
+void EnduranceModel::ReadCheckpoint( CheckpointReader& reader )
+{
+    uint64_t count;
+
+    life.Clear( );
+    reader.Read( count );
+
+    lifeTotal = 0;
+    lifeWorst = std::numeric_limits< uint64_t >::max( );
+
+    for( uint64_t i = 0; i < count; i++ )
+    {
+        uint64_t key, cellLife;
+
+        reader.Read( key );
+        reader.Read( cellLife );
+        *life.GetCounter( key, true ) = LifeStore::Encode( cellLife );
+
+        cellLife = LifeStore::Decode( LifeStore::Encode( cellLife ) );
+        lifeTotal += cellLife;
+        if( cellLife < lifeWorst )
+            lifeWorst = cellLife;
+    }
+
+    lifeCells = count;
+
+    bool hasDist;
+
+    reader.Read( hasDist );
+    reader.Expect( hasDist, enduranceDist != NULL, "an endurance distribution" );
+    if( hasDist )
+        enduranceDist->ReadCheckpoint( reader );
+}
@@ -36,6 +36,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdint.h>
 #include "src/Config.h"
 #include "src/Params.h"
@@ -44,6 +45,7 @@
 #include "include/NVMDataBlock.h"
 #include "include/NVMAddress.h"
 #include "src/FaultModel.h"
+#include "src/LifeStore.h"
 
 namespace NVM {
 
@@ -65,13 +67,25 @@ class EnduranceModel : public NVMObject
     uint64_t GetWorstLife( );
     uint64_t GetAverageLife( );
 
+    /* Life keys of the worn-out units written since the last clear. */
+    const std::vector<uint64_t>& GetFailedUnits( ) { return failedUnits; }
+    void ClearFailedUnits( ) { failedUnits.clear( ); }
+
     virtual void PrintStats( ) { }
 
+    /* Saved with the owning subarray's checkpoint. */
+    virtual void WriteCheckpoint( CheckpointWriter& writer );
+    virtual void ReadCheckpoint( CheckpointReader& reader );
+
     void Cycle( ncycle_t steps );
 
   protected:
     EnduranceDistribution *enduranceDist;
-    std::map<uint64_t, uint64_t> life;
+    LifeStore life;
+    uint64_t lifeCells;
+    uint64_t lifeTotal;
+    uint64_t lifeWorst;
+    std::vector<uint64_t> failedUnits;
     
     bool DecrementLife( uint64_t addr );
     bool IsDead( uint64_t addr );
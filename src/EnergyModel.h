@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_ENERGYMODEL_H__
+#define __NVM_ENERGYMODEL_H__
+
+#include <string>
+#include "src/Params.h"
+#include "include/NVMTypes.h"
+#include "include/NVMainRequest.h"
+
+namespace NVM {
+
+/* Dynamic energy of one command in one bank. */
+enum EnergyEvent
+{
+    ENERGY_ACTIVATE,
+    ENERGY_READ,
+    ENERGY_WRITE,
+    ENERGY_WRITE_BIT,   /* Saved per unchanged bit when not writing all bits */
+    ENERGY_REFRESH,
+    ENERGY_EVENT_COUNT
+};
+
+/* Background energy per cycle, by rank power state. */
+enum BackgroundState
+{
+    BACKGROUND_ACTIVE_POWERDOWN,
+    BACKGROUND_PRECHARGE_POWERDOWN_FAST,
+    BACKGROUND_PRECHARGE_POWERDOWN_SLOW,
+    BACKGROUND_ACTIVE_STANDBY,
+    BACKGROUND_PRECHARGE_STANDBY,
+    BACKGROUND_STATE_COUNT
+};
+
+/*
+ *  Energy accounting policy selected by the EnergyModel key. The model is
+ *  created once per component in SetConfig and computes per-command and
+ *  per-state energies up front, so the hot paths only index a table.
+ */
+class EnergyModel
+{
+  public:
+    EnergyModel( );
+    virtual ~EnergyModel( ) { }
+
+    virtual void SetParams( Params *params );
+
+    /* Unit of the energies, as printed in the stats. */
+    virtual std::string GetUnit( ) = 0;
+    /* IDD current based models account per device and integrate over cycles. */
+    virtual bool IsCurrentBased( ) = 0;
+
+    double GetEventEnergy( EnergyEvent event ) { return eventEnergy[event]; }
+    /* For current based models this is the energy of a single device. */
+    double GetBackgroundEnergy( BackgroundState state ) { return backgroundEnergy[state]; }
+
+    /* Cell programming energy of one line with the given RESET and SET cells. */
+    virtual double GetCellWriteEnergy( ncounter_t resetCells, ncounter_t setCells,
+                                       bool uniformWrites ) = 0;
+
+    /* Dynamic energy of a CIM operation (per-op PIM energy hook). */
+    virtual double GetCIMEnergy( NVMainRequest *request ) = 0;
+
+  protected:
+    Params *p;
+
+    double eventEnergy[ENERGY_EVENT_COUNT];
+    double backgroundEnergy[BACKGROUND_STATE_COUNT];
+};
+
+};
+
+#endif
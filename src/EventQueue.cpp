@@ -163,7 +163,8 @@ void EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
 
         for( it = eventList.begin(); it != eventList.end(); it++ )
         {
-            if( (*it)->GetPriority( ) > priority )
+            /* Events already processed this cycle are cleared. */
+            if( (*it) != NULL && (*it)->GetPriority( ) > priority )
             {
                 eventList.insert( it, event );
                 inserted = true;
@@ -195,6 +196,23 @@ void EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
 }
 
 
+/* Hooks are not children of the modules they hook, so they pass their own wrapper. */
+void EventQueue::InsertCallback( NVMObject_hook *recipient, CallbackPtr method,
+                                 ncycle_t when, void *data, int priority )
+{
+    Event *event = new Event( );
+
+    event->SetType( EventCallback );
+    event->SetRecipient( recipient );
+    event->SetData( data );
+    event->SetCycle( when );
+    event->SetPriority( priority );
+    event->SetCallback( method );
+
+    InsertEvent( event, when, priority );
+}
+
+
 bool EventQueue::RemoveEvent( Event *event, ncycle_t when )
 {
     bool rv = false;
@@ -272,7 +290,8 @@ Event *EventQueue::FindEvent( EventType type, NVMObject_hook *recipient, NVMainR
         EventList::const_iterator it;
         for( it = eventList.begin(); it != eventList.end(); it++ )
         {
-            if( (*it)->GetType( ) == type && (*it)->GetRecipient( ) == recipient
+            if( (*it) != NULL
+                && (*it)->GetType( ) == type && (*it)->GetRecipient( ) == recipient
                 && (*it)->GetRequest( ) == req )
             {
                 rv = (*it);
@@ -294,7 +313,8 @@ Event *EventQueue::FindCallback( NVMObject *recipient, CallbackPtr method, ncycl
         EventList::const_iterator it;
         for( it = eventList.begin(); it != eventList.end(); it++ )
         {
-            if( (*it)->GetRecipient()->GetTrampoline() == recipient
+            if( (*it) != NULL
+                && (*it)->GetRecipient()->GetTrampoline() == recipient
                 && (*it)->GetCallback() == method
                 && (*it)->GetData() == data 
                 && (*it)->GetPriority() == priority )
@@ -309,6 +329,27 @@ Event *EventQueue::FindCallback( NVMObject *recipient, CallbackPtr method, ncycl
 }
 
 
+void EventQueue::FindCallbacks( NVMObject *recipient, CallbackPtr method, 
+                                std::vector<Event *>& events ) const
+{
+    std::map<ncycle_t, EventList>::const_iterator mit;
+    EventList::const_iterator it;
+
+    for( mit = eventMap.begin( ); mit != eventMap.end( ); mit++ )
+    {
+        for( it = mit->second.begin( ); it != mit->second.end( ); it++ )
+        {
+            if( (*it) != NULL && (*it)->GetType( ) == EventCallback 
+                && (*it)->GetRecipient( )->GetTrampoline( ) == recipient
+                && (*it)->GetCallback( ) == method )
+            {
+                events.push_back( *it );
+            }
+        }
+    }
+}
+
+
 void EventQueue::Loop( )
 {
     /* 
@@ -397,8 +438,12 @@ void EventQueue::Process( )
                 break;
         }
 
-        /* Free event data */
+        /* 
+         *  Free event data. The entry stays in the list until the loop ends,
+         *  so clear it for requests enqueued while this cycle is processed.
+         */
         delete (*it);
+        (*it) = NULL;
     }
 
     eventMap.erase( nextEventCycle );
@@ -442,6 +487,34 @@ void EventQueue::SetCurrentCycle( ncycle_t curCycle )
     currentCycle = curCycle;
 }
 
+ncycle_t EventQueue::GetLastEventCycle( )
+{
+    return lastEventCycle;
+}
+
+void EventQueue::RestoreCycles( ncycle_t curCycle, ncycle_t lastEvent )
+{
+    std::map< ncycle_t, EventList > shifted;
+    std::map< ncycle_t, EventList >::iterator mit;
+    EventList::iterator it;
+    ncycle_t delay = curCycle - currentCycle;
+
+    for( mit = eventMap.begin( ); mit != eventMap.end( ); mit++ )
+    {
+        for( it = mit->second.begin( ); it != mit->second.end( ); it++ )
+            (*it)->SetCycle( mit->first + delay );
+
+        shifted[mit->first + delay].swap( mit->second );
+    }
+
+    eventMap.swap( shifted );
+
+    currentCycle = curCycle;
+    lastEventCycle = lastEvent;
+    nextEventCycle = eventMap.empty( ) ? std::numeric_limits<ncycle_t>::max( )
+                                       : eventMap.begin( )->first;
+}
+
 
 GlobalEventQueue::GlobalEventQueue( )
 {
@@ -553,6 +626,11 @@ ncycle_t GlobalEventQueue::GetCurrentCycle( )
     return currentCycle;
 }
 
+void GlobalEventQueue::SetCurrentCycle( ncycle_t curCycle )
+{
+    currentCycle = curCycle;
+}
+
 void GlobalEventQueue::Sync( )
 {
     std::map<EventQueue *, double>::const_iterator iter;
@@ -104,11 +104,14 @@ class EventQueue
     void InsertEvent( Event *event, ncycle_t when, int priority = 0 );
 
     void InsertCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 );
+    void InsertCallback( NVMObject_hook *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 );
 
     Event *FindEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const;
     Event *FindEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const;
 
     Event *FindCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 ) const;
+    /* All pending callbacks of recipient to method, at any time. */
+    void FindCallbacks( NVMObject *recipient, CallbackPtr method, std::vector<Event *>& events ) const;
 
     bool RemoveEvent( Event *event, ncycle_t when );
 
@@ -123,6 +126,13 @@ class EventQueue
     ncycle_t GetCurrentCycle( );
     void SetCurrentCycle( ncycle_t curCycle );
 
+    /* 
+     *  Checkpoint restore: jump to a saved time. Pending events, which were
+     *  scheduled relative to the old time, are delayed by the same amount.
+     */
+    ncycle_t GetLastEventCycle( );
+    void RestoreCycles( ncycle_t curCycle, ncycle_t lastEvent );
+
   private:
     ncycle_t nextEventCycle;
     ncycle_t lastEventCycle;
@@ -147,6 +157,7 @@ class GlobalEventQueue
 
     ncycle_t GetNextEvent( EventQueue **eq = NULL );
     ncycle_t GetCurrentCycle( );
+    void SetCurrentCycle( ncycle_t curCycle );
 
   private:
     ncycle_t currentCycle;
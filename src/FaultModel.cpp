@@ -54,7 +54,7 @@ Config *FaultModel::GetConfig( )
     return config;
 }
 
-bool FaultModel::Fault( NVMAddress /*faultAddr*/ )
+bool FaultModel::Fault( NVMAddress /*faultAddr*/, uint64_t /*faultUnit*/ )
 {
     /*
      *  Default to no hard-error modelling, therefore we can't
@@ -63,6 +63,16 @@ bool FaultModel::Fault( NVMAddress /*faultAddr*/ )
     return false;
 }
 
+ncycle_t FaultModel::Read( NVMainRequest * /*request*/ )
+{
+    return 0;
+}
+
+ncycle_t FaultModel::Write( NVMainRequest * /*request*/ )
+{
+    return 0;
+}
+
 
 void FaultModel::Cycle( ncycle_t )
 {
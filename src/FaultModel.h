@@ -36,6 +36,7 @@
 
 #include "src/Config.h"
 #include "src/NVMObject.h"
+#include "src/Checkpoint.h"
 #include "include/NVMAddress.h"
 
 namespace NVM {
@@ -46,14 +47,25 @@ class FaultModel : public NVMObject
 {
   public:
     FaultModel( );
-    ~FaultModel ( );
+    virtual ~FaultModel ( );
 
-    /* Fault returns true if the fault could be fixed. */
-    virtual bool Fault( NVMAddress faultAddr ); 
+    /* 
+     *  Fault returns true if the fault could be fixed. The faultUnit is the
+     *  endurance model's life key of the unit that wore out at faultAddr.
+     */
+    virtual bool Fault( NVMAddress faultAddr, uint64_t faultUnit ); 
+
+    /* Additional cycles needed to correct the data of an access. */
+    virtual ncycle_t Read( NVMainRequest *request );
+    virtual ncycle_t Write( NVMainRequest *request );
 
     virtual void SetConfig( Config *conf, bool createChildren = true );
     Config *GetConfig( );
 
+    /* Saved with the owning subarray's checkpoint. */
+    virtual void WriteCheckpoint( CheckpointWriter& ) { }
+    virtual void ReadCheckpoint( CheckpointReader& ) { }
+
     void Cycle( ncycle_t steps );
 
  protected:
@@ -0,0 +1,423 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/FunctionalMemory.h"
+#include "include/NVMHelpers.h"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace NVM;
+
+/* Minimum amount of memory reserved from the OS at once for pages. */
+static const uint64_t arenaChunkSize = 64ULL * 1024 * 1024;
+
+static uint64_t Log2( uint64_t value )
+{
+    uint64_t rv = 0;
+
+    while( value > 1 )
+    {
+        value >>= 1;
+        rv++;
+    }
+
+    return rv;
+}
+
+FunctionalMemory::FunctionalMemory( )
+{
+    lineSize = 64;
+    lineShift = 6;
+    pageSize = 4096;
+    pageShift = 12;
+    linesPerPage = pageSize / lineSize;
+    pageCount = 0;
+
+    cachedTableId = 0;
+    cachedTable = NULL;
+
+    backingFd = -1;
+    backingSize = 0;
+
+    chunkNext = NULL;
+    chunkLeft = 0;
+}
+
+FunctionalMemory::~FunctionalMemory( )
+{
+    PageDirectory::iterator it;
+
+    for( it = directory.begin( ); it != directory.end( ); ++it )
+    {
+        for( uint64_t entry = 0; entry < tableEntries; entry++ )
+            delete [] it->second[entry].valid;
+
+        delete [] it->second;
+    }
+
+    for( size_t chunk = 0; chunk < chunks.size( ); chunk++ )
+        munmap( chunks[chunk], chunkSizes[chunk] );
+
+    if( backingFd >= 0 )
+        close( backingFd );
+}
+
+void FunctionalMemory::Configure( uint64_t newLineSize, uint64_t newPageSize, 
+                                  std::string newBackingFile )
+{
+    /* The layout can not change once data was stored. */
+    if( pageCount != 0 )
+        return;
+
+    if( newLineSize == 0 || (newLineSize & (newLineSize - 1)) != 0 )
+    {
+        std::cerr << "NVMain Error: Functional memory line size " << newLineSize
+                  << " is not a power of two!" << std::endl;
+        exit(1);
+    }
+
+    if( newPageSize < newLineSize || (newPageSize & (newPageSize - 1)) != 0 )
+    {
+        std::cerr << "NVMain Error: FunctionalPageSize " << newPageSize
+                  << " must be a power of two of at least one line ("
+                  << newLineSize << " bytes)!" << std::endl;
+        exit(1);
+    }
+
+    lineSize = newLineSize;
+    lineShift = Log2( lineSize );
+    pageSize = newPageSize;
+    pageShift = Log2( pageSize );
+    linesPerPage = pageSize / lineSize;
+    backingFile = newBackingFile;
+}
+
+uint8_t *FunctionalMemory::MapChunk( uint64_t bytes )
+{
+    void *chunk;
+
+    if( !backingFile.empty( ) )
+    {
+        if( backingFd < 0 )
+            backingFd = OpenBackingFile( backingFile, "functional memory" );
+
+        if( ftruncate( backingFd, static_cast<off_t>(backingSize + bytes) ) != 0 )
+        {
+            std::cerr << "NVMain Error: Could not grow functional memory "
+                      << "backing file `" << backingFile << "'!" << std::endl;
+            exit(1);
+        }
+
+        chunk = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      backingFd, static_cast<off_t>(backingSize) );
+        backingSize += bytes;
+    }
+    else
+    {
+        /* Untouched pages of the chunk are never backed by host memory. */
+        chunk = mmap( NULL, bytes, PROT_READ | PROT_WRITE, 
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    }
+
+    if( chunk == MAP_FAILED )
+    {
+        std::cerr << "NVMain Error: Could not map " << bytes << " bytes of "
+                  << "functional memory!" << std::endl;
+        exit(1);
+    }
+
+    chunks.push_back( static_cast<uint8_t *>(chunk) );
+    chunkSizes.push_back( bytes );
+
+    return static_cast<uint8_t *>(chunk);
+}
+
+uint8_t *FunctionalMemory::AllocatePageData( )
+{
+    if( chunkLeft < pageSize )
+    {
+        uint64_t bytes = (pageSize > arenaChunkSize) ? pageSize : arenaChunkSize;
+
+        chunkNext = MapChunk( bytes );
+        chunkLeft = bytes;
+    }
+
+    uint8_t *data = chunkNext;
+
+    chunkNext += pageSize;
+    chunkLeft -= pageSize;
+    pageCount++;
+
+    return data;
+}
+
+FunctionalMemory::Page *FunctionalMemory::FindPage( uint64_t address, bool allocate )
+{
+    uint64_t pageNumber = address >> pageShift;
+    uint64_t tableId = pageNumber >> tableBits;
+    Page *table;
+
+    if( cachedTable != NULL && cachedTableId == tableId )
+    {
+        table = cachedTable;
+    }
+    else
+    {
+        PageDirectory::iterator it = directory.find( tableId );
+
+        if( it == directory.end( ) )
+        {
+            if( !allocate )
+                return NULL;
+
+            table = new Page[tableEntries];
+            for( uint64_t entry = 0; entry < tableEntries; entry++ )
+            {
+                table[entry].data = NULL;
+                table[entry].valid = NULL;
+            }
+
+            directory[tableId] = table;
+        }
+        else
+        {
+            table = it->second;
+        }
+
+        cachedTableId = tableId;
+        cachedTable = table;
+    }
+
+    Page *page = &table[pageNumber & (tableEntries - 1)];
+
+    if( page->data == NULL )
+    {
+        if( !allocate )
+            return NULL;
+
+        uint64_t validWords = (linesPerPage + 63) / 64;
+
+        page->data = AllocatePageData( );
+        page->valid = new uint64_t[validWords];
+        memset( page->valid, 0, validWords * sizeof(uint64_t) );
+    }
+
+    return page;
+}
+
+bool FunctionalMemory::IsValid( uint64_t address )
+{
+    Page *page = FindPage( address, false );
+
+    if( page == NULL )
+        return false;
+
+    uint64_t line = (address & (pageSize - 1)) >> lineShift;
+
+    return ( (page->valid[line / 64] >> (line % 64)) & 1 ) != 0;
+}
+
+uint8_t *FunctionalMemory::GetLine( uint64_t address )
+{
+    Page *page = FindPage( address, false );
+
+    if( page == NULL )
+        return NULL;
+
+    uint64_t line = (address & (pageSize - 1)) >> lineShift;
+
+    if( ( (page->valid[line / 64] >> (line % 64)) & 1 ) == 0 )
+        return NULL;
+
+    return page->data + (line << lineShift);
+}
+
+void FunctionalMemory::SetLine( uint64_t address, const uint8_t *data, uint64_t bytes )
+{
+    Page *page = FindPage( address, true );
+    uint64_t line = (address & (pageSize - 1)) >> lineShift;
+
+    if( data != NULL )
+        memcpy( page->data + (line << lineShift), data, 
+                (bytes < lineSize) ? bytes : lineSize );
+
+    page->valid[line / 64] |= 1ULL << (line % 64);
+}
+
+uint64_t FunctionalMemory::Read( uint64_t address, uint8_t *buffer, uint64_t bytes )
+{
+    uint64_t validLines = 0;
+
+    while( bytes > 0 )
+    {
+        uint64_t offset = address & (pageSize - 1);
+        uint64_t span = pageSize - offset;
+        Page *page = FindPage( address, false );
+
+        if( span > bytes )
+            span = bytes;
+
+        if( page == NULL )
+        {
+            memset( buffer, 0, span );
+        }
+        else
+        {
+            memcpy( buffer, page->data + offset, span );
+
+            uint64_t firstLine = offset >> lineShift;
+            uint64_t lastLine = (offset + span - 1) >> lineShift;
+
+            for( uint64_t line = firstLine; line <= lastLine; line++ )
+                validLines += (page->valid[line / 64] >> (line % 64)) & 1;
+        }
+
+        address += span;
+        buffer += span;
+        bytes -= span;
+    }
+
+    return validLines;
+}
+
+void FunctionalMemory::InvalidateLine( uint64_t address )
+{
+    Page *page = FindPage( address, false );
+
+    if( page == NULL )
+        return;
+
+    uint64_t line = (address & (pageSize - 1)) >> lineShift;
+
+    page->valid[line / 64] &= ~(1ULL << (line % 64));
+}
+
+void FunctionalMemory::Move( uint64_t source, uint64_t dest, uint64_t bytes )
+{
+    assert( (source & (lineSize - 1)) == 0 && (dest & (lineSize - 1)) == 0 );
+
+    for( uint64_t offset = 0; offset < bytes; offset += lineSize )
+    {
+        uint8_t *line = GetLine( source + offset );
+
+        if( line != NULL )
+        {
+            SetLine( dest + offset, line, lineSize );
+            InvalidateLine( source + offset );
+        }
+        else
+        {
+            InvalidateLine( dest + offset );
+        }
+    }
+}
+
+void FunctionalMemory::WriteCheckpoint( CheckpointWriter& writer )
+{
+    PageDirectory::iterator it;
+    uint64_t validWords = (linesPerPage + 63) / 64;
+
+    writer.Write( lineSize );
+    writer.Write( pageSize );
+    writer.Write( pageCount );
+
+    for( it = directory.begin( ); it != directory.end( ); ++it )
+    {
+        for( uint64_t entry = 0; entry < tableEntries; entry++ )
+        {
+            Page *page = &it->second[entry];
+
+            if( page->data == NULL )
+                continue;
+
+            writer.Write( (it->first << tableBits) + entry );
+            writer.WriteArray( page->data, pageSize );
+            writer.WriteArray( page->valid, validWords );
+        }
+    }
+}
+
+void FunctionalMemory::ReadCheckpoint( CheckpointReader& reader )
+{
+    uint64_t savedLineSize, savedPageSize, savedPages;
+    uint64_t validWords = (linesPerPage + 63) / 64;
+
+    reader.Read( savedLineSize );
+    reader.Expect( savedLineSize, lineSize, "functional line size" );
+    reader.Read( savedPageSize );
+    reader.Expect( savedPageSize, pageSize, "functional page size" );
+    reader.Read( savedPages );
+
+    for( uint64_t pageIdx = 0; pageIdx < savedPages; pageIdx++ )
+    {
+        uint64_t pageNumber;
+
+        reader.Read( pageNumber );
+
+        Page *page = FindPage( pageNumber << pageShift, true );
+
+        reader.ReadArray( page->data, pageSize );
+        reader.ReadArray( page->valid, validWords );
+    }
+}
+
+void FunctionalMemory::Write( uint64_t address, const uint8_t *buffer, uint64_t bytes )
+{
+    while( bytes > 0 )
+    {
+        uint64_t offset = address & (pageSize - 1);
+        uint64_t span = pageSize - offset;
+        Page *page = FindPage( address, true );
+
+        if( span > bytes )
+            span = bytes;
+
+        memcpy( page->data + offset, buffer, span );
+
+        uint64_t firstLine = offset >> lineShift;
+        uint64_t lastLine = (offset + span - 1) >> lineShift;
+
+        for( uint64_t line = firstLine; line <= lastLine; line++ )
+            page->valid[line / 64] |= 1ULL << (line % 64);
+
+        address += span;
+        buffer += span;
+        bytes -= span;
+    }
+}
@@ -0,0 +1,133 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_FUNCTIONALMEMORY_H__
+#define __NVM_FUNCTIONALMEMORY_H__
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/Checkpoint.h"
+
+namespace NVM {
+
+/*
+ *  Sparse functional memory image used to hold the data of a simulation.
+ *
+ *  Lines are grouped into pages (4KB by default, or e.g. 2MB) which are
+ *  carved out of large arena chunks. Pages are found through a two-level
+ *  table: a hashed directory of page tables, each of which covers a fixed
+ *  number of consecutive pages, so line lookups are constant time. The last
+ *  directory entry used is cached for accesses within a region.
+ *
+ *  The arena is anonymous memory by default. If a backing file is given the
+ *  arena is mapped from that file instead, which allows images larger than
+ *  the physical memory of the host.
+ */
+class FunctionalMemory
+{
+  public:
+    FunctionalMemory( );
+    ~FunctionalMemory( );
+
+    void Configure( uint64_t lineSize, uint64_t pageSize, 
+                    std::string backingFile = "" );
+
+    /* Returns the line at address, or NULL if it was never written. */
+    uint8_t *GetLine( uint64_t address );
+    void SetLine( uint64_t address, const uint8_t *data, uint64_t bytes );
+    bool IsValid( uint64_t address );
+
+    /* 
+     *  Bulk access, e.g., for whole rows. Bytes that were never written
+     *  read as zero; Read returns the number of valid lines touched.
+     */
+    uint64_t Read( uint64_t address, uint8_t *buffer, uint64_t bytes );
+    void Write( uint64_t address, const uint8_t *buffer, uint64_t bytes );
+
+    /* 
+     *  Moves whole lines. Lines never written at the source are left invalid
+     *  at the destination, and the source lines are invalid afterwards.
+     */
+    void Move( uint64_t source, uint64_t dest, uint64_t bytes );
+
+    /* Saves the written pages; the layout must match on restore. */
+    void WriteCheckpoint( CheckpointWriter& writer );
+    void ReadCheckpoint( CheckpointReader& reader );
+
+    uint64_t GetLineSize( ) { return lineSize; }
+    uint64_t GetPageSize( ) { return pageSize; }
+    uint64_t GetPageCount( ) { return pageCount; }
+
+  private:
+    struct Page
+    {
+        uint8_t *data;
+        uint64_t *valid;
+    };
+
+    /* Pages covered by one page table in the directory. */
+    static const uint64_t tableBits = 9;
+    static const uint64_t tableEntries = 1ULL << tableBits;
+
+    typedef std::unordered_map<uint64_t, Page *> PageDirectory;
+
+    uint64_t lineSize, lineShift;
+    uint64_t pageSize, pageShift;
+    uint64_t linesPerPage;
+    uint64_t pageCount;
+
+    PageDirectory directory;
+    uint64_t cachedTableId;
+    Page *cachedTable;
+
+    std::string backingFile;
+    int backingFd;
+    uint64_t backingSize;
+
+    std::vector<uint8_t *> chunks;
+    std::vector<uint64_t> chunkSizes;
+    uint8_t *chunkNext;
+    uint64_t chunkLeft;
+
+    Page *FindPage( uint64_t address, bool allocate );
+    void InvalidateLine( uint64_t address );
+    uint8_t *AllocatePageData( );
+    uint8_t *MapChunk( uint64_t bytes );
+};
+
+};
+
+#endif
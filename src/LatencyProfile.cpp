@@ -0,0 +1,165 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/LatencyProfile.h"
+
+#include <sstream>
+
+using namespace NVM;
+
+namespace {
+
+const char *latencyClassNames[] = 
+{
+    "read",
+    "write",
+    "prefetch",
+    "NOT_IN_ARRAY",
+    "AND_IN_ARRAY",
+    "AND_IN_LATCH",
+    "OR_IN_LATCH",
+    "NAND_IN_LATCH",
+    "NOR_IN_LATCH",
+    "XOR_IN_LATCH"
+};
+
+}
+
+LatencyProfile::LatencyProfile( )
+{
+    stats = NULL;
+}
+
+LatencyProfile::~LatencyProfile( )
+{
+    std::map<ncounters_t, StatHistogram *>::iterator it;
+
+    for( it = threadLatency.begin( ); it != threadLatency.end( ); it++ )
+    {
+        delete it->second;
+    }
+}
+
+void LatencyProfile::RegisterStats( Stats *s, const std::string& o )
+{
+    stats = s;
+    owner = o;
+
+    for( int i = 0; i < LATENCY_CLASS_COUNT; i++ )
+    {
+        stats->addStat( &classLatency[i], owner, 
+                        std::string( "latency." ) + latencyClassNames[i], "" );
+    }
+
+    std::map<ncounters_t, StatHistogram *>::iterator it;
+
+    for( it = threadLatency.begin( ); it != threadLatency.end( ); it++ )
+    {
+        std::stringstream name;
+
+        name << "latency.thread" << it->first;
+        stats->addStat( it->second, owner, name.str( ), "" );
+    }
+}
+
+int LatencyProfile::GetClass( NVMainRequest *request )
+{
+    int rv = -1;
+    OpType cimOp = request->GetCIMOp( );
+
+    /* CIM requests travel through the controller as reads. */
+    if( request->isPrefetch )
+        rv = LATENCY_PREFETCH;
+    else if( cimOp != NOP )
+        rv = LATENCY_CIM + (cimOp - NOT_IN_ARRAY);
+    else if( request->type == READ || request->type == READ_PRECHARGE )
+        rv = LATENCY_READ;
+    else if( request->type == WRITE || request->type == WRITE_PRECHARGE )
+        rv = LATENCY_WRITE;
+
+    return rv;
+}
+
+StatHistogram *LatencyProfile::GetThreadLatency( ncounters_t threadId )
+{
+    std::map<ncounters_t, StatHistogram *>::iterator it = threadLatency.find( threadId );
+
+    if( it != threadLatency.end( ) )
+        return it->second;
+
+    StatHistogram *histogram = new StatHistogram( );
+    threadLatency[threadId] = histogram;
+
+    if( stats != NULL )
+    {
+        std::stringstream name;
+
+        name << "latency.thread" << threadId;
+        stats->addStat( histogram, owner, name.str( ), "" );
+    }
+
+    return histogram;
+}
+
+void LatencyProfile::Record( NVMainRequest *request, ncycle_t latency )
+{
+    int latencyClass = GetClass( request );
+
+    if( latencyClass < 0 )
+        return;
+
+    classLatency[latencyClass].Sample( latency );
+    GetThreadLatency( request->threadId )->Sample( latency );
+}
+
+void LatencyProfile::Merge( const LatencyProfile& other )
+{
+    for( int i = 0; i < LATENCY_CLASS_COUNT; i++ )
+        classLatency[i].Merge( other.classLatency[i] );
+
+    std::map<ncounters_t, StatHistogram *>::const_iterator it;
+
+    for( it = other.threadLatency.begin( ); it != other.threadLatency.end( ); it++ )
+        GetThreadLatency( it->first )->Merge( *(it->second) );
+}
+
+void LatencyProfile::Clear( )
+{
+    for( int i = 0; i < LATENCY_CLASS_COUNT; i++ )
+        classLatency[i].Clear( );
+
+    std::map<ncounters_t, StatHistogram *>::iterator it;
+
+    for( it = threadLatency.begin( ); it != threadLatency.end( ); it++ )
+        it->second->Clear( );
+}
@@ -0,0 +1,86 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_LATENCYPROFILE_H__
+#define __NVM_LATENCYPROFILE_H__
+
+#include <map>
+#include <string>
+
+#include "src/Stats.h"
+#include "include/NVMTypes.h"
+#include "include/NVMainRequest.h"
+
+namespace NVM {
+
+/*
+ *  Latency histograms for completed requests, one per request class (read,
+ *  write, prefetch and each CIM operation) and one per issuing thread. The
+ *  stats are named <owner>.latency.<class> and <owner>.latency.thread<N>.
+ *  Per-thread histograms are registered when a thread is first seen.
+ */
+class LatencyProfile
+{
+  public:
+    LatencyProfile( );
+    ~LatencyProfile( );
+
+    void RegisterStats( Stats *stats, const std::string& owner );
+
+    void Record( NVMainRequest *request, ncycle_t latency );
+    void Merge( const LatencyProfile& other );
+    void Clear( );
+
+  private:
+    enum
+    {
+        LATENCY_READ,
+        LATENCY_WRITE,
+        LATENCY_PREFETCH,
+        LATENCY_CIM,
+        LATENCY_CLASS_COUNT = LATENCY_CIM + CIM_OP_COUNT
+    };
+
+    StatHistogram classLatency[LATENCY_CLASS_COUNT];
+    std::map<ncounters_t, StatHistogram *> threadLatency;
+
+    Stats *stats;
+    std::string owner;
+
+    static int GetClass( NVMainRequest *request );
+    StatHistogram *GetThreadLatency( ncounters_t threadId );
+};
+
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/LifeStore.h"
+#include "include/NVMHelpers.h"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+using namespace NVM;
+
+/* Minimum amount of memory reserved from the OS at once for pages. */
+static const uint64_t arenaChunkSize = 16ULL * 1024 * 1024;
+
+static const uint64_t pageBytes = LifeStore::pageEntries * sizeof(uint32_t);
+
+LifeStore::LifeStore( )
+{
+    cachedTableId = 0;
+    cachedTable = NULL;
+
+    backingFd = -1;
+    backingSize = 0;
+
+    chunkNext = NULL;
+    chunkLeft = 0;
+}
+
+LifeStore::~LifeStore( )
+{
+    PageDirectory::iterator it;
+
+    for( it = directory.begin( ); it != directory.end( ); ++it )
+        delete [] it->second;
+
+    for( size_t chunk = 0; chunk < chunks.size( ); chunk++ )
+        munmap( chunks[chunk], chunkSizes[chunk] );
+
+    if( backingFd >= 0 )
+        close( backingFd );
+}
+
+void LifeStore::SetBackingFile( std::string file )
+{
+    backingFile = file;
+}
+
+uint32_t LifeStore::Encode( uint64_t life )
+{
+    uint64_t maxLife = std::numeric_limits<uint32_t>::max( ) - 1;
+
+    return static_cast<uint32_t>( (life < maxLife) ? life + 1 : maxLife + 1 );
+}
+
+uint8_t *LifeStore::MapChunk( uint64_t bytes )
+{
+    void *chunk;
+
+    if( !backingFile.empty( ) )
+    {
+        if( backingFd < 0 )
+            backingFd = OpenBackingFile( backingFile, "endurance life" );
+
+        if( ftruncate( backingFd, static_cast<off_t>(backingSize + bytes) ) != 0 )
+        {
+            std::cerr << "NVMain Error: Could not grow endurance life "
+                      << "backing file `" << backingFile << "'!" << std::endl;
+            exit(1);
+        }
+
+        chunk = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      backingFd, static_cast<off_t>(backingSize) );
+        backingSize += bytes;
+    }
+    else
+    {
+        /* Untouched pages of the chunk are never backed by host memory. */
+        chunk = mmap( NULL, bytes, PROT_READ | PROT_WRITE, 
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    }
+
+    if( chunk == MAP_FAILED )
+    {
+        std::cerr << "NVMain Error: Could not map " << bytes << " bytes of "
+                  << "endurance life counters!" << std::endl;
+        exit(1);
+    }
+
+    chunks.push_back( static_cast<uint8_t *>(chunk) );
+    chunkSizes.push_back( bytes );
+
+    return static_cast<uint8_t *>(chunk);
+}
+
+/* Fresh mappings are zero filled, i.e., every counter is never written. */
+uint32_t *LifeStore::AllocatePage( )
+{
+    if( chunkLeft < pageBytes )
+    {
+        chunkNext = MapChunk( arenaChunkSize );
+        chunkLeft = arenaChunkSize;
+    }
+
+    uint32_t *page = reinterpret_cast<uint32_t *>( chunkNext );
+
+    chunkNext += pageBytes;
+    chunkLeft -= pageBytes;
+
+    return page;
+}
+
+uint32_t *LifeStore::GetCounter( uint64_t key, bool allocate )
+{
+    uint64_t pageNumber = key >> pageBits;
+    uint64_t tableId = pageNumber >> tableBits;
+    uint32_t **table;
+
+    if( cachedTable != NULL && cachedTableId == tableId )
+    {
+        table = cachedTable;
+    }
+    else
+    {
+        PageDirectory::iterator it = directory.find( tableId );
+
+        if( it == directory.end( ) )
+        {
+            if( !allocate )
+                return NULL;
+
+            table = new uint32_t *[tableEntries]( );
+            directory[tableId] = table;
+        }
+        else
+        {
+            table = it->second;
+        }
+
+        cachedTableId = tableId;
+        cachedTable = table;
+    }
+
+    uint32_t *&page = table[pageNumber & (tableEntries - 1)];
+
+    if( page == NULL )
+    {
+        if( !allocate )
+            return NULL;
+
+        page = AllocatePage( );
+        pages.push_back( std::make_pair( pageNumber << pageBits, page ) );
+    }
+
+    return &page[key & (pageEntries - 1)];
+}
+
+uint32_t *LifeStore::GetPage( uint64_t index, uint64_t *firstKey )
+{
+    *firstKey = pages[index].first;
+
+    return pages[index].second;
+}
+
+void LifeStore::Clear( )
+{
+    for( size_t index = 0; index < pages.size( ); index++ )
+        memset( pages[index].second, 0, pageBytes );
+}
@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_LIFESTORE_H__
+#define __NVM_LIFESTORE_H__
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Remaining life of the cells tracked by an endurance model, stored as
+ *  32-bit counters indexed by the model's key (e.g., row * cells per row
+ *  + cell in the row).
+ *
+ *  Counters are grouped into pages which are allocated on first write, so
+ *  only written regions take memory. As in FunctionalMemory, pages are
+ *  found through a directory of page tables with the last table used
+ *  cached, so a lookup is a couple of array accesses. Pages come from
+ *  anonymous memory, or from a file if one is given.
+ *
+ *  A counter holds the life plus one. Zero therefore means the cell was
+ *  never written, which is what a freshly mapped page holds.
+ */
+class LifeStore
+{
+  public:
+    LifeStore( );
+    ~LifeStore( );
+
+    /* Must be called before the first counter is allocated. */
+    void SetBackingFile( std::string file );
+
+    /* Returns NULL if allocate is false and the page was never written. */
+    uint32_t *GetCounter( uint64_t key, bool allocate );
+
+    /* Counters with a stored life are never 0; life saturates at 2^32 - 2. */
+    static uint32_t Encode( uint64_t life );
+    static uint64_t Decode( uint32_t counter ) { return counter - 1; }
+
+    /* Allocated pages, in allocation order, for walking all counters. */
+    static const uint64_t pageBits = 12;
+    static const uint64_t pageEntries = 1ULL << pageBits;
+
+    uint64_t GetPageCount( ) { return pages.size( ); }
+    uint32_t *GetPage( uint64_t index, uint64_t *firstKey );
+
+    /* Resets every counter to never written, keeping the pages. */
+    void Clear( );
+
+  private:
+    /* Pages covered by one page table in the directory. */
+    static const uint64_t tableBits = 9;
+    static const uint64_t tableEntries = 1ULL << tableBits;
+
+    typedef std::map<uint64_t, uint32_t **> PageDirectory;
+
+    PageDirectory directory;
+    uint64_t cachedTableId;
+    uint32_t **cachedTable;
+
+    std::vector<std::pair<uint64_t, uint32_t *> > pages;
+
+    std::string backingFile;
+    int backingFd;
+    uint64_t backingSize;
+
+    std::vector<uint8_t *> chunks;
+    std::vector<uint64_t> chunkSizes;
+    uint8_t *chunkNext;
+    uint64_t chunkLeft;
+
+    uint32_t *AllocatePage( );
+    uint8_t *MapChunk( uint64_t bytes );
+};
+
+};
+
+#endif
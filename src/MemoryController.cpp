@@ -41,6 +41,8 @@
 #include "src/Rank.h"
 #include "src/SubArray.h"
 #include "include/NVMHelpers.h"
+#include "src/Tracing.h"
+#include "src/Checkpoint.h"
 
 #include <sstream>
 #include <cassert>
@@ -65,6 +67,7 @@ MemoryController::MemoryController( )
     lastCommandWake = 0;
     wakeupCount = 0;
     lastIssueCycle = 0;
+    latencyProfile = NULL;
 
     starvationThreshold = 4;
     subArrayNum = 1;
@@ -123,6 +126,7 @@ MemoryController::~MemoryController( )
     }
 
     delete [] delayedRefreshCounter;
+    delete latencyProfile;
 }
 
 void MemoryController::InitQueues( unsigned int numQueues )
@@ -204,13 +208,9 @@ void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
 
         if( GetEventQueue( )->FindEvent( EventCycle, this, NULL, nextWakeup ) == NULL )
         {
-            // added by MSON
-            if ( request->isCIM )
-            {
-                std::cout << "This command queue is empty, we can schedule a CIM transaction right away!" << std::endl;
-                std::cout << "queueId of CIM request: " << queueId << std::endl;
-                std::cout << "nextWakeup of CIM request: " << nextWakeup << std::endl;
-            }
+            if( request->isCIM )
+                NVM_TRACE( TRACE_CIM, TRACE_CIM_WAKEUP, nextWakeup, request, queueId );
+
             GetEventQueue( )->InsertEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
         }
     }
@@ -332,6 +332,12 @@ bool MemoryController::RequestComplete( NVMainRequest *request )
     }
     else
     {
+        if( latencyProfile != NULL )
+        {
+            latencyProfile->Record( request, GetEventQueue()->GetCurrentCycle() 
+                                             - request->arrivalCycle );
+        }
+
         return GetParent( )->RequestComplete( request );
     }
 
@@ -343,6 +349,24 @@ bool MemoryController::IsIssuable( NVMainRequest * /*request*/, FailReason * /*f
     return true;
 }
 
+/*
+ *  Atomic requests skip the queues and all timing; they are only passed down
+ *  so the subarrays can update their contents and wear, e.g., when a trace
+ *  is fast-forwarded. The row buffers are left as they are.
+ */
+bool MemoryController::IssueAtomic( NVMainRequest *request )
+{
+    /* Retranslate as Enqueue does so remapping decoders agree in both modes. */
+    ncounter_t channel, rank, bank, row, col, subarray;
+
+    GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
+                               &row, &col, &bank, &rank, &channel, &subarray );
+    channel = request->address.GetChannel( );
+    request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+
+    return GetChild( request )->IssueAtomic( request );
+}
+
 void MemoryController::SetMappingScheme( )
 {
     /* Configure common memory controller parameters. */
@@ -353,9 +377,10 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
 {
     this->config = conf;
 
-    Params *params = new Params( );
-    params->SetParams( conf );
-    SetParams( params );
+    SetParams( conf->GetParams( ) );
+
+    if( p->LatencyHistograms && latencyProfile == NULL )
+        latencyProfile = new LatencyProfile( );
     
     if( createChildren )
     {
@@ -574,6 +599,9 @@ void MemoryController::RegisterStats( )
 {
     AddStat(simulation_cycles);
     AddStat(wakeupCount);
+
+    if( latencyProfile != NULL )
+        latencyProfile->RegisterStats( GetStats( ), StatName( ) );
 }
 
 /* 
@@ -913,6 +941,184 @@ unsigned int MemoryController::GetID( )
     return this->id;
 }
 
+LatencyProfile *MemoryController::GetLatencyProfile( )
+{
+    return latencyProfile;
+}
+
+/* Requests waiting in the transaction and command queues. */
+ncounter_t MemoryController::GetQueueDepth( )
+{
+    ncounter_t depth = 0;
+
+    for( ncounter_t i = 0; i < transactionQueueCount; i++ )
+        depth += transactionQueues[i].size( );
+
+    for( ncounter_t i = 0; i < commandQueueCount; i++ )
+        depth += commandQueues[i].size( );
+
+    return depth;
+}
+
+/*
+ *  Checkpoints are only taken while the controller is idle, so the queues
+ *  are not saved. The refresh pulses are the only events with state of
+ *  their own; they are saved by the bank group they count down for.
+ */
+void MemoryController::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter writer( dir, StatName( ) );
+
+    if( GetQueueDepth( ) != 0 )
+    {
+        std::cerr << "NVMain Error: " << StatName( ) << " has " 
+            << GetQueueDepth( ) << " queued commands. Checkpoints can only "
+            << "be taken once all requests have drained." << std::endl;
+        exit(1);
+    }
+
+    writer.Write( p->RANKS );
+    writer.Write( p->BANKS );
+    writer.Write( subArrayNum );
+
+    writer.Write( lastCommandWake );
+    writer.Write( wakeupCount );
+    writer.Write( lastIssueCycle );
+    writer.Write( curQueue );
+    writer.Write( handledRefresh );
+    writer.Write( nextRefreshRank );
+    writer.Write( nextRefreshBank );
+    writer.WriteArray( rankPowerDown, p->RANKS );
+
+    for( ncounter_t i = 0; i < p->RANKS; i++ )
+    {
+        writer.WriteArray( activateQueued[i], p->BANKS );
+        writer.WriteArray( refreshQueued[i], p->BANKS );
+        writer.WriteArray( bankNeedRefresh[i], p->BANKS );
+
+        for( ncounter_t j = 0; j < p->BANKS; j++ )
+        {
+            writer.WriteArray( effectiveRow[i][j], subArrayNum );
+            writer.WriteArray( effectiveMuxedRow[i][j], subArrayNum );
+            writer.WriteArray( activeSubArray[i][j], subArrayNum );
+            writer.WriteArray( starvationCounter[i][j], subArrayNum );
+        }
+    }
+
+    if( p->UseRefresh )
+    {
+        std::vector<Event *> pulses;
+        std::vector<Event *>::iterator it;
+
+        for( ncounter_t i = 0; i < p->RANKS; i++ )
+            writer.WriteArray( delayedRefreshCounter[i], m_refreshBankNum );
+
+        GetEventQueue( )->FindCallbacks( this, 
+                (CallbackPtr)&MemoryController::RefreshCallback, pulses );
+
+        writer.Write( static_cast<uint64_t>( pulses.size( ) ) );
+        for( it = pulses.begin( ); it != pulses.end( ); it++ )
+        {
+            NVMainRequest *pulse = reinterpret_cast<NVMainRequest *>( (*it)->GetData( ) );
+            ncounter_t rank, bank;
+
+            pulse->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+            writer.Write( rank );
+            writer.Write( bank );
+            writer.Write( (*it)->GetCycle( ) );
+        }
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void MemoryController::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+    ncounter_t savedRanks, savedBanks, savedSubArrays;
+
+    reader.Read( savedRanks );
+    reader.Read( savedBanks );
+    reader.Read( savedSubArrays );
+    reader.Expect( savedRanks, p->RANKS, "ranks" );
+    reader.Expect( savedBanks, p->BANKS, "banks" );
+    reader.Expect( savedSubArrays, subArrayNum, "subarrays per bank" );
+
+    reader.Read( lastCommandWake );
+    reader.Read( wakeupCount );
+    reader.Read( lastIssueCycle );
+    reader.Read( curQueue );
+    reader.Read( handledRefresh );
+    reader.Read( nextRefreshRank );
+    reader.Read( nextRefreshBank );
+    reader.ReadArray( rankPowerDown, p->RANKS );
+
+    for( ncounter_t i = 0; i < p->RANKS; i++ )
+    {
+        reader.ReadArray( activateQueued[i], p->BANKS );
+        reader.ReadArray( refreshQueued[i], p->BANKS );
+        reader.ReadArray( bankNeedRefresh[i], p->BANKS );
+
+        for( ncounter_t j = 0; j < p->BANKS; j++ )
+        {
+            reader.ReadArray( effectiveRow[i][j], subArrayNum );
+            reader.ReadArray( effectiveMuxedRow[i][j], subArrayNum );
+            reader.ReadArray( activeSubArray[i][j], subArrayNum );
+            reader.ReadArray( starvationCounter[i][j], subArrayNum );
+        }
+    }
+
+    if( p->UseRefresh )
+    {
+        std::vector<Event *> pulses;
+        std::vector<Event *>::iterator it;
+        uint64_t savedPulses;
+
+        for( ncounter_t i = 0; i < p->RANKS; i++ )
+            reader.ReadArray( delayedRefreshCounter[i], m_refreshBankNum );
+
+        /* Move the pulses created by SetConfig to their saved countdowns. */
+        GetEventQueue( )->FindCallbacks( this, 
+                (CallbackPtr)&MemoryController::RefreshCallback, pulses );
+
+        reader.Read( savedPulses );
+        reader.Expect( savedPulses, pulses.size( ), "refresh pulses" );
+
+        for( uint64_t n = 0; n < savedPulses; n++ )
+        {
+            ncounter_t savedRank, savedBank;
+            ncycle_t when;
+
+            reader.Read( savedRank );
+            reader.Read( savedBank );
+            reader.Read( when );
+
+            for( it = pulses.begin( ); it != pulses.end( ); it++ )
+            {
+                NVMainRequest *pulse = reinterpret_cast<NVMainRequest *>( (*it)->GetData( ) );
+                ncounter_t rank, bank;
+
+                pulse->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+                if( rank == savedRank && bank == savedBank )
+                {
+                    GetEventQueue( )->RemoveEvent( *it, (*it)->GetCycle( ) );
+                    GetEventQueue( )->InsertCallback( this, 
+                                   (CallbackPtr)&MemoryController::RefreshCallback, 
+                                   when, reinterpret_cast<void*>(pulse), 
+                                   refreshPriority );
+                    delete (*it);
+                    pulses.erase( it );
+                    break;
+                }
+            }
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
+
 NVMainRequest *MemoryController::MakeCachedRequest( NVMainRequest *triggerRequest )
 {
     //FIXMEif (triggerRequest->isCIM)
@@ -943,6 +1149,7 @@ NVMainRequest *MemoryController::MakeCIMReadRequest( NVMainRequest *triggerReque
     cimreadRequest->isNAND_IN_LATCH = triggerRequest->isNAND_IN_LATCH;
     cimreadRequest->isNOR_IN_LATCH = triggerRequest->isNOR_IN_LATCH;
     cimreadRequest->isXOR_IN_LATCH = triggerRequest->isXOR_IN_LATCH;
+    cimreadRequest->cimOperandRows = triggerRequest->cimOperandRows;
     
     cimreadRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
     cimreadRequest->address = triggerRequest->address;
@@ -965,11 +1172,13 @@ NVMainRequest *MemoryController::MakeActivateRequest( NVMainRequest *triggerRequ
     activateRequest->isNAND_IN_LATCH = triggerRequest->isNAND_IN_LATCH;
     activateRequest->isNOR_IN_LATCH = triggerRequest->isNOR_IN_LATCH;
     activateRequest->isXOR_IN_LATCH = triggerRequest->isXOR_IN_LATCH;
+    activateRequest->cimOperandRows = triggerRequest->cimOperandRows;
     activateRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
     activateRequest->address = triggerRequest->address;
     activateRequest->owner = this;
-    // check the timing
-    std::cout << "ACTIVATE issueCycle: " << activateRequest->issueCycle << std::endl;
+
+    NVM_TRACE( TRACE_COMMAND, TRACE_MAKE_ACTIVATE, activateRequest->issueCycle, activateRequest, 0 );
+
     return activateRequest;
 }
 
@@ -1007,9 +1216,11 @@ NVMainRequest *MemoryController::MakePrechargeRequest( NVMainRequest *triggerReq
     prechargeRequest->isNAND_IN_LATCH = triggerRequest->isNAND_IN_LATCH;
     prechargeRequest->isNOR_IN_LATCH = triggerRequest->isNOR_IN_LATCH;
     prechargeRequest->isXOR_IN_LATCH = triggerRequest->isXOR_IN_LATCH;
+    prechargeRequest->cimOperandRows = triggerRequest->cimOperandRows;
     prechargeRequest->owner = this;
-    // check the timing
-    std::cout << "PRECHARGE issueCycle: " << prechargeRequest->issueCycle << std::endl;
+
+    NVM_TRACE( TRACE_COMMAND, TRACE_MAKE_PRECHARGE, prechargeRequest->issueCycle, prechargeRequest, 0 );
+
     return prechargeRequest;
 }
 
@@ -1630,12 +1841,8 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
     ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
     ncounter_t queueId = GetCommandQueueId( req->address );
     
-    // added by MSON
-    if (req->isCIM)
-    {
-        std::cout << "rank: " << rank << " bank: " << bank << " row: " << row << " subarray: " << subarray << " col: " << col << std::endl;
-        std::cout << "muxLevel: " << muxLevel << std::endl;
-    }
+    if( req->isCIM )
+        NVM_TRACE( TRACE_CIM, TRACE_CIM_DECODE, GetEventQueue()->GetCurrentCycle(), req, muxLevel );
 
     /*
      *  If the request is somehow accessible (e.g., via caching, etc), but the
@@ -1655,11 +1862,8 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
         {
             req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-            // added by MSON
-            if ( req->isCIM )
-            {
-                std::cout << "first if received CIM request!" << std::endl;
-            }
+            if( req->isCIM )
+                NVM_TRACE( TRACE_CIM, TRACE_CIM_CACHED, req->issueCycle, req, queueId );
             
             // Update starvation ??
             commandQueues[queueId].push_back( req );
@@ -1689,12 +1893,6 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
         
-        // added by MSON
-        if ( req->isCIM )
-        {
-            std::cout << "second if received CIM request!" << std::endl;
-        }
-        
         NVMainRequest *actRequest = MakeActivateRequest( req );
         actRequest->flags |= (writingArray != NULL && writingArray->IsWriting( )) ? NVMainRequest::FLAG_PRIORITY : 0;
         commandQueues[queueId].push_back( actRequest );
@@ -1733,19 +1931,8 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-        // added by MSON
-        if ( req->isCIM )
-        {
-            std::cout << "third if received CIM request!" << std::endl;
-        }
-
         if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
         {
-            // added by MSON
-            if ( req->isCIM )
-            {
-                std::cout << "CIM request satified activeSubArray[rank][bank][subarray] && p->UsePrecharge!" << std::endl;
-            }
             commandQueues[queueId].push_back( 
                     MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
         }
@@ -1769,12 +1956,6 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
         starvationCounter[rank][bank][subarray]++;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
-            
-        // added by MSON
-        if ( req->isCIM )
-        {
-            std::cout << "fourth if received CIM request!" << std::endl;
-        }
 
         /* Different row buffer management policy has different behavior */ 
         /*
@@ -1822,7 +2003,7 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
         
-        std::cout << "MemoryController::IssueMemoryCommands issuing CIM request!" << std::endl;
+        NVM_TRACE( TRACE_CIM, TRACE_CIM_SCHEDULE, req->issueCycle, req, queueId );
        
         if( req->isNOT_IN_ARRAY )
         {
@@ -1916,9 +2097,9 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
     }   
     else
     {
-        // added by MSON
-        if (req->isCIM)
-            std::cout << "check here" << std::endl;
+        if( req->isCIM )
+            NVM_TRACE( TRACE_CIM, TRACE_CIM_STALL, GetEventQueue()->GetCurrentCycle(), req, queueId );
+
         rv = false;
     }
 
@@ -1956,37 +2137,17 @@ void MemoryController::CycleCommandQueues( )
         {
             NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
 
-            // added by MSON
-            if( queueHead->isCIM && queueHead->type == ACTIVATE )
-            {
-                std::cout << "CIM ACTIVATE request is issued!" << std::endl;
-            }
-            else if( queueHead->isCIM && queueHead->type == PRECHARGE  ) 
-            {
-                std::cout << "CIM PRECHARGE request is issued!" << std::endl;
-            }
-            else if( queueHead->isCIM && queueHead->type == READ )
-            {
-                std::cout << "CIM READ request is issued!" << std::endl;
-            }
-            else if( queueHead->type == ACTIVATE )
-            {
-                std::cout << "Cycle at ACTIVATE: " << GetEventQueue()->GetCurrentCycle() << std::endl;
-            }
-            else if( queueHead->type == PRECHARGE )
-            {
-                std::cout << "Cycle at PRECHARGE: " << GetEventQueue()->GetCurrentCycle() << std::endl;
-            }
-            else if( queueHead->type == READ )
+            NVM_TRACE( TRACE_COMMAND, TRACE_COMMAND_ISSUE, GetEventQueue()->GetCurrentCycle(), 
+                       queueHead, queueId );
+
+            if( DebugEnabled( ) )
             {
-                std::cout << "Cycle at READ: " << GetEventQueue()->GetCurrentCycle() << std::endl;
+                *debugStream << GetEventQueue()->GetCurrentCycle() << " MemoryController: Issued request type "
+                             << queueHead->type << " for address 0x" << std::hex 
+                             << queueHead->address.GetPhysicalAddress()
+                             << std::dec << " for queue " << queueId << std::endl;
             }
 
-            *debugStream << GetEventQueue()->GetCurrentCycle() << " MemoryController: Issued request type "
-                         << queueHead->type << " for address 0x" << std::hex 
-                         << queueHead->address.GetPhysicalAddress()
-                         << std::dec << " for queue " << queueId << std::endl;
-
             GetChild( )->IssueCommand( queueHead );
 
             queueHead->flags |= NVMainRequest::FLAG_ISSUED;
@@ -2030,11 +2191,8 @@ void MemoryController::CycleCommandQueues( )
         {
             NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
             
-            // added by MSON
-            if (queueHead->isCIM)
-            {
-                std::cout << "CIM request satisfied !commandQueues[queueId].empty( )!" << std::endl;
-            }
+            NVM_TRACE( TRACE_COMMAND, TRACE_COMMAND_BLOCKED, GetEventQueue()->GetCurrentCycle(), 
+                       queueHead, fail.reason );
             
             if( ( GetEventQueue()->GetCurrentCycle() - queueHead->issueCycle ) > p->DeadlockTimer )
             {
@@ -42,6 +42,7 @@
 #include "src/Config.h"
 #include "src/Interconnect.h"
 #include "src/AddressTranslator.h"
+#include "src/LatencyProfile.h"
 #include "include/NVMainRequest.h"
 #include <deque>
 #include <iostream>
@@ -110,6 +111,7 @@ class MemoryController : public NVMObject
 
     virtual bool RequestComplete( NVMainRequest *request );
     virtual bool IsIssuable( NVMainRequest *request, FailReason *fail );
+    virtual bool IssueAtomic( NVMainRequest *request );
     ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void RegisterStats( );
@@ -127,6 +129,12 @@ class MemoryController : public NVMObject
     void SetID( unsigned int id );
     unsigned int GetID( );
 
+    LatencyProfile *GetLatencyProfile( );
+    ncounter_t GetQueueDepth( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     Interconnect *memory;
     Config *config;
@@ -134,6 +142,7 @@ class MemoryController : public NVMObject
     ncycle_t lastCommandWake;
     ncounter_t wakeupCount;
     ncycle_t lastIssueCycle;
+    LatencyProfile *latencyProfile;
 
     std::list<NVMainRequest *> *transactionQueues;
     std::deque<NVMainRequest *> *commandQueues;
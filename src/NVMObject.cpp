@@ -290,6 +290,7 @@ NVMObject::NVMObject( )
     hooks = new std::vector<NVMObject *> [NVMHOOK_COUNT];
     debugStream = NULL;
     tagGen = NULL;
+    tracer = NULL;
 }
 
 NVMObject::~NVMObject( )
@@ -424,6 +425,7 @@ void NVMObject::SetParent( NVMObject *p )
     SetGlobalEventQueue( p->GetGlobalEventQueue( ) );
     SetStats( p->GetStats( ) );
     SetTagGenerator( p->GetTagGenerator( ) );
+    SetTracer( p->GetTracer( ) );
 }
 
 void NVMObject::UnsetParent( )
@@ -662,6 +664,16 @@ TagGenerator *NVMObject::GetTagGenerator( )
     return tagGen;
 }
 
+void NVMObject::SetTracer( Tracer *t )
+{
+    tracer = t;
+}
+
+Tracer *NVMObject::GetTracer( )
+{
+    return tracer;
+}
+
 HookType NVMObject::GetHookType( )
 {
     return hookType;
@@ -712,8 +724,7 @@ std::vector<NVMObject *>& NVMObject::GetHooks( HookType h )
 
 void NVMObject::SetDebugName( std::string dn, Config *config )
 {
-    Params *params = new Params( );
-    params->SetParams( config );
+    Params *params = config->GetParams( );
 
     /* Debugging a parent will add debug prints for all children. */
     if( debugStream == config->GetDebugLog( ) || debugStream == &std::cerr )
@@ -730,6 +741,11 @@ void NVMObject::SetDebugName( std::string dn, Config *config )
     }
 }
 
+bool NVMObject::DebugEnabled( )
+{
+    return ( debugStream != NULL && debugStream != &nvmainDebugInhibitor );
+}
+
 ncycle_t NVMObject::MAX( const ncycle_t a, const ncycle_t b )
 {
     return (( a > b ) ? a : b );
@@ -93,6 +93,7 @@ class AddressTranslator;
 class NVMObject;
 class Config;
 class Params;
+class Tracer;
 
 enum HookType { NVMHOOK_NONE = 0,
                 NVMHOOK_PREISSUE,                /* Call hook before IssueCommand */
@@ -213,6 +214,9 @@ class NVMObject
     void SetTagGenerator( TagGenerator *tg );
     TagGenerator *GetTagGenerator( );
 
+    void SetTracer( Tracer *t );
+    Tracer *GetTracer( );
+
     HookType GetHookType( );
     void SetHookType( HookType );
 
@@ -223,6 +227,8 @@ class NVMObject
     std::vector<NVMObject *>& GetHooks( HookType h );
 
     virtual void SetDebugName( std::string dn, Config *config );
+    /* Check before formatting debug output, which the inhibitor discards. */
+    bool DebugEnabled( );
 
   protected:
     NVMObject_hook *parent;
@@ -236,6 +242,7 @@ class NVMObject
     GlobalEventQueue *globalEventQueue;
     std::ostream *debugStream;
     TagGenerator *tagGen;
+    Tracer *tracer;
     HookType hookType, currentHookType;
 
     void AddHookUnique( std::vector<NVMObject *>& list, NVMObject *hook );
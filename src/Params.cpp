@@ -77,9 +77,6 @@ Params::Params( )
     Epdps = 0.000000;
     Voltage = 1.5;
 
-    Eand = 0;
-    Eor = 0;
-
     /* 
      * Default to 30 ohms for read. This means 60 ohms for 
      * pull up and pull down. 
@@ -105,6 +102,7 @@ Params::Params( )
 
     EnduranceModel = "NullModel";
     DataEncoder = "default";
+    FaultModel = "";
     EnergyModel = "current";
 
     UseLowPower = true;
@@ -126,6 +124,7 @@ Params::Params( )
     OffChipLatency = 10;
 
     PeriodicStatsInterval = 0;
+    LatencyHistograms = false;
 
     ROWS = 65536;
     COLS = 32;
@@ -134,6 +133,7 @@ Params::Params( )
     BANKS = 8;
     RAW = 4;
     MATHeight = ROWS;
+    LazySubArrays = false;
     RBSize = COLS;
 
     tAL = 0;
@@ -164,9 +164,6 @@ Params::Params( )
     tXS = 5;
     tXSDLL = 512;
 
-    tAND = 0;
-    tOR = 0;
-
     tRDPDEN = 24;
     tWRPDEN = 19;
     tWRAPDEN = 22;
@@ -186,6 +183,10 @@ Params::Params( )
     WPVariance = 1;
     UniformWrites = true; // Disable MLC by default
     WriteAllBits = true;
+    BitCountMethod = "auto";
+    BitCountSelfCheck = false;
+    WriteDrivers = 0;
+    ChipWriteDrivers = 0;
 
     Ereset = 0.054331;
     Eset = 0.101581;
@@ -198,6 +199,19 @@ Params::Params( )
     nWP11 = 1;
 
     WPMaxVariance = 2;
+    RandomSeed = 1;
+
+    for( int cimIdx = 0; cimIdx < CIM_OP_COUNT; cimIdx++ )
+    {
+        tCIM[cimIdx] = 0;
+        tCIMPerRow[cimIdx] = 0;
+        ECIM[cimIdx] = 0.0;
+        ECIMPerRow[cimIdx] = 0.0;
+        CIMOperandRows[cimIdx] = GetCIMMinOperandRows( 
+                                     static_cast<OpType>(NOT_IN_ARRAY + cimIdx) );
+    }
+    CIMMaxOperandRows = 2;
+    FunctionalCIM = false;
 
     WritePausing = false;
     PauseThreshold = 0.4;
@@ -222,6 +236,156 @@ void Params::ConvertTiming( Config *conf, std::string param, ncycle_t& value )
     }
 }
 
+/*
+ *  Config keys for the CIM timing/energy table, in OpType order starting
+ *  at NOT_IN_ARRAY. Each timing key also has a "<key>PerRow" variant, as
+ *  does each energy key. NAND and NOR fall back to the AND and OR values
+ *  when they are not configured.
+ */
+static const char *cimTimingKeys[CIM_OP_COUNT] = 
+    { "tNOT", "tANDArray", "tAND", "tOR", "tNAND", "tNOR", "tXOR" };
+static const char *cimEnergyKeys[CIM_OP_COUNT] = 
+    { "Enot", "EandArray", "Eand", "Eor", "Enand", "Enor", "Exor" };
+static const char *cimOpNames[CIM_OP_COUNT] =
+    { "NOT_IN_ARRAY", "AND_IN_ARRAY", "AND_IN_LATCH", "OR_IN_LATCH",
+      "NAND_IN_LATCH", "NOR_IN_LATCH", "XOR_IN_LATCH" };
+static const char *cimRowKeys[CIM_OP_COUNT] =
+    { "NOTRows", "ANDArrayRows", "ANDRows", "ORRows", "NANDRows", "NORRows", "XORRows" };
+static const int cimFallback[CIM_OP_COUNT] =
+    { -1, -1, -1, -1, AND_IN_LATCH - NOT_IN_ARRAY, OR_IN_LATCH - NOT_IN_ARRAY, -1 };
+
+void Params::SetCIMParams( Config *c )
+{
+    c->GetValueUL( "CIMMaxOperandRows", CIMMaxOperandRows );
+    if( c->KeyExists( "FunctionalCIM" ) )
+        FunctionalCIM = c->GetBool( "FunctionalCIM" );
+
+    for( int cimIdx = 0; cimIdx < CIM_OP_COUNT; cimIdx++ )
+    {
+        std::string tKey = cimTimingKeys[cimIdx];
+        std::string eKey = cimEnergyKeys[cimIdx];
+        int fallback = cimFallback[cimIdx];
+
+        if( fallback >= 0 )
+        {
+            tCIM[cimIdx] = tCIM[fallback];
+            tCIMPerRow[cimIdx] = tCIMPerRow[fallback];
+            ECIM[cimIdx] = ECIM[fallback];
+            ECIMPerRow[cimIdx] = ECIMPerRow[fallback];
+        }
+
+        /* The table is optional, so only read the keys that are present. */
+        ConvertTiming( c, tKey, tCIM[cimIdx] );
+        ConvertTiming( c, tKey + "PerRow", tCIMPerRow[cimIdx] );
+        if( c->KeyExists( eKey ) )
+            ECIM[cimIdx] = c->GetEnergy( eKey );
+        if( c->KeyExists( eKey + "PerRow" ) )
+            ECIMPerRow[cimIdx] = c->GetEnergy( eKey + "PerRow" );
+        if( c->KeyExists( cimRowKeys[cimIdx] ) )
+            CIMOperandRows[cimIdx] = c->GetValueUL( cimRowKeys[cimIdx] );
+    }
+
+    /* Validate the table so bad values don't silently skew PIM results. */
+    for( int cimIdx = 0; cimIdx < CIM_OP_COUNT; cimIdx++ )
+    {
+        OpType op = static_cast<OpType>(NOT_IN_ARRAY + cimIdx);
+        ncounter_t minRows = GetCIMMinOperandRows( op );
+        ncounter_t maxRows = GetCIMMaxOperandRows( op );
+
+        if( ECIM[cimIdx] < 0.0 || ECIMPerRow[cimIdx] < 0.0 )
+        {
+            std::cerr << "NVMain Error: CIM energy " << cimEnergyKeys[cimIdx]
+                      << " can not be negative." << std::endl;
+            exit(1);
+        }
+
+        if( CIMOperandRows[cimIdx] < minRows || CIMOperandRows[cimIdx] > maxRows )
+        {
+            std::cerr << "NVMain Error: " << cimRowKeys[cimIdx] << " is "
+                      << CIMOperandRows[cimIdx] << " but must be between "
+                      << minRows << " and " << maxRows 
+                      << " (see CIMMaxOperandRows)." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+/* NOT is unary; every other CIM operation needs at least two operand rows. */
+ncounter_t Params::GetCIMMinOperandRows( OpType op )
+{
+    return (op == NOT_IN_ARRAY) ? 1 : 2;
+}
+
+ncounter_t Params::GetCIMOperandRows( NVMainRequest *request )
+{
+    OpType op = request->GetCIMOp( );
+
+    if( op == NOP )
+        return 0;
+
+    if( request->cimOperandRows != 0 )
+        return request->cimOperandRows;
+
+    return CIMOperandRows[op - NOT_IN_ARRAY];
+}
+
+/* The operation's name as written in traces. */
+const char *Params::GetCIMOpName( OpType op )
+{
+    if( op < NOT_IN_ARRAY || op > XOR_IN_LATCH )
+        return "NOP";
+
+    return cimOpNames[op - NOT_IN_ARRAY];
+}
+
+ncounter_t Params::GetCIMMaxOperandRows( OpType op )
+{
+    return (GetCIMMinOperandRows( op ) == 1) ? 1 : CIMMaxOperandRows;
+}
+
+bool Params::ValidCIMOperandRows( NVMainRequest *request )
+{
+    OpType op = request->GetCIMOp( );
+
+    if( op == NOP )
+        return true;
+
+    ncounter_t rows = GetCIMOperandRows( request );
+
+    return ( rows >= GetCIMMinOperandRows( op ) 
+             && rows <= GetCIMMaxOperandRows( op ) );
+}
+
+ncycle_t Params::GetCIMLatency( NVMainRequest *request )
+{
+    OpType op = request->GetCIMOp( );
+
+    if( op == NOP )
+        return 0;
+
+    ncounter_t cimIdx = op - NOT_IN_ARRAY;
+    ncounter_t rows = GetCIMOperandRows( request );
+    ncounter_t minRows = GetCIMMinOperandRows( op );
+    ncounter_t extraRows = (rows > minRows) ? rows - minRows : 0;
+
+    return tCIM[cimIdx] + tCIMPerRow[cimIdx] * extraRows;
+}
+
+double Params::GetCIMEnergy( NVMainRequest *request )
+{
+    OpType op = request->GetCIMOp( );
+
+    if( op == NOP )
+        return 0.0;
+
+    ncounter_t cimIdx = op - NOT_IN_ARRAY;
+    ncounter_t rows = GetCIMOperandRows( request );
+    ncounter_t minRows = GetCIMMinOperandRows( op );
+    ncounter_t extraRows = (rows > minRows) ? rows - minRows : 0;
+
+    return ECIM[cimIdx] + ECIMPerRow[cimIdx] * static_cast<double>(extraRows);
+}
+
 ncycle_t Params::ConvertTiming( Config *conf, std::string param )
 {
     if( !conf->KeyExists( param ) )
@@ -288,9 +452,6 @@ void Params::SetParams( Config *c )
     c->GetEnergy( "Epdps", Epdps );
     c->GetEnergy( "Voltage", Voltage );
 
-    c->GetEnergy( "Eand", Eand );
-    c->GetEnergy( "Eor", Eor );
-
     c->GetValue( "Rtt_nom", Rtt_nom );
     c->GetValue( "Rtt_wr", Rtt_wr );
     c->GetValue( "Rtt_cont", Rtt_cont );
@@ -301,6 +462,7 @@ void Params::SetParams( Config *c )
 
     c->GetString( "EnduranceModel", EnduranceModel );
     c->GetString( "DataEncoder", DataEncoder );
+    c->GetString( "FaultModel", FaultModel );
     c->GetString( "EnergyModel", EnergyModel );
 
     c->GetBool( "UseLowPower", UseLowPower );
@@ -322,6 +484,8 @@ void Params::SetParams( Config *c )
     c->GetValueUL( "OffChipLatency", OffChipLatency );
 
     c->GetValueUL( "PeriodicStatsInterval", PeriodicStatsInterval );
+    if( c->KeyExists( "LatencyHistograms" ) )
+        LatencyHistograms = c->GetBool( "LatencyHistograms" );
 
     c->GetValueUL( "ROWS", ROWS );
     c->GetValueUL( "COLS", COLS );
@@ -330,6 +494,8 @@ void Params::SetParams( Config *c )
     c->GetValueUL( "BANKS", BANKS );
     c->GetValueUL( "RAW", RAW );
     c->GetValueUL( "MATHeight", MATHeight );
+    if( c->KeyExists( "LazySubArrays" ) )
+        LazySubArrays = c->GetBool( "LazySubArrays" );
     c->GetValueUL( "RBSize", RBSize );
 
     ConvertTiming( c, "tAL", tAL );
@@ -360,9 +526,6 @@ void Params::SetParams( Config *c )
     ConvertTiming( c, "tXS", tXS );
     ConvertTiming( c, "tXSDLL", tXSDLL );
 
-    ConvertTiming( c, "tAND", tAND );
-    ConvertTiming( c, "tOR", tOR );
-
     c->GetValueUL( "tRDPDEN", tRDPDEN );
     c->GetValueUL( "tWRPDEN", tWRPDEN );
     c->GetValueUL( "tWRAPDEN", tWRAPDEN );
@@ -391,6 +554,14 @@ void Params::SetParams( Config *c )
     c->GetValueUL( "WPVariance",  WPVariance );
     c->GetBool( "UniformWrites", UniformWrites );
     c->GetBool( "WriteAllBits", WriteAllBits );
+    if( c->KeyExists( "BitCountMethod" ) )
+        BitCountMethod = c->GetString( "BitCountMethod" );
+    if( c->KeyExists( "BitCountSelfCheck" ) )
+        BitCountSelfCheck = c->GetBool( "BitCountSelfCheck" );
+    if( c->KeyExists( "WriteDrivers" ) )
+        WriteDrivers = c->GetValueUL( "WriteDrivers" );
+    if( c->KeyExists( "ChipWriteDrivers" ) )
+        ChipWriteDrivers = c->GetValueUL( "ChipWriteDrivers" );
 
     c->GetEnergy( "Ereset", Ereset );
     c->GetEnergy( "Eset", Eset );
@@ -404,6 +575,11 @@ void Params::SetParams( Config *c )
 
     c->GetValueUL( "WPMaxVariance", WPMaxVariance );
 
+    if( c->KeyExists( "RandomSeed" ) )
+        c->GetValueUL( "RandomSeed", RandomSeed );
+
+    SetCIMParams( c );
+
     c->GetValueUL( "DeadlockTimer", DeadlockTimer );
 
     c->GetBool( "EnableDebug", debugOn );
@@ -39,6 +39,7 @@
 #include "src/Config.h"
 #include "src/Debug.h"
 #include "include/NVMTypes.h"
+#include "include/NVMainRequest.h"
 
 #include <set>
 #include <string>
@@ -93,9 +94,6 @@ class Params
     double Epdps;
     double Voltage;
 
-    double Eand; // dynamic energy for in-latch bitwise AND operation
-    double Eor; // dynamic energy for in-latch bitwise OR operation
-
     int Rtt_nom;
     int Rtt_wr;
     int Rtt_cont;
@@ -106,6 +104,7 @@ class Params
 
     std::string EnduranceModel;
     std::string DataEncoder;
+    std::string FaultModel;
     std::string EnergyModel;
 
     bool UseLowPower;
@@ -127,6 +126,7 @@ class Params
     ncounter_t OffChipLatency;
 
     ncounter_t PeriodicStatsInterval;
+    bool LatencyHistograms; // Latency percentiles per request class and thread
 
     ncounter_t ROWS;
     ncounter_t COLS;
@@ -135,6 +135,7 @@ class Params
     ncounter_t BANKS;
     ncounter_t RAW;
     ncounter_t MATHeight;
+    bool LazySubArrays; // Build a subarray's models and stats on first use
     ncounter_t RBSize;
 
     ncycle_t tAL;
@@ -165,9 +166,6 @@ class Params
     ncycle_t tXS;
     ncycle_t tXSDLL;
 
-    ncycle_t tAND; // delay time for in-latch bitwise AND operation
-    ncycle_t tOR;  // delay time for in-latch bitwise OR operation
-
     ncycle_t tRDPDEN; // interval between Read/ReadA and PowerDown
     ncycle_t tWRPDEN; // interval between Write and PowerDown
     ncycle_t tWRAPDEN; // interval between WriteA and PowerDown
@@ -187,6 +185,8 @@ class Params
     ncounter_t WPVariance;
     bool UniformWrites;
     bool WriteAllBits; // Set false to calculate write energy on a per-bit basis
+    std::string BitCountMethod; // auto, portable, popcnt, avx2 or avx512
+    bool BitCountSelfCheck; // Compare bit counts against the reference code
 
     /* SLC energy */
     double Ereset; 
@@ -200,9 +200,38 @@ class Params
     ncycle_t nWP10;
     ncycle_t nWP11;
 
+    /* Write drivers per subarray and per chip (device); 0 is unlimited. */
+    ncounter_t WriteDrivers;
+    ncounter_t ChipWriteDrivers;
+
     /* 2-level MLC variance (01 and 10 only). */
     ncycle_t WPMaxVariance;
 
+    /* Base seed of the per-module random streams (see MakeSeed). */
+    ncounter_t RandomSeed;
+
+    /* 
+     *  Compute-in-memory timing and energy, indexed by ( op - NOT_IN_ARRAY ).
+     *  tCIM/ECIM are the extra delay after tRCD and the dynamic energy for
+     *  the minimum number of operand rows; each additional operand row adds
+     *  tCIMPerRow/ECIMPerRow.
+     */
+    ncycle_t tCIM[CIM_OP_COUNT];
+    ncycle_t tCIMPerRow[CIM_OP_COUNT];
+    double ECIM[CIM_OP_COUNT];
+    double ECIMPerRow[CIM_OP_COUNT];
+    ncounter_t CIMOperandRows[CIM_OP_COUNT]; // default operand rows per op
+    ncounter_t CIMMaxOperandRows; // max rows that can be activated at once
+    bool FunctionalCIM; // Set true to compute CIM results on stored row data
+
+    const char *GetCIMOpName( OpType op );
+    ncounter_t GetCIMMinOperandRows( OpType op );
+    ncounter_t GetCIMMaxOperandRows( OpType op );
+    ncounter_t GetCIMOperandRows( NVMainRequest *request );
+    bool ValidCIMOperandRows( NVMainRequest *request );
+    ncycle_t GetCIMLatency( NVMainRequest *request );
+    double GetCIMEnergy( NVMainRequest *request );
+
     /* Configurable deadlock timer. */
     ncycle_t DeadlockTimer;
 
@@ -216,6 +245,8 @@ class Params
     PauseMode pauseMode;
 
   private:
+    void SetCIMParams( Config *c );
+
     void ConvertTiming( Config *conf, std::string param, ncycle_t& value );
     ncycle_t ConvertTiming( Config *conf, std::string param );
 };
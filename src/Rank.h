@@ -41,6 +41,7 @@
 #include "src/Bank.h"
 #include "src/Params.h"
 #include "src/NVMObject.h"
+#include "src/WriteDriverPool.h"
 #include <iostream>
 
 namespace NVM {
@@ -79,6 +80,11 @@ class Rank : public NVMObject
 
     virtual bool Idle( );
 
+    WriteDriverPool *GetWriteDriverPool( ) { return &writeDriverPool; }
+
+  protected:
+    /* Write drivers of each chip, shared by all of its subarrays. */
+    WriteDriverPool writeDriverPool;
 };
 
 };
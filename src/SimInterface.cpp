@@ -33,48 +33,61 @@
 
 #include "src/SimInterface.h"
 #include "src/Config.h"
+#include <cstring>
 #include <iostream>
 
 using namespace NVM;
 
 int SimInterface::GetDataAtAddress( uint64_t address, NVMDataBlock *data )
 {
-    int retval;
+    uint8_t *line = memoryData.GetLine( address );
 
-    if( !memoryData.count( address ) )
-    {
-        retval = 0;
-    }
-    else
+    if( line == NULL )
+        return 0;
+
+    if( data )
     {
-        if( data )
-            data = memoryData[ address ];
-        retval = 1;
+        uint64_t lineSize = memoryData.GetLineSize( );
+
+        if( data->rawData == NULL )
+            data->SetSize( lineSize );
+
+        memcpy( data->rawData, line, 
+                (data->GetSize( ) < lineSize) ? data->GetSize( ) : lineSize );
+        data->SetValid( true );
     }
 
-    return retval;
+    return 1;
 }
 
 void SimInterface::SetDataAtAddress( uint64_t address, NVMDataBlock& data )
 {
-    if( !accessCounts.count( address ) )
-    {
-        NVMDataBlock *newData = new NVMDataBlock( );
-        memoryData[ address ] = newData;
-        *newData = data;
-        accessCounts[ address ] = 0;
-    }
-    else
-    {
-        NVMDataBlock *newData = memoryData[ address ];
-        *newData = data;
-        accessCounts[ address ]++;
-    }
+    memoryData.SetLine( address, data.rawData, data.GetSize( ) );
 }
 
 void SimInterface::SetConfig( Config *config, bool /*createChildren*/ )
 {
+    uint64_t lineSize = 64;
+    uint64_t pageSize = 4096;
+    std::string backingFile = "";
+
     conf = config;
+
+    /* A line is one memory word, i.e., the data of one request. */
+    if( conf->KeyExists( "BusWidth" ) && conf->KeyExists( "tBURST" )
+        && conf->KeyExists( "RATE" ) )
+    {
+        lineSize = conf->GetValueUL( "BusWidth" ) * conf->GetValueUL( "tBURST" )
+                 * conf->GetValueUL( "RATE" ) / 8;
+    }
+
+    if( conf->KeyExists( "FunctionalPageSize" ) )
+        pageSize = conf->GetValueUL( "FunctionalPageSize" );
+
+    if( conf->KeyExists( "FunctionalBackingFile" ) )
+        backingFile = conf->GetString( "FunctionalBackingFile" );
+
+    memoryData.Configure( lineSize, pageSize, backingFile );
 }
 
 Config *SimInterface::GetConfig( )
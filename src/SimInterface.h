@@ -35,8 +35,8 @@
 #define __SIMINTERFACE_H__
 
 #include <stdint.h>
-#include <map>
 #include "include/NVMDataBlock.h"
+#include "src/FunctionalMemory.h"
 
 namespace NVM {
 
@@ -44,7 +44,7 @@ class Config;
 class SimInterface
 {
   public:
-    SimInterface( ) { }
+    SimInterface( ) : conf( NULL ) { }
     virtual ~SimInterface( ) { }
 
     virtual unsigned int GetInstructionCount( int ) = 0;
@@ -61,9 +61,10 @@ class SimInterface
     void SetConfig( Config *conf, bool createChildren = true );
     Config *GetConfig( );
 
+    FunctionalMemory *GetFunctionalMemory( ) { return &memoryData; }
+
   private:
-    std::map< uint64_t, NVMDataBlock* > memoryData;
-    std::map< uint64_t, unsigned int > accessCounts;
+    FunctionalMemory memoryData;
     Config *conf;
 
 };
@@ -34,6 +34,11 @@
 
 #include "src/Stats.h"
 
+#include <iostream>
+
+#include <algorithm>
+#include <cmath>
+
 
 using namespace NVM;
 
@@ -41,6 +46,7 @@ using namespace NVM;
 Stats::Stats( )
 {
     psInterval = 0;
+    layoutVersion = 0;
 }
 
 Stats::~Stats( )
@@ -49,59 +55,104 @@ Stats::~Stats( )
 
     for( it = statList.begin(); it != statList.end(); it++ )
     {
-        /* Free reset value memory. */
-        uint8_t *rval = static_cast<uint8_t *>((*it)->GetResetValue( ));
-        delete[] rval; 
         delete (*it);
     }
 }
 
-void Stats::addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units )
+StatBase *Stats::registerStat( StatBase *stat, const std::string& owner, const std::string& leaf, const std::string& units )
 {
-    StatBase *sb = new StatBase( );
+    stat->SetName( owner + "." + leaf );
+    stat->SetUnits( units );
+
+    statList.push_back( stat );
+
+    /* The first registration of a name wins lookups, as it always has. */
+    ownerIndex[owner].insert( std::make_pair( leaf, stat ) );
+    valueIndex.insert( std::make_pair( stat->GetValue( ), std::make_pair( stat, owner.size( ) ) ) );
 
-    sb->SetName( name );
-    sb->SetValue( stat );
-    sb->SetResetValue( resetValue );
-    sb->SetStatType( statType, typeSize );
-    sb->SetUnits( units );
+    return stat;
+}
 
-    statList.push_back( sb );
+StatBase *Stats::addFormula( std::function<double()> formula, const std::string& owner, const std::string& leaf, const std::string& units )
+{
+    return registerStat( new FormulaStat( formula ), owner, leaf, units );
 }
 
 void Stats::removeStat( StatType stat )
 {
+    std::unordered_map<StatType, std::pair<StatBase *, size_t> >::iterator vit;
+
+    vit = valueIndex.find( stat );
+    if( vit == valueIndex.end( ) )
+        return;
+
+    StatBase *handle = vit->second.first;
+    std::string name = handle->GetName( );
+    std::string owner = name.substr( 0, vit->second.second );
+    std::string leaf = name.substr( vit->second.second + 1 );
+
+    valueIndex.erase( vit );
+
+    StatIndex& ownerStats = ownerIndex[owner];
+    StatIndex::iterator lit = ownerStats.find( leaf );
+    if( lit != ownerStats.end( ) && lit->second == handle )
+        ownerStats.erase( lit );
+
     std::vector<StatBase *>::iterator it;
 
     for( it = statList.begin(); it != statList.end(); it++ )
     {
-        if( (*it)->GetValue( ) == stat )
+        if( (*it) == handle )
         {
-            /* Free reset value memory. */
-            uint8_t *rval = static_cast<uint8_t *>((*it)->GetResetValue( ));
-            delete[] rval; 
-
             statList.erase( it );
             break;
         }
     }
+
+    layoutVersion++;
+
+    delete handle;
 }
 
-StatType Stats::getStat( std::string name )
+StatBase *Stats::getStatHandle( const std::string& name )
 {
-    StatType rv = NULL;
-    std::vector<StatBase *>::iterator it;
+    StatBase *handle = NULL;
+    std::string::size_type split = name.rfind( '.' );
 
-    for( it = statList.begin(); it != statList.end(); it++ )
+    /* Stat names may contain dots themselves, so try each split point. */
+    while( handle == NULL && split != std::string::npos && split != 0 )
     {
-        if( (*it)->GetName( ) == name )
-        {
-            rv = (*it)->GetValue( );
-            break;
-        }
+        handle = getStatHandle( name.substr( 0, split ), name.substr( split + 1 ) );
+        split = name.rfind( '.', split - 1 );
     }
 
-    return rv;
+    return handle;
+}
+
+StatBase *Stats::getStatHandle( const std::string& owner, const std::string& leaf )
+{
+    std::unordered_map<std::string, StatIndex>::iterator oit = ownerIndex.find( owner );
+
+    if( oit == ownerIndex.end( ) )
+        return NULL;
+
+    StatIndex::iterator it = oit->second.find( leaf );
+
+    return (it == oit->second.end( )) ? NULL : it->second;
+}
+
+StatType Stats::getStat( const std::string& name )
+{
+    StatBase *handle = getStatHandle( name );
+
+    return (handle == NULL) ? NULL : handle->GetValue( );
+}
+
+StatType Stats::getStat( const std::string& owner, const std::string& leaf )
+{
+    StatBase *handle = getStatHandle( owner, leaf );
+
+    return (handle == NULL) ? NULL : handle->GetValue( );
 }
 
 void Stats::PrintAll( std::ostream& stream )
@@ -127,26 +178,237 @@ void Stats::ResetAll( )
 }
 
 
-void StatBase::Reset( )
+void Stats::CreateCheckpoint( std::string dir )
 {
-    std::memcpy( value, resetValue, typeSize );
+    CheckpointWriter writer( dir, "stats" );
+
+    writer.Write( psInterval );
+    writer.Write( static_cast<uint64_t>( statList.size( ) ) );
+
+    for( size_t i = 0; i < statList.size( ); i++ )
+    {
+        writer.Write( statList[i]->GetName( ) );
+        writer.Write( static_cast<uint32_t>( statList[i]->GetKind( ) ) );
+
+        writer.BeginSection( );
+        statList[i]->Save( writer );
+        writer.EndSection( );
+    }
+}
+
+/*
+ *  Names may repeat, so the n-th saved stat of a name goes to the n-th
+ *  registered one. Stats that were not saved keep their current value;
+ *  saved stats that are no longer registered are skipped.
+ */
+void Stats::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, "stats" );
+    std::unordered_map<std::string, std::vector<StatBase *> > byName;
+    std::unordered_map<std::string, size_t> used;
+    uint64_t savedCount;
+    ncounter_t skipped = 0;
+
+    for( size_t i = 0; i < statList.size( ); i++ )
+        byName[statList[i]->GetName( )].push_back( statList[i] );
+
+    reader.Read( psInterval );
+    reader.Read( savedCount );
+
+    for( uint64_t i = 0; i < savedCount; i++ )
+    {
+        std::string name;
+        uint32_t kind;
+        StatBase *stat = NULL;
+
+        reader.Read( name );
+        reader.Read( kind );
+        uint64_t length = reader.BeginSection( );
+
+        std::unordered_map<std::string, std::vector<StatBase *> >::iterator it;
+        it = byName.find( name );
+        if( it != byName.end( ) && used[name] < it->second.size( ) )
+            stat = it->second[used[name]++];
+
+        if( stat != NULL && static_cast<uint32_t>( stat->GetKind( ) ) == kind )
+        {
+            stat->Load( reader );
+        }
+        else
+        {
+            reader.SkipSection( length );
+            skipped++;
+        }
+    }
+
+    if( skipped > 0 )
+    {
+        std::cout << "Stats: Warning: " << skipped << " checkpointed stats are "
+                  << "not registered in this configuration." << std::endl;
+    }
 }
 
 void StatBase::Print( std::ostream& stream, ncounter_t psInterval )
 {
     stream << "i" << psInterval << "." << name << " ";
 
-    if( statType == typeid(int).name() ) stream << *(static_cast<int *>(value));
-    else if( statType == typeid(float).name() ) stream << *(static_cast<float *>(value));
-    else if( statType == typeid(double).name() ) stream << *(static_cast<double *>(value));
-    else if( statType == typeid(ncounter_t).name() ) stream << *(static_cast<ncounter_t *>(value));
-    else if( statType == typeid(ncounters_t).name() ) stream << *(static_cast<ncounters_t *>(value));
-    else if( statType == typeid(ncycle_t).name() ) stream << *(static_cast<ncycle_t *>(value));
-    else if( statType == typeid(ncycles_t).name() ) stream << *(static_cast<ncycles_t *>(value));
-    else if( statType == typeid(std::string).name() ) stream << *(static_cast<std::string *>(value));
-    else stream << "?????";
+    PrintValue( stream );
 
     stream << units << std::endl;
 }
 
+namespace NVM {
+
+template<> void TypedStat<StatHistogram>::Print( std::ostream& stream, ncounter_t psInterval )
+{
+    for( size_t i = 0; i < StatHistogram::SummaryCount; i++ )
+    {
+        stream << "i" << psInterval << "." << GetName( ) << "." 
+               << StatHistogram::GetSummaryName( i ) << " ";
+
+        /* Everything but the mean is a whole number of cycles or samples. */
+        if( i == 1 )
+            stream << value->GetSummary( i );
+        else
+            stream << static_cast<ncounter_t>( value->GetSummary( i ) );
+
+        stream << GetUnits( ) << std::endl;
+    }
+}
+
+};
+
+
+const char *StatHistogram::GetSummaryName( size_t summary )
+{
+    const char *names[SummaryCount] = { "count", "mean", "p50", "p90", "p99", "p999", "max" };
+
+    return names[summary];
+}
+
+double StatHistogram::GetSummary( size_t summary ) const
+{
+    const double percentiles[SummaryCount] = { 0.0, 0.0, 0.50, 0.90, 0.99, 0.999, 0.0 };
+    double rv;
+
+    if( summary == 0 )
+        rv = static_cast<double>( GetCount( ) );
+    else if( summary == 1 )
+        rv = GetMean( );
+    else if( summary == SummaryCount - 1 )
+        rv = static_cast<double>( GetMax( ) );
+    else
+        rv = static_cast<double>( GetPercentile( percentiles[summary] ) );
+
+    return rv;
+}
+
+
+size_t StatHistogram::BucketIndex( ncounter_t value )
+{
+    if( value < 2 * SubBuckets )
+        return static_cast<size_t>( value );
+
+    /* Position of the highest set bit selects the power of two. */
+    unsigned int msb = 63 - static_cast<unsigned int>( __builtin_clzll( value ) );
+    unsigned int shift = msb - SubBucketBits;
+
+    return static_cast<size_t>( shift * SubBuckets + (value >> shift) );
+}
+
+ncounter_t StatHistogram::BucketUpperBound( size_t index )
+{
+    if( index < 2 * SubBuckets )
+        return static_cast<ncounter_t>( index );
+
+    ncounter_t shift = index / SubBuckets - 1;
+    ncounter_t subBucket = index - shift * SubBuckets;
+
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void StatHistogram::Sample( ncounter_t value )
+{
+    size_t index = BucketIndex( value );
+
+    if( index >= buckets.size( ) )
+        buckets.resize( index + 1, 0 );
+
+    buckets[index]++;
+    count++;
+    sum += value;
+
+    if( value > maxValue )
+        maxValue = value;
+}
+
+void StatHistogram::Merge( const StatHistogram& other )
+{
+    if( other.buckets.size( ) > buckets.size( ) )
+        buckets.resize( other.buckets.size( ), 0 );
+
+    for( size_t i = 0; i < other.buckets.size( ); i++ )
+        buckets[i] += other.buckets[i];
+
+    count += other.count;
+    sum += other.sum;
+
+    if( other.maxValue > maxValue )
+        maxValue = other.maxValue;
+}
+
+void StatHistogram::Save( CheckpointWriter& writer ) const
+{
+    writer.WriteArray( buckets.empty( ) ? NULL : &buckets[0], buckets.size( ) );
+    writer.Write( count );
+    writer.Write( sum );
+    writer.Write( maxValue );
+}
+
+void StatHistogram::Load( CheckpointReader& reader )
+{
+    uint64_t bucketCount;
+
+    /* The bucket count is whatever the saved histogram had grown to. */
+    reader.Read( bucketCount );
+    buckets.assign( bucketCount, 0 );
+    for( uint64_t i = 0; i < bucketCount; i++ )
+        reader.Read( buckets[i] );
+
+    reader.Read( count );
+    reader.Read( sum );
+    reader.Read( maxValue );
+}
+
+void StatHistogram::Clear( )
+{
+    buckets.clear( );
+    count = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+ncounter_t StatHistogram::GetPercentile( double percentile ) const
+{
+    if( count == 0 )
+        return 0;
+
+    /* Smallest bucket holding at least percentile * count samples. */
+    ncounter_t target = static_cast<ncounter_t>( std::ceil( percentile * static_cast<double>(count) ) );
+    ncounter_t seen = 0;
+
+    if( target == 0 )
+        target = 1;
+
+    for( size_t i = 0; i < buckets.size( ); i++ )
+    {
+        seen += buckets[i];
+
+        if( seen >= target )
+            return std::min( BucketUpperBound( i ), maxValue );
+    }
+
+    return maxValue;
+}
+
 
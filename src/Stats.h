@@ -45,31 +45,35 @@
         }
 #define _AddStat(STAT, UNITS)                                                 \
         {                                                                     \
-            uint8_t *__resetValue = new uint8_t [sizeof(STAT)];               \
-            memcpy(__resetValue, static_cast<StatType>(&STAT), sizeof(STAT)); \
-            this->GetStats()->addStat(static_cast<StatType>(&(STAT)),         \
-                                      static_cast<StatType>(__resetValue),    \
-                                      typeid(STAT).name(),                    \
-                                      sizeof(STAT),                           \
-                                      StatName() + "." + #STAT,               \
-                                      UNITS);                                 \
+            this->GetStats()->addStat( &(STAT), StatName(), #STAT, UNITS );   \
+        }
+/* FUNC = anything convertible to std::function<double()> */
+#define AddFormulaStat(NAME, FUNC, UNITS)                                     \
+        {                                                                     \
+            this->GetStats()->addFormula( FUNC, StatName(), NAME, UNITS );    \
         }
 #define RemoveStat(STAT) (this->GetStats()->removeStat(static_cast<StatType>(&STAT)))
 
 // CHLD = NVMObject_hook, STAT = std::string; returns StatType
-#define GetStat(CHLD, STAT) (CHLD->GetStats( )->getStat( CHLD->StatName( ) + "." + STAT ) )
+#define GetStat(CHLD, STAT) (CHLD->GetStats( )->getStat( CHLD->StatName( ), STAT ) )
+
+// CHLD = NVMObject_hook, STAT = std::string; returns StatBase *
+#define GetStatHandle(CHLD, STAT) (CHLD->GetStats( )->getStatHandle( CHLD->StatName( ), STAT ) )
 
 // STAT = StatType, TYPE = any type; returns TYPE
 #define CastStat(STAT, TYPE) (*(static_cast< TYPE * >( STAT )))
 
 
 
+#include <functional>
 #include <ostream>
-#include <typeinfo>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <cstring>
 
 #include "include/NVMTypes.h"
+#include "src/Checkpoint.h"
 
 namespace NVM {
 
@@ -77,36 +81,243 @@ namespace NVM {
 typedef void * StatType;
 
 
+enum StatKind
+{
+    STAT_COUNTER,     /* Integral event counts. */
+    STAT_SCALAR,      /* Floating point values such as energy or power. */
+    STAT_AVERAGE,     /* Running mean of sampled values. */
+    STAT_HISTOGRAM,   /* Distribution of sampled values. */
+    STAT_FORMULA,     /* Value computed from other stats when read. */
+    STAT_STRING,      /* Free-form text. */
+    STAT_OPAQUE       /* Registered, but not printable. */
+};
+
+/*
+ *  Running mean of sampled values. Declare it as a member and register it
+ *  with AddStat like any other stat; it prints the mean.
+ */
+class StatAverage
+{
+  public:
+    StatAverage( ) : sum(0.0), count(0) { }
+
+    void Sample( double value ) { sum += value; count++; }
+    double GetMean( ) const { return (count == 0) ? 0.0 : sum / static_cast<double>(count); }
+    double GetSum( ) const { return sum; }
+    ncounter_t GetCount( ) const { return count; }
+
+    void Save( CheckpointWriter& writer ) const { writer.Write( sum ); writer.Write( count ); }
+    void Load( CheckpointReader& reader ) { reader.Read( sum ); reader.Read( count ); }
+
+  private:
+    double sum;
+    ncounter_t count;
+};
+
+/*
+ *  Log-bucketed histogram of non-negative integer samples such as latencies
+ *  in cycles. Values below 2 * SubBuckets are kept exactly; above that each
+ *  power of two is split into SubBuckets linear buckets, so a percentile is
+ *  reported to within 1/SubBuckets of the true value. Buckets only grow to
+ *  the largest sample seen. All histograms share one bucket layout, so
+ *  merging (e.g., across channels or periodic intervals) adds the counts.
+ */
+class StatHistogram
+{
+  public:
+    StatHistogram( ) : count(0), sum(0), maxValue(0) { }
+
+    void Sample( ncounter_t value );
+    void Merge( const StatHistogram& other );
+    void Clear( );
+
+    ncounter_t GetCount( ) const { return count; }
+    ncounter_t GetMax( ) const { return maxValue; }
+    double GetMean( ) const { return (count == 0) ? 0.0 : static_cast<double>(sum) / static_cast<double>(count); }
+    ncounter_t GetPercentile( double percentile ) const;
+
+    /* The values printed for a histogram: count, mean, percentiles and max. */
+    static const size_t SummaryCount = 7;
+    static const char *GetSummaryName( size_t summary );
+    double GetSummary( size_t summary ) const;
+
+    void Save( CheckpointWriter& writer ) const;
+    void Load( CheckpointReader& reader );
+
+  private:
+    static const unsigned int SubBucketBits = 5;
+    static const ncounter_t SubBuckets = 1ULL << SubBucketBits;
+
+    static size_t BucketIndex( ncounter_t value );
+    static ncounter_t BucketUpperBound( size_t index );
+
+    std::vector<ncounter_t> buckets;
+    ncounter_t count;
+    ncounter_t sum;
+    ncounter_t maxValue;
+};
+
+/*
+ *  Maps a registered member type to its stat kind, print routine and the
+ *  numeric columns it contributes to time-series output. Types not listed
+ *  here are registered as opaque, print as "?????" and have no columns.
+ */
+template<typename T> struct StatTraits
+{
+    static const StatKind kind = STAT_OPAQUE;
+    static void Print( std::ostream& stream, const T& ) { stream << "?????"; }
+
+    static const size_t columns = 0;
+    static const char *ColumnSuffix( size_t ) { return ""; }
+    static double Column( const T&, size_t ) { return 0.0; }
+
+    /* Opaque values are not checkpointed. */
+    static void Save( CheckpointWriter&, const T& ) { }
+    static void Load( CheckpointReader&, T& ) { }
+};
+
+#define NVM_STAT_TRAITS(TYPE, KIND, COLUMNS)                                  \
+template<> struct StatTraits<TYPE>                                            \
+{                                                                             \
+    static const StatKind kind = KIND;                                        \
+    static void Print( std::ostream& stream, const TYPE& v ) { stream << v; } \
+                                                                              \
+    static const size_t columns = COLUMNS;                                    \
+    static const char *ColumnSuffix( size_t ) { return ""; }                  \
+    static double Column( const TYPE& v, size_t )                             \
+    {                                                                         \
+        return StatColumnValue( v );                                          \
+    }                                                                         \
+                                                                              \
+    static void Save( CheckpointWriter& w, const TYPE& v ) { w.Write( v ); }  \
+    static void Load( CheckpointReader& r, TYPE& v ) { r.Read( v ); }         \
+};
+
+inline double StatColumnValue( const std::string& ) { return 0.0; }
+template<typename T> double StatColumnValue( const T& v ) { return static_cast<double>( v ); }
+
+NVM_STAT_TRAITS(int, STAT_COUNTER, 1)
+NVM_STAT_TRAITS(ncounter_t, STAT_COUNTER, 1)
+NVM_STAT_TRAITS(ncounters_t, STAT_COUNTER, 1)
+NVM_STAT_TRAITS(float, STAT_SCALAR, 1)
+NVM_STAT_TRAITS(double, STAT_SCALAR, 1)
+NVM_STAT_TRAITS(std::string, STAT_STRING, 0)
+
+#undef NVM_STAT_TRAITS
+
+template<> struct StatTraits<StatHistogram>
+{
+    static const StatKind kind = STAT_HISTOGRAM;
+    static void Print( std::ostream& stream, const StatHistogram& v ) { stream << v.GetCount( ); }
+
+    static const size_t columns = StatHistogram::SummaryCount;
+    static const char *ColumnSuffix( size_t i ) { return StatHistogram::GetSummaryName( i ); }
+    static double Column( const StatHistogram& v, size_t i ) { return v.GetSummary( i ); }
+
+    static void Save( CheckpointWriter& w, const StatHistogram& v ) { v.Save( w ); }
+    static void Load( CheckpointReader& r, StatHistogram& v ) { v.Load( r ); }
+};
+
+template<> struct StatTraits<StatAverage>
+{
+    static const StatKind kind = STAT_AVERAGE;
+    static void Print( std::ostream& stream, const StatAverage& v ) { stream << v.GetMean( ); }
+
+    static const size_t columns = 1;
+    static const char *ColumnSuffix( size_t ) { return ""; }
+    static double Column( const StatAverage& v, size_t ) { return v.GetMean( ); }
+
+    static void Save( CheckpointWriter& w, const StatAverage& v ) { v.Save( w ); }
+    static void Load( CheckpointReader& r, StatAverage& v ) { v.Load( r ); }
+};
+
+
+/*
+ *  Handle for one registered stat. The registry owns the handles; the
+ *  values themselves live in the objects that registered them.
+ */
 class StatBase
 {
   public:
-    StatBase( ) { }
-    ~StatBase( ) { }
+    StatBase( StatKind k ) : kind(k) { }
+    virtual ~StatBase( ) { }
+
+    virtual void Reset( ) = 0;
+    virtual void PrintValue( std::ostream& stream ) = 0;
+    virtual StatType GetValue( ) = 0;
 
-    void Reset( );
-    void Print( std::ostream& stream, ncounter_t psInterval );
+    /* 
+     *  Numeric columns for time-series output. Column i is named GetName( )
+     *  followed by "." and the suffix, or just GetName( ) if it is empty.
+     */
+    virtual size_t GetColumnCount( ) = 0;
+    virtual const char *GetColumnSuffix( size_t column ) = 0;
+    virtual double GetColumn( size_t column ) = 0;
+
+    /* Raw value for checkpoints; formulas and opaque values save nothing. */
+    virtual void Save( CheckpointWriter& ) { }
+    virtual void Load( CheckpointReader& ) { }
+
+    virtual void Print( std::ostream& stream, ncounter_t psInterval );
 
     std::string GetName( ) { return name; }
     void SetName( std::string n ) { name = n; }
 
-    void* GetValue( ) { return value; }
-    void SetValue( StatType val ) { value = val; }
-
     std::string GetUnits( ) { return units; }
     void SetUnits( std::string u ) { units = u; }
 
-    void SetResetValue( StatType rval ) { resetValue = rval; }
-    void *GetResetValue( ) { return resetValue; }
+    StatKind GetKind( ) { return kind; }
+
+  private:
+    std::string name, units;
+    StatKind kind;
+};
+
+template<typename T>
+class TypedStat : public StatBase
+{
+  public:
+    TypedStat( T *stat ) : StatBase( StatTraits<T>::kind ), value(stat), resetValue(*stat) { }
+
+    void Reset( ) { *value = resetValue; }
+    void PrintValue( std::ostream& stream ) { StatTraits<T>::Print( stream, *value ); }
+    StatType GetValue( ) { return static_cast<StatType>(value); }
+
+    size_t GetColumnCount( ) { return StatTraits<T>::columns; }
+    const char *GetColumnSuffix( size_t column ) { return StatTraits<T>::ColumnSuffix( column ); }
+    double GetColumn( size_t column ) { return StatTraits<T>::Column( *value, column ); }
+
+    void Save( CheckpointWriter& writer ) { StatTraits<T>::Save( writer, *value ); }
+    void Load( CheckpointReader& reader ) { StatTraits<T>::Load( reader, *value ); }
 
-    void SetStatType( std::string st, size_t ts ) { statType = st; typeSize = ts; }
-    size_t GetTypeSize( ) { return typeSize; }
-    std::string GetTypeName() { return statType; }
+    void Print( std::ostream& stream, ncounter_t psInterval ) { StatBase::Print( stream, psInterval ); }
 
   private:
-    std::string name, statType, units;
-    size_t typeSize;
-    StatType resetValue;
-    StatType value;
+    T *value;
+    T resetValue;
+};
+
+/* Histograms print one line per summary value instead of a single line. */
+template<> void TypedStat<StatHistogram>::Print( std::ostream& stream, ncounter_t psInterval );
+
+class FormulaStat : public StatBase
+{
+  public:
+    FormulaStat( std::function<double()> f ) : StatBase( STAT_FORMULA ), formula(f), value(0.0) { }
+
+    void Reset( ) { }
+    void PrintValue( std::ostream& stream ) { stream << Evaluate( ); }
+    StatType GetValue( ) { Evaluate( ); return static_cast<StatType>(&value); }
+
+    size_t GetColumnCount( ) { return 1; }
+    const char *GetColumnSuffix( size_t ) { return ""; }
+    double GetColumn( size_t ) { return Evaluate( ); }
+
+  private:
+    double Evaluate( ) { value = formula( ); return value; }
+
+    std::function<double()> formula;
+    double value;
 };
 
 class Stats
@@ -115,16 +326,45 @@ class Stats
     Stats( );
     ~Stats( );
 
-    void addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units );
+    template<typename T>
+    StatBase *addStat( T *stat, const std::string& owner, const std::string& leaf, const std::string& units )
+    {
+        return registerStat( new TypedStat<T>( stat ), owner, leaf, units );
+    }
+    StatBase *addFormula( std::function<double()> formula, const std::string& owner, const std::string& leaf, const std::string& units );
     void removeStat( StatType stat );
-    StatType getStat( std::string name );
+
+    StatType getStat( const std::string& name );
+    StatType getStat( const std::string& owner, const std::string& leaf );
+    StatBase *getStatHandle( const std::string& name );
+    StatBase *getStatHandle( const std::string& owner, const std::string& leaf );
 
     void PrintAll( std::ostream& );
     void ResetAll( );
 
+    /* Values of all registered stats, matched by name on restore. */
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
+    /* Registered stats in print order, for exporters such as StatsSink. */
+    size_t GetStatCount( ) { return statList.size( ); }
+    StatBase *GetStatByIndex( size_t index ) { return statList[index]; }
+    /* Changes whenever a stat is removed and indices shift. */
+    ncounter_t GetLayoutVersion( ) { return layoutVersion; }
+
   private: 
+    typedef std::unordered_map<std::string, StatBase *> StatIndex;
+
+    StatBase *registerStat( StatBase *stat, const std::string& owner, const std::string& leaf, const std::string& units );
+
+    /* Registration order, which is also the print order. */
     std::vector<StatBase *> statList;
+    /* Lookup by owner StatName and stat name within the owner. */
+    std::unordered_map<std::string, StatIndex> ownerIndex;
+    /* Value address to handle and the length of its owner prefix. */
+    std::unordered_map<StatType, std::pair<StatBase *, size_t> > valueIndex;
     ncounter_t psInterval;
+    ncounter_t layoutVersion;
 };
 
 
@@ -133,4 +373,3 @@ class Stats
 
 #endif
 
-
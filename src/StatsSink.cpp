@@ -0,0 +1,321 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/StatsSink.h"
+#include "src/Config.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace NVM;
+
+namespace {
+
+const uint32_t seriesVersion = 1;
+
+void WriteJSONString( std::ostream& stream, const std::string& s )
+{
+    stream << '"';
+
+    for( size_t i = 0; i < s.size( ); i++ )
+    {
+        if( s[i] == '"' || s[i] == '\\' )
+            stream << '\\';
+        stream << s[i];
+    }
+
+    stream << '"';
+}
+
+}
+
+StatsSink::StatsSink( )
+{
+    stats = NULL;
+    scannedStats = 0;
+    layoutVersion = 0;
+    firstRecord = true;
+}
+
+StatsSink::~StatsSink( )
+{
+    out.close( );
+}
+
+/*
+ *  StatsSeriesFilter is a list of substrings separated by commas. Only
+ *  stats whose name contains one of them are exported. Without a filter
+ *  every numeric stat is exported.
+ */
+StatsSink *StatsSink::CreateSink( Config *conf, Stats *stats )
+{
+    if( !conf->KeyExists( "StatsSeriesFile" ) )
+        return NULL;
+
+    std::string format = "csv";
+    if( conf->KeyExists( "StatsSeriesFormat" ) )
+        format = conf->GetString( "StatsSeriesFormat" );
+
+    StatsSink *sink = NULL;
+    std::ios_base::openmode mode = std::ofstream::out | std::ofstream::trunc;
+
+    if( format == "csv" )
+        sink = new CSVStatsSink( );
+    else if( format == "json" )
+        sink = new JSONStatsSink( );
+    else if( format == "binary" )
+    {
+        sink = new BinaryStatsSink( );
+        mode |= std::ofstream::binary;
+    }
+    else
+    {
+        std::cerr << "NVMain Error: Unknown StatsSeriesFormat `" << format 
+                  << "'. Use csv, json or binary." << std::endl;
+        exit(1);
+    }
+
+    std::string filename = conf->GetString( "StatsSeriesFile" );
+    sink->out.open( filename.c_str( ), mode );
+
+    if( !sink->out.is_open( ) )
+    {
+        std::cerr << "NVMain Error: Could not open StatsSeriesFile `" 
+                  << filename << "'." << std::endl;
+        exit(1);
+    }
+
+    sink->out.precision( 15 );
+    sink->stats = stats;
+
+    if( conf->KeyExists( "StatsSeriesFilter" ) )
+    {
+        std::stringstream filterList( conf->GetString( "StatsSeriesFilter" ) );
+        std::string filter;
+
+        while( std::getline( filterList, filter, ',' ) )
+        {
+            if( !filter.empty( ) )
+                sink->filters.push_back( filter );
+        }
+    }
+
+    if( format == "binary" )
+    {
+        sink->out.write( "NVMS", 4 );
+        sink->out.write( reinterpret_cast<const char *>(&seriesVersion), sizeof(seriesVersion) );
+    }
+
+    return sink;
+}
+
+bool StatsSink::Selected( const std::string& name )
+{
+    bool rv = filters.empty( );
+
+    for( size_t i = 0; i < filters.size( ) && !rv; i++ )
+    {
+        if( name.find( filters[i] ) != std::string::npos )
+            rv = true;
+    }
+
+    return rv;
+}
+
+/* Append columns for stats registered since the last scan. */
+void StatsSink::ScanStats( )
+{
+    /* A removed stat shifts the list, so start over. */
+    if( layoutVersion != stats->GetLayoutVersion( ) )
+    {
+        layoutVersion = stats->GetLayoutVersion( );
+        scannedStats = 0;
+        columns.clear( );
+        columnNames.clear( );
+        lastValues.clear( );
+        firstRecord = true;
+    }
+
+    size_t firstNewColumn = columns.size( );
+
+    for( ; scannedStats < stats->GetStatCount( ); scannedStats++ )
+    {
+        StatBase *stat = stats->GetStatByIndex( scannedStats );
+
+        if( stat->GetColumnCount( ) == 0 || !Selected( stat->GetName( ) ) )
+            continue;
+
+        for( size_t i = 0; i < stat->GetColumnCount( ); i++ )
+        {
+            Column column;
+            std::string suffix = stat->GetColumnSuffix( i );
+
+            column.stat = stat;
+            column.index = i;
+            columns.push_back( column );
+            columnNames.push_back( suffix.empty( ) ? stat->GetName( ) 
+                                                   : stat->GetName( ) + "." + suffix );
+        }
+    }
+
+    if( columns.size( ) != firstNewColumn || firstRecord )
+    {
+        /* New columns have no previous value and are always written. */
+        lastValues.resize( columns.size( ), 0.0 );
+        values.resize( columns.size( ), 0.0 );
+
+        WriteSchema( firstNewColumn );
+    }
+}
+
+void StatsSink::Record( ncycle_t cycle )
+{
+    size_t knownColumns = columns.size( );
+
+    ScanStats( );
+
+    std::vector<size_t> changed;
+
+    for( size_t i = 0; i < columns.size( ); i++ )
+    {
+        values[i] = columns[i].stat->GetColumn( columns[i].index );
+
+        if( firstRecord || i >= knownColumns || values[i] != lastValues[i] )
+        {
+            changed.push_back( i );
+            lastValues[i] = values[i];
+        }
+    }
+
+    firstRecord = false;
+
+    WriteRecord( cycle, changed );
+    out.flush( );
+}
+
+
+void CSVStatsSink::WriteSchema( size_t /*firstNewColumn*/ )
+{
+    out << "cycle";
+
+    for( size_t i = 0; i < columnNames.size( ); i++ )
+        out << "," << columnNames[i];
+
+    out << std::endl;
+}
+
+void CSVStatsSink::WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed )
+{
+    size_t next = 0;
+
+    out << cycle;
+
+    for( size_t i = 0; i < columnNames.size( ); i++ )
+    {
+        out << ",";
+
+        if( next < changed.size( ) && changed[next] == i )
+        {
+            out << values[i];
+            next++;
+        }
+    }
+
+    out << "\n";
+}
+
+
+void JSONStatsSink::WriteSchema( size_t /*firstNewColumn*/ )
+{
+    out << "{\"schema\":[\"cycle\"";
+
+    for( size_t i = 0; i < columnNames.size( ); i++ )
+    {
+        out << ",";
+        WriteJSONString( out, columnNames[i] );
+    }
+
+    out << "]}" << std::endl;
+}
+
+void JSONStatsSink::WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed )
+{
+    out << "{\"cycle\":" << cycle;
+
+    for( size_t i = 0; i < changed.size( ); i++ )
+    {
+        out << ",";
+        WriteJSONString( out, columnNames[changed[i]] );
+        out << ":" << values[changed[i]];
+    }
+
+    out << "}\n";
+}
+
+
+void BinaryStatsSink::WriteSchema( size_t firstNewColumn )
+{
+    uint32_t firstColumn = static_cast<uint32_t>( firstNewColumn );
+    uint32_t newColumns = static_cast<uint32_t>( columnNames.size( ) - firstNewColumn );
+
+    out.put( 'S' );
+    out.write( reinterpret_cast<const char *>(&firstColumn), sizeof(firstColumn) );
+    out.write( reinterpret_cast<const char *>(&newColumns), sizeof(newColumns) );
+
+    for( size_t i = firstNewColumn; i < columnNames.size( ); i++ )
+    {
+        uint32_t length = static_cast<uint32_t>( columnNames[i].size( ) );
+
+        out.write( reinterpret_cast<const char *>(&length), sizeof(length) );
+        out.write( columnNames[i].data( ), length );
+    }
+}
+
+void BinaryStatsSink::WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed )
+{
+    uint64_t recordCycle = cycle;
+    uint32_t count = static_cast<uint32_t>( changed.size( ) );
+
+    out.put( 'R' );
+    out.write( reinterpret_cast<const char *>(&recordCycle), sizeof(recordCycle) );
+    out.write( reinterpret_cast<const char *>(&count), sizeof(count) );
+
+    for( size_t i = 0; i < changed.size( ); i++ )
+    {
+        uint32_t column = static_cast<uint32_t>( changed[i] );
+
+        out.write( reinterpret_cast<const char *>(&column), sizeof(column) );
+        out.write( reinterpret_cast<const char *>(&values[changed[i]]), sizeof(double) );
+    }
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_STATSSINK_H__
+#define __NVM_STATSSINK_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "src/Stats.h"
+#include "include/NVMTypes.h"
+
+namespace NVM {
+
+class Config;
+
+/*
+ *  Time-series export of the numeric stats. Each call to Record( ) writes
+ *  one row holding the current cycle and every column whose value changed
+ *  since the previous row; the first row holds every column. Values are the
+ *  stats as printed (i.e., cumulative since the last reset), not rates.
+ *
+ *  A schema listing the column names is written before the first row and
+ *  again whenever new stats are registered (e.g., lazily built subarrays).
+ *  Formats are selected with StatsSeriesFormat:
+ *
+ *    csv    - A "cycle,<column>,..." header line per schema, then one line
+ *             per row with empty fields for unchanged columns.
+ *    json   - One object per line. Schemas are {"schema":[...]} and rows
+ *             are {"cycle":N,"<column>":value,...}.
+ *    binary - "NVMS" and a uint32_t version, then records tagged 'S' or
+ *             'R'. A schema record has the uint32_t index of its first
+ *             column, a uint32_t column count and each name as a uint32_t
+ *             length and the characters; it replaces the columns from that
+ *             index on. A row has a uint64_t cycle, a uint32_t count and
+ *             that many uint32_t column, double value pairs.
+ */
+class StatsSink
+{
+  public:
+    StatsSink( );
+    virtual ~StatsSink( );
+
+    /* Returns NULL unless StatsSeriesFile is set. */
+    static StatsSink *CreateSink( Config *conf, Stats *stats );
+
+    void Record( ncycle_t cycle );
+
+  protected:
+    std::ofstream out;
+    std::vector<std::string> columnNames;
+    std::vector<double> values;
+
+    virtual void WriteSchema( size_t firstNewColumn ) = 0;
+    virtual void WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed ) = 0;
+
+  private:
+    struct Column
+    {
+        StatBase *stat;
+        size_t index;
+    };
+
+    Stats *stats;
+    std::vector<std::string> filters;
+    std::vector<Column> columns;
+    std::vector<double> lastValues;
+    size_t scannedStats;
+    ncounter_t layoutVersion;
+    bool firstRecord;
+
+    bool Selected( const std::string& name );
+    void ScanStats( );
+};
+
+class CSVStatsSink : public StatsSink
+{
+  protected:
+    void WriteSchema( size_t firstNewColumn );
+    void WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed );
+};
+
+class JSONStatsSink : public StatsSink
+{
+  protected:
+    void WriteSchema( size_t firstNewColumn );
+    void WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed );
+};
+
+class BinaryStatsSink : public StatsSink
+{
+  protected:
+    void WriteSchema( size_t firstNewColumn );
+    void WriteRecord( ncycle_t cycle, const std::vector<size_t>& changed );
+};
+
+};
+
+#endif
@@ -35,16 +35,24 @@
 #include "src/Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Rank.h"
 #include "include/NVMHelpers.h"
 #include "Endurance/EnduranceModelFactory.h"
 #include "Endurance/NullModel/NullModel.h"
 #include "Endurance/Distributions/Normal.h"
+#include "FaultModels/FaultModelFactory.h"
 #include "DataEncoders/DataEncoderFactory.h"
+#include "EnergyModels/EnergyModelFactory.h"
+#include "src/CIMKernels.h"
 
 #include <signal.h>
 #include <cassert>
 #include <iostream>
 #include <limits>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <cstring>
 
 /*
  * Using -O3 in gcc causes the popcount methods to return incorrect values.
@@ -86,6 +94,11 @@ SubArray::SubArray( )
     burstEnergy = 0.0f;
     writeEnergy = 0.0f;
     refreshEnergy = 0.0f;
+    cimEnergy = 0.0f;
+
+    silentWrites = 0;
+    writeEnergySaved = 0.0;
+    writeCyclesSaved = 0;
 
     writeCycle = false;
     writeMode = WRITE_THROUGH;
@@ -117,6 +130,7 @@ SubArray::SubArray( )
     writes = 0;
     activates = 0;
     cim_activates = 0;
+    cimResultOnes = 0;
     precharges = 0;
     cim_precharges = 0;
     refreshes = 0;
@@ -130,6 +144,14 @@ SubArray::SubArray( )
     num10Writes = 0;
     num11Writes = 0;
     mlcTimingHisto = "";
+    packedWriteHisto = "";
+    writeDrivers = 0;
+    activeDrivers = 0;
+    driverPool = NULL;
+    pulseStart = 0;
+    driverWaits = 0;
+    driverWaitCycles = 0;
+    pulseSeed = 1;
     cancelCountHisto = "";
     wpPauseHisto = "";
     wpCancelHisto = "";
@@ -138,24 +160,36 @@ SubArray::SubArray( )
     averageWriteIterations = 1;
 
     endrModel = NULL;
+    faultModel = NULL;
     dataEncoder = NULL;
+    bitCounter = NULL;
 
     subArrayId = -1;
 
     psInterval = 0;
+
+    wordBytes = 0;
+    functionalRowWords = 0;
+    cimLatch = NULL;
+    energyModel = NULL;
+
+    materialized = false;
+    createModels = false;
+    statsRequested = false;
 }
 
 SubArray::~SubArray( )
 {
+    delete [] cimLatch;
+    delete faultModel;
+    delete energyModel;
 }
 
 void SubArray::SetConfig( Config *c, bool createChildren )
 {
     conf = c;
 
-    Params *params = new Params( );
-    params->SetParams( c );
-    SetParams( params );
+    SetParams( c->GetParams( ) );
 
     MATHeight = p->MATHeight;
     /* customize MAT size */
@@ -182,41 +216,120 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         }
     }
 
+    bitCounter = GetBitCountKernel( p->BitCountMethod );
+    if( bitCounter == NULL )
+    {
+        std::cerr << "NVMain Error: BitCountMethod `" << p->BitCountMethod
+                  << "' is unknown or not supported by this host!" << std::endl;
+        exit(1);
+    }
+
+    /* Functional rows span all columns; a column is one memory word. */
+    wordBytes = p->BusWidth * p->tBURST * p->RATE / 8;
+    functionalRowWords = ( p->COLS * wordBytes + sizeof(uint64_t) - 1 )
+                       / sizeof(uint64_t);
+
+    /* Store lines must not straddle columns, so use the word's largest power of two. */
+    ncounter_t lineBytes = wordBytes & ( ~wordBytes + 1 );
+    functionalData.Configure( lineBytes, std::max<ncounter_t>( lineBytes, 4096 ) );
+
+    /*
+     *  A line is spread over all devices of the rank, so a write can use the
+     *  drivers of each device. The chip drivers are pooled by the rank and
+     *  shared by all of its subarrays.
+     */
+    writeDrivers = p->WriteDrivers * MAX( p->BusWidth / p->DeviceWidth, 1 );
+
+    NVMObject_hook *ancestor = GetParent( );
+    while( ancestor != NULL && dynamic_cast<Rank *>( ancestor->GetTrampoline( ) ) == NULL )
+        ancestor = ancestor->GetTrampoline( )->GetParent( );
+
+    if( ancestor != NULL && p->ChipWriteDrivers != 0 )
+        driverPool = dynamic_cast<Rank *>( ancestor->GetTrampoline( ) )->GetWriteDriverPool( );
+
     ncounter_t totalWritePulses = p->nWP00 + p->nWP01 + p->nWP10 + p->nWP11;
     averageWriteIterations = static_cast<ncounter_t>( (totalWritePulses+2)/4 );
+    pulseSeed = MakeSeed( p->RandomSeed, StatName( ) );
 
-    if( createChildren )
+    createModels = createChildren;
+
+    if( !p->LazySubArrays )
+        Materialize( );
+}
+
+/*
+ *  Creates the models and registers the stats of this subarray. With
+ *  LazySubArrays this is deferred until the first command, so subarrays
+ *  which are never accessed only hold their timing state.
+ */
+void SubArray::Materialize( )
+{
+    if( materialized )
+        return;
+
+    materialized = true;
+
+    energyModel = EnergyModelFactory::CreateEnergyModel( p->EnergyModel );
+    energyModel->SetParams( p );
+
+    if( createModels )
     {
         /* We need to create an endurance model at a sub-array level */
         endrModel = EnduranceModelFactory::CreateEnduranceModel( p->EnduranceModel );
         if( endrModel )
         {
-            endrModel->SetConfig( conf, createChildren );
+            endrModel->StatName( StatName( ) + ".endurance" );
+            endrModel->SetConfig( conf, createModels );
             endrModel->SetStats( GetStats( ) );
+
+            /* Worn-out cells are corrected by the fault model, if any. */
+            faultModel = FaultModelFactory::CreateFaultModel( p->FaultModel );
+            if( faultModel )
+            {
+                faultModel->StatName( StatName( ) + ".fault" );
+                faultModel->SetConfig( conf, createModels );
+                faultModel->SetStats( GetStats( ) );
+            }
         }
 
         dataEncoder = DataEncoderFactory::CreateNewDataEncoder( p->DataEncoder );
         if( dataEncoder )
         {
-            dataEncoder->SetConfig( conf, createChildren );
+            dataEncoder->StatName( StatName( ) + ".encoder" );
+            dataEncoder->SetConfig( conf, createModels );
             dataEncoder->SetStats( GetStats( ) );
         }
     }
+
+    if( statsRequested )
+        RegisterStats( );
 }
 
 void SubArray::RegisterStats( )
 {
+    /* Registered by Materialize( ) once the subarray is used. */
+    if( !materialized )
+    {
+        statsRequested = true;
+        return;
+    }
+
     if( endrModel )
     {
         endrModel->RegisterStats( );
     }
 
+    if( faultModel )
+    {
+        faultModel->RegisterStats( );
+    }
+
     if( dataEncoder )
     {
         dataEncoder->RegisterStats( );
     }
 
-    if( p->EnergyModel == "current" )
+    if( energyModel->IsCurrentBased( ) )
     {
         AddUnitStat(subArrayEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -230,6 +343,10 @@ void SubArray::RegisterStats( )
         AddUnitStat(burstEnergy, "nJ");
         AddUnitStat(writeEnergy, "nJ");
         AddUnitStat(refreshEnergy, "nJ");
+        AddUnitStat(cimEnergy, "nJ");
+
+        if( dataEncoder && dataEncoder->DifferentialWrite( ) && p->MLCLevels == 1 )
+            AddUnitStat(writeEnergySaved, "nJ");
     }
 
     AddStat(cancelledWrites);
@@ -251,6 +368,10 @@ void SubArray::RegisterStats( )
     AddStat(cim_precharges);
     AddStat(refreshes);
 
+    /* Set bits of the results returned; these depend on the stored data. */
+    if( p->FunctionalCIM )
+        AddStat(cimResultOnes);
+
     if( endrModel )
     {
         AddStat(worstCaseEndurance);
@@ -269,7 +390,21 @@ void SubArray::RegisterStats( )
     AddStat(averageWriteTime);
     AddStat(measuredWriteTimes);
 
+    if( dataEncoder && dataEncoder->DifferentialWrite( ) )
+    {
+        AddStat(silentWrites);
+        if( p->MLCLevels == 1 )
+            AddStat(writeCyclesSaved);
+    }
+
     AddStat(mlcTimingHisto);
+    if( writeDrivers != 0 || driverPool != NULL )
+        AddStat(packedWriteHisto);
+    if( driverPool != NULL )
+    {
+        AddStat(driverWaits);
+        AddStat(driverWaitCycles);
+    }
     AddStat(cancelCountHisto);
     AddStat(wpPauseHisto);
     AddStat(wpCancelHisto);
@@ -303,86 +438,48 @@ bool SubArray::Activate( NVMainRequest *request )
     }
 
     /* Update timing constraints */
+    ncycle_t tCIM = 0;
+
     if( request->isCIM )
     {
-        // for multiple row activation in a mat
-        //FIXMEstd::cout << "SubArray::Activate received CIM ACTIVATE request!" << std::endl;
-        cim_activates++;
-        //FIXMEnextActivate = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() );
-    }
+        /* Multiple row activation in a mat; the op latency follows tRCD. */
+        if( !p->ValidCIMOperandRows( request ) )
+        {
+            std::cerr << "NVMain Error: CIM operation " 
+                << p->GetCIMOpName( request->GetCIMOp( ) )
+                << " can not activate " << p->GetCIMOperandRows( request )
+                << " operand rows!" << std::endl;
+            return false;
+        }
 
-    if( request->isCIM && (request->isAND_IN_LATCH || request->isNAND_IN_LATCH) )
-    {
-        nextPrecharge = MAX( nextPrecharge, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD + p->tAND, p->tRAS ) );
-        
-        nextRead = MAX( nextRead, 
-                        GetEventQueue()->GetCurrentCycle() 
-                            + p->tRCD + p->tAND - p->tAL );
-        
-        nextWrite = MAX( nextWrite, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + p->tRCD + p->tAND - p->tAL );
+        cim_activates++;
+        tCIM = p->GetCIMLatency( request );
 
-        nextPowerDown = MAX( nextPowerDown, 
-                             GetEventQueue()->GetCurrentCycle() 
-                                 + MAX( p->tRCD + p->tAND, p->tRAS ) );
+        if( p->FunctionalCIM )
+            ComputeCIMResult( request, activateRow );
     }
-    else if( request->isCIM && (request->isOR_IN_LATCH || request->isNOR_IN_LATCH) )
-    {
-        nextPrecharge = MAX( nextPrecharge, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD + p->tOR, p->tRAS ) );
-        
-        nextRead = MAX( nextRead, 
-                        GetEventQueue()->GetCurrentCycle() 
-                            + p->tRCD + p->tOR - p->tAL );
-        
-        nextWrite = MAX( nextWrite, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + p->tRCD + p->tOR - p->tAL );
 
-        nextPowerDown = MAX( nextPowerDown, 
-                             GetEventQueue()->GetCurrentCycle() 
-                                 + MAX( p->tRCD + p->tOR, p->tRAS ) );
-    }
-    else
-    {
-        nextPrecharge = MAX( nextPrecharge, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD, p->tRAS ) );
-        
-        nextRead = MAX( nextRead, 
-                        GetEventQueue()->GetCurrentCycle() 
-                            + p->tRCD - p->tAL );
-        
-        nextWrite = MAX( nextWrite, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + p->tRCD - p->tAL );
+    nextPrecharge = MAX( nextPrecharge, 
+                     GetEventQueue()->GetCurrentCycle() 
+                         + MAX( p->tRCD + tCIM, p->tRAS ) );
+    
+    nextRead = MAX( nextRead, 
+                    GetEventQueue()->GetCurrentCycle() 
+                        + p->tRCD + tCIM - p->tAL );
+    
+    nextWrite = MAX( nextWrite, 
+                     GetEventQueue()->GetCurrentCycle() 
+                         + p->tRCD + tCIM - p->tAL );
 
-        nextPowerDown = MAX( nextPowerDown, 
-                             GetEventQueue()->GetCurrentCycle() 
-                                 + MAX( p->tRCD, p->tRAS ) );
-    }
+    nextPowerDown = MAX( nextPowerDown, 
+                         GetEventQueue()->GetCurrentCycle() 
+                             + MAX( p->tRCD + tCIM, p->tRAS ) );
 
     /* the request is deleted by RequestComplete() */
     request->owner = this;
-    if( request->isCIM && (request->isAND_IN_LATCH || request->isNAND_IN_LATCH) )
-    {
-        GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                        GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tAND );
-    }
-    else if( request->isCIM && (request->isOR_IN_LATCH || request->isNOR_IN_LATCH) )
-    {
-        GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                        GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tOR );
-    }
-    else
-    {
-        GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                        GetEventQueue()->GetCurrentCycle() + p->tRCD );
-    }
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+                    GetEventQueue()->GetCurrentCycle() + p->tRCD + tCIM );
+
     /* 
      * The relative row number is record rather than the absolute row number 
      * within the subarray
@@ -395,37 +492,19 @@ bool SubArray::Activate( NVMainRequest *request )
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
     /* Add to bank's total energy. */
-    if( p->EnergyModel == "current" )
-    {
-        /* DRAM Model */
-        ncycle_t tRC = p->tRAS + p->tRP;
+    double actEnergy = energyModel->GetEventEnergy( ENERGY_ACTIVATE );
 
-        subArrayEnergy += ( ( p->EIDD0 * (double)tRC ) 
-                    - ( ( p->EIDD3N * (double)(p->tRAS) )
-                    +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / (double)(p->BANKS);
+    subArrayEnergy += actEnergy;
+    activeEnergy += actEnergy;
 
-        activeEnergy += ( ( p->EIDD0 * (double)tRC ) 
-                      - ( ( p->EIDD3N * (double)(p->tRAS) )
-                      +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / (double)(p->BANKS);
-    }
-    else
+    /* Add the dynamic energy of the bitwise CIM operation. */
+    if( request->isCIM )
     {
-        /* Flat energy model. */
-        subArrayEnergy += p->Erd;
-        activeEnergy += p->Erd;
-        
-        // added by MSON
-        // add energy for in-latch bitwise operations
-        if( request->isCIM && (request->isAND_IN_LATCH || request->isNAND_IN_LATCH) )
-        {
-            subArrayEnergy += p->Eand;
-            activeEnergy += p->Eand;
-        }
-        else if( request->isCIM && (request->isOR_IN_LATCH || request->isNOR_IN_LATCH) )
-        {
-            subArrayEnergy += p->Eor;
-            activeEnergy += p->Eor;
-        }
+        double opEnergy = energyModel->GetCIMEnergy( request );
+
+        subArrayEnergy += opEnergy;
+        activeEnergy += opEnergy;
+        cimEnergy += opEnergy;
     }
 
     activates++;
@@ -472,9 +551,21 @@ bool SubArray::Read( NVMainRequest *request )
         return false;
     }
 
+    if( p->FunctionalCIM )
+    {
+        if( request->isCIM )
+            ReadCIMResult( request );
+        else
+            LoadFunctionalData( request );
+    }
+
     /* Any additional latency for data encoding. */
     ncycles_t decLat = (dataEncoder ? dataEncoder->Read( request ) : 0);
 
+    /* Any additional latency for correcting worn-out cells. */
+    if( faultModel )
+        decLat += faultModel->Read( request );
+
     /* Update timing constraints */
     if( request->type == READ_PRECHARGE )
     {
@@ -539,20 +630,11 @@ bool SubArray::Read( NVMainRequest *request )
             GetEventQueue()->GetCurrentCycle() + p->tCAS + p->tBURST + decLat );
 
     /* Calculate energy */
-    if( p->EnergyModel == "current" )
-    {
-        /* DRAM Model */
-        subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+    double readEnergy = energyModel->GetEventEnergy( ENERGY_READ );
+
+    subArrayEnergy += readEnergy;
+    burstEnergy += readEnergy;
 
-        burstEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
-    }
-    else
-    {
-        /* Flat Energy Model */
-        subArrayEnergy += p->Eopenrd;
-        
-        burstEnergy += p->Eopenrd;
-    }
     /*
      *  There's no reason to track data if endurance is not modeled.
      */
@@ -615,6 +697,9 @@ bool SubArray::Write( NVMainRequest *request )
         return false;
     }
 
+    if( p->FunctionalCIM )
+        StoreFunctionalData( request );
+
     if( writeMode == WRITE_THROUGH )
     {
         encLat = (dataEncoder ? dataEncoder->Write( request ) : 0);
@@ -623,17 +708,11 @@ bool SubArray::Write( NVMainRequest *request )
         /* Count the number of bits modified. */
         if( !p->WriteAllBits )
         {
-            uint8_t *bitCountData = new uint8_t[request->data.GetSize()];
+            ncounter_t changedCells[2];
 
-            for( uint64_t bitCountByte = 0; bitCountByte < request->data.GetSize(); bitCountByte++ )
-            {
-                bitCountData[bitCountByte] = request->data.GetByte( bitCountByte )
-                                           ^ request->oldData.GetByte( bitCountByte );
-            }
-
-            ncounter_t bitCountWords = request->data.GetSize()/4;
+            CountWrittenCells( request, request->data.GetSize( ), changedCells );
 
-            ncounter_t numChangedBits = CountBitsMLC1( 1, (uint32_t*)bitCountData, bitCountWords );
+            ncounter_t numChangedBits = changedCells[0] + changedCells[1];
 
             assert( request->data.GetSize()*8 >= numChangedBits );
             numUnchangedBits = request->data.GetSize()*8 - numChangedBits;
@@ -767,21 +846,12 @@ bool SubArray::Write( NVMainRequest *request )
     /* Notify owner of write completion as well */
     GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
 
-    /* Calculate energy. */
-    if( p->EnergyModel == "current" )
-    {
-        /* DRAM Model. */
-        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
-
-        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
-    }
-    else
-    {
-        /* Flat energy model. */
-        subArrayEnergy += p->Ewr - p->Ewrpb * numUnchangedBits;
+    /* Calculate energy. The per-bit saving is zero in current based models. */
+    double wrEnergy = energyModel->GetEventEnergy( ENERGY_WRITE );
 
-        burstEnergy += p->Ewr;
-    }
+    subArrayEnergy += wrEnergy 
+                    - energyModel->GetEventEnergy( ENERGY_WRITE_BIT ) * numUnchangedBits;
+    burstEnergy += wrEnergy;
 
     writeCycle = true;
 
@@ -893,23 +963,11 @@ bool SubArray::Refresh( NVMainRequest* request )
     /* set the subarray under refreshing */
     state = SUBARRAY_REFRESHING;
 
-    if( p->EnergyModel == "current" )
-    {
-        /* calibrate the refresh energy since we may have fine-grained refresh */
-        subArrayEnergy += ( ( p->EIDD5B - p->EIDD3N ) 
-                                * (double)(p->tRFC) / (double)(p->BANKS) ); 
-
-        refreshEnergy += ( ( p->EIDD5B - p->EIDD3N ) 
-                                * (double)p->tRFC / (double)(p->BANKS) ); 
-
-        
-    }
-    else
-    {
-        subArrayEnergy += p->Eref;
+    /* calibrate the refresh energy since we may have fine-grained refresh */
+    double refEnergy = energyModel->GetEventEnergy( ENERGY_REFRESH );
 
-        refreshEnergy += p->Eref;
-    }
+    subArrayEnergy += refEnergy;
+    refreshEnergy += refEnergy;
 
     return true;
 }
@@ -1014,12 +1072,144 @@ bool SubArray::BetweenWriteIterations( )
     return rv;
 }
 
+uint64_t SubArray::FunctionalAddress( uint64_t row, uint64_t col )
+{
+    return row * functionalRowWords * sizeof(uint64_t) + col * wordBytes;
+}
+
+/*
+ *  The destination row is overwritten. Columns never touched at the source
+ *  stay invalid, so they are still filled in by their first read.
+ */
+void SubArray::MoveFunctionalRow( uint64_t sourceRow, uint64_t destRow )
+{
+    if( sourceRow == destRow )
+        return;
+
+    functionalData.Move( FunctionalAddress( sourceRow, 0 ), 
+                         FunctionalAddress( destRow, 0 ),
+                         functionalRowWords * sizeof(uint64_t) );
+}
+
+void SubArray::StoreFunctionalData( NVMainRequest *request )
+{
+    uint64_t row, col;
+
+    request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
+
+    if( request->data.rawData == NULL || col >= p->COLS )
+        return;
+
+    uint64_t copyBytes = std::min( request->data.GetSize( ), wordBytes );
+
+    functionalData.Write( FunctionalAddress( row, col ), request->data.rawData, 
+                          copyBytes );
+}
+
+void SubArray::LoadFunctionalData( NVMainRequest *request )
+{
+    uint64_t row, col;
+
+    request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
+
+    if( col >= p->COLS )
+        return;
+
+    /* First touch of this column: the trace/simulator data is the truth. */
+    if( !functionalData.IsValid( FunctionalAddress( row, col ) ) )
+    {
+        StoreFunctionalData( request );
+        return;
+    }
+
+    if( request->data.rawData == NULL )
+        request->data.SetSize( wordBytes );
+
+    uint64_t copyBytes = std::min( request->data.GetSize( ), wordBytes );
+
+    functionalData.Read( FunctionalAddress( row, col ), request->data.rawData, 
+                         copyBytes );
+}
+
+/*
+ *  The operand rows of a CIM operation are the activated row and the rows
+ *  following it in the same subarray. The result stays in the latch until
+ *  the next CIM activation and is returned by the CIM READ.
+ */
+void SubArray::ComputeCIMResult( NVMainRequest *request, uint64_t row )
+{
+    ncounter_t numRows = p->GetCIMOperandRows( request );
+    std::vector<uint64_t *> operands( numRows );
+
+    /* Unwritten operand columns read as zero. */
+    cimOperands.resize( numRows * functionalRowWords );
+
+    for( ncounter_t rowIdx = 0; rowIdx < numRows; rowIdx++ )
+    {
+        operands[rowIdx] = &cimOperands[rowIdx * functionalRowWords];
+        functionalData.Read( FunctionalAddress( (row + rowIdx) % MATHeight, 0 ),
+                             reinterpret_cast<uint8_t *>( operands[rowIdx] ),
+                             functionalRowWords * sizeof(uint64_t) );
+    }
+
+    if( cimLatch == NULL )
+        cimLatch = new uint64_t[functionalRowWords];
+
+    CIMRowKernel( request->GetCIMOp( ), cimLatch, &operands[0], numRows,
+                  functionalRowWords );
+}
+
+void SubArray::ReadCIMResult( NVMainRequest *request )
+{
+    uint64_t col;
+
+    request->address.GetTranslatedAddress( NULL, &col, NULL, NULL, NULL, NULL );
+
+    if( cimLatch == NULL || col >= p->COLS )
+        return;
+
+    if( request->data.rawData == NULL )
+        request->data.SetSize( wordBytes );
+
+    uint64_t copyBytes = std::min( request->data.GetSize( ), wordBytes );
+    uint8_t *word = reinterpret_cast<uint8_t *>( cimLatch ) + col * wordBytes;
+
+    memcpy( request->data.rawData, word, copyBytes );
+
+    cimResultOnes += CountOnes( request->data.rawData, copyBytes );
+}
+
 ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 {
     writeIterationStarts.clear( );
-    uint32_t *rawData = reinterpret_cast<uint32_t*>(request->data.rawData);
+    uint8_t *rawData = request->data.rawData;
     unsigned int memoryWordSize = static_cast<unsigned int>(p->tBURST * p->RATE * p->BusWidth);
-    unsigned int writeBytes32 = memoryWordSize / 32;
+    ncounter_t lineBytes = memoryWordSize / 8;
+
+    /* Only count the data that is actually there. */
+    if( rawData && request->data.GetSize( ) < lineBytes )
+        lineBytes = request->data.GetSize( );
+
+    /* 
+     *  With a differential write only the cells that change are programmed.
+     *  Savings are counted against programming every cell of the line.
+     */
+    bool differential = rawData && dataEncoder && dataEncoder->DifferentialWrite( );
+
+    /* 
+     *  Take what is free of the chip's driver pool, waiting for a driver to
+     *  be released if the other subarrays hold all of them.
+     */
+    pulseStart = GetEventQueue( )->GetCurrentCycle( );
+    activeDrivers = writeDrivers;
+
+    if( driverPool != NULL )
+    {
+        ncounter_t freeDrivers = driverPool->Acquire( pulseStart );
+
+        if( activeDrivers == 0 || freeDrivers < activeDrivers )
+            activeDrivers = freeDrivers;
+    }
 
     if( p->UniformWrites )
     {
@@ -1027,7 +1217,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
         {
             for( ncounter_t iter = 0; iter < averageWriteIterations; iter++ )
             {
-                ncycle_t iterStart = GetEventQueue( )->GetCurrentCycle( );
+                ncycle_t iterStart = pulseStart;
                 iterStart += iter * static_cast<ncycle_t>(p->tWP / averageWriteIterations);
                 writeIterationStarts.insert( iterStart );
             }
@@ -1039,78 +1229,119 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 
         if( rawData )
         {
-            writeCount0 = CountBitsMLC1( 0, rawData, writeBytes32 );
-            writeCount1 = CountBitsMLC1( 1, rawData, writeBytes32 );
+            writeCount1 = CountOnes( rawData, lineBytes );
+            writeCount0 = lineBytes * 8 - writeCount1;
         }
         else
         {
             /* Assume uniformly random data if we don't have data. */
-            writeCount0 = 256;
-            writeCount1 = 256;
+            writeCount0 = memoryWordSize / 2;
+            writeCount1 = memoryWordSize / 2;
         }
 
-        if( p->EnergyModel != "current" )
+        /* Uniform writes take the same time, so only the energy is saved. */
+        double fullEnergy = 0.0;
+
+        if( differential )
         {
-            subArrayEnergy += p->Ereset * writeCount0;
-            subArrayEnergy += p->Eset * writeCount1;
-            writeEnergy += p->Ereset * writeCount0;
-            writeEnergy += p->Eset * writeCount1;
+            ncounter_t writtenCells[2];
+
+            fullEnergy = energyModel->GetCellWriteEnergy( writeCount0, writeCount1, true );
+
+            CountWrittenCells( request, lineBytes, writtenCells );
+            writeCount0 = writtenCells[0];
+            writeCount1 = writtenCells[1];
         }
-        // added by MSON
-        // the cache line size (memoryWordSize) is 512 bits
-        // since we already have the Write Dynamic Energy from Destiny, we add Ereset & Eset from Destiny directly (w/o writeCount0/1)
-        else 
+
+        double cellEnergy = energyModel->GetCellWriteEnergy( writeCount0, writeCount1, true );
+
+        subArrayEnergy += cellEnergy;
+        writeEnergy += cellEnergy;
+
+        if( differential )
         {
-            ncounter_t totalCells = memoryWordSize / 2;  // Number of MLC cells (2 bits each)
-            subArrayEnergy += p->Eset * totalCells;      // Energy to set all cells to LRS
-            subArrayEnergy += p->Ereset * (3.0 * totalCells / 4.0);  // Energy to reset 3/4 of cells to HRS states
-            writeEnergy += p->Eset * totalCells;         // Same for writeEnergy
-            writeEnergy += p->Ereset * (3.0 * totalCells / 4.0);
+            writeEnergySaved += fullEnergy - cellEnergy;
+
+            if( writeCount0 + writeCount1 == 0 )
+                silentWrites++;
         }
 
-        return p->tWP;
+        return HoldWriteDrivers( writeCount0 + writeCount1, p->tWP );
     }
 
     ncycle_t maxDelay = 0;
+    ncounter_t programmedCells = 0;
 
     /* No data... assume all 0. */
     if( !rawData )
-        return p->tWP0;
+        return HoldWriteDrivers( memoryWordSize, p->tWP0 );
 
     /* Check the data for the worst-case write time. */
     if( p->MLCLevels == 1 )
     {
-        ncounter_t writeCount0 = CountBitsMLC1( 0, rawData, writeBytes32 );
-        ncounter_t writeCount1 = CountBitsMLC1( 1, rawData, writeBytes32 );
+        ncounter_t writeCount1 = CountOnes( rawData, lineBytes );
+        ncounter_t writeCount0 = lineBytes * 8 - writeCount1;
+
+        double fullEnergy = 0.0;
+        ncycle_t fullDelay = 0;
 
-        if( p->EnergyModel != "current" )
+        if( differential )
         {
-            subArrayEnergy += p->Ereset * writeCount0;
-            subArrayEnergy += p->Eset * writeCount1;
-            writeEnergy += p->Ereset * writeCount0;
-            writeEnergy += p->Eset * writeCount1;
+            ncounter_t writtenCells[2];
+
+            fullEnergy = energyModel->GetCellWriteEnergy( writeCount0, writeCount1, false );
+            fullDelay = SLCWriteTime( writeCount0, writeCount1 );
+
+            CountWrittenCells( request, lineBytes, writtenCells );
+            writeCount0 = writtenCells[0];
+            writeCount1 = writtenCells[1];
         }
 
-        ncycle_t delay0 = (writeCount0 == 0) ? 0 : p->tWP0;
-        ncycle_t delay1 = (writeCount1 == 0) ? 0 : p->tWP1;
+        double cellEnergy = energyModel->GetCellWriteEnergy( writeCount0, writeCount1, false );
+
+        subArrayEnergy += cellEnergy;
+        writeEnergy += cellEnergy;
+
+        maxDelay = SLCWriteTime( writeCount0, writeCount1 );
+        programmedCells = writeCount0 + writeCount1;
 
-        maxDelay = MAX(delay0, delay1);
+        if( differential )
+        {
+            writeEnergySaved += fullEnergy - cellEnergy;
+            writeCyclesSaved += fullDelay - maxDelay;
+
+            if( writeCount0 + writeCount1 == 0 )
+                silentWrites++;
+        }
     }
     else if( p->MLCLevels == 2 )
     {
-        ncounter_t writeCount00 = CountBitsMLC2( 0, rawData, writeBytes32 );
-        ncounter_t writeCount01 = CountBitsMLC2( 1, rawData, writeBytes32 );
-        ncounter_t writeCount10 = CountBitsMLC2( 2, rawData, writeBytes32 );
-        ncounter_t writeCount11 = CountBitsMLC2( 3, rawData, writeBytes32 );
+        ncounter_t cellCounts[4];
+
+        /* 
+         *  The pulse count of intermediate states is random, so the time a
+         *  differential write saves is not counted for MLC.
+         */
+        if( differential )
+            CountMLC2WrittenCells( request, lineBytes, cellCounts );
+        else
+            CountMLC2Cells( rawData, lineBytes, cellCounts );
 
-        assert( (writeCount00 + writeCount01 + writeCount10 + writeCount11)
-                == (memoryWordSize/2) );
+        ncounter_t writeCount00 = cellCounts[0];
+        ncounter_t writeCount01 = cellCounts[1];
+        ncounter_t writeCount10 = cellCounts[2];
+        ncounter_t writeCount11 = cellCounts[3];
+
+        if( differential && writeCount00 + writeCount01 + writeCount10 + writeCount11 == 0 )
+        {
+            silentWrites++;
+            return 0;
+        }
 
         /* 
-         *  Naive scheduling -- Assume we have enough write drivers for all the data.
-         *  Then, simply choose the max write pulse time as the delay value.
-         *
-         *  TODO -- Tetris the write pulses based on number of write drivers.
+         *  With unlimited write drivers, simply choose the max write pulse 
+         *  time as the delay value. Otherwise the pulses are packed onto the
+         *  drivers (see PackWritePulses).
          */
         ncycle_t oncePulseDelay = 0;
         ncycle_t repeatPulseDelay = 0;
@@ -1135,6 +1366,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 
             NormalDistribution norm;
 
+            norm.SetSeed( static_cast<unsigned int>( ::rand_r( &pulseSeed ) ) );
             norm.SetMean( programPulseCount );
             norm.SetVariance( p->WPVariance );
 
@@ -1169,18 +1401,33 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
             oncePulseDelay = MAX(p->tWP0, p->tWP1);
         }
 
+        programmedCells = writeCount00 + writeCount01 + writeCount10 + writeCount11;
+
         /* Insert times for write cancellation and pausing. */
-        ncycle_t iterStart = GetEventQueue( )->GetCurrentCycle( );
+        ncycle_t iterStart = pulseStart;
         writeIterationStarts.insert( iterStart );
-        iterStart += oncePulseDelay;
 
-        for( ncycle_t iter = 0; iter < thisPulseCount; iter++ )
+        if( activeDrivers != 0 )
         {
-            writeIterationStarts.insert( iterStart );
-            iterStart += repeatPulseDelay;
+            ncounter_t iterCells = writeCount01 + writeCount10;
+            ncounter_t singleCells[2] = { writeCount00, writeCount11 };
+            ncycle_t singlePulse[2] = { p->tWP0, p->tWP1 };
+
+            maxDelay = PackWritePulses( iterCells, oncePulseDelay, repeatPulseDelay,
+                                        thisPulseCount, singleCells, singlePulse, true );
         }
+        else
+        {
+            iterStart += oncePulseDelay;
+
+            for( ncycle_t iter = 0; iter < thisPulseCount; iter++ )
+            {
+                writeIterationStarts.insert( iterStart );
+                iterStart += repeatPulseDelay;
+            }
 
-        maxDelay = oncePulseDelay + thisPulseCount * repeatPulseDelay;
+            maxDelay = oncePulseDelay + thisPulseCount * repeatPulseDelay;
+        }
 
         if( mlcTimingMap.count( maxDelay ) > 0 )
             mlcTimingMap[maxDelay]++;
@@ -1191,7 +1438,168 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
             worstCaseWrite = maxDelay;
     }
 
-    return maxDelay;
+    if( activeDrivers != 0 )
+        packedWriteMap[maxDelay]++;
+
+    return HoldWriteDrivers( programmedCells, maxDelay );
+}
+
+/*
+ *  Holds the pool drivers a write of 'cells' cells uses until its last
+ *  pulse. Returns the write time including the wait for the drivers.
+ */
+ncycle_t SubArray::HoldWriteDrivers( ncounter_t cells, ncycle_t writeTime )
+{
+    ncycle_t driverWait = pulseStart - GetEventQueue( )->GetCurrentCycle( );
+
+    if( driverPool != NULL && writeTime != 0 )
+    {
+        driverPool->Reserve( MIN( activeDrivers, cells ), pulseStart + writeTime );
+
+        if( driverWait != 0 )
+        {
+            driverWaits++;
+            driverWaitCycles += driverWait;
+        }
+    }
+
+    return writeTime + driverWait;
+}
+
+/*
+ *  Write time of a single-level line with the given number of RESET and
+ *  SET cells to program.
+ */
+ncycle_t SubArray::SLCWriteTime( ncounter_t writeCount0, ncounter_t writeCount1 )
+{
+    if( activeDrivers != 0 )
+    {
+        ncounter_t singleCells[2] = { writeCount0, writeCount1 };
+        ncycle_t singlePulse[2] = { p->tWP0, p->tWP1 };
+
+        return PackWritePulses( 0, 0, 0, 0, singleCells, singlePulse, false );
+    }
+
+    ncycle_t delay0 = (writeCount0 == 0) ? 0 : p->tWP0;
+    ncycle_t delay1 = (writeCount1 == 0) ? 0 : p->tWP1;
+
+    return MAX(delay0, delay1);
+}
+
+/*
+ *  Tetris-style packing of the write pulses of one line onto the write
+ *  drivers. Program-and-verify cells (iterCells) go through rounds: an
+ *  initial pulse of firstPulse, then 'iterations' pulses of repeatPulse,
+ *  with a verify barrier after each round. Every round takes as many 
+ *  waves as needed to pulse all of these cells.
+ *
+ *  Single pulse cells (e.g., RESET and SET cells, longest first) are packed
+ *  into the drivers left idle during the rounds. Any that remain are 
+ *  scheduled after the last round onto the least loaded driver.
+ *
+ *  Returns the packed write latency.
+ */
+ncycle_t SubArray::PackWritePulses( ncounter_t iterCells, ncycle_t firstPulse,
+                                    ncycle_t repeatPulse, ncycle_t iterations,
+                                    ncounter_t singleCells[2], ncycle_t singlePulse[2],
+                                    bool recordIterations )
+{
+    ncounter_t remaining[2] = { singleCells[0], singleCells[1] };
+    ncycle_t pulse[2] = { singlePulse[0], singlePulse[1] };
+    ncycle_t elapsed = 0;
+
+    /* Longest single pulse first. */
+    if( pulse[1] > pulse[0] )
+    {
+        std::swap( remaining[0], remaining[1] );
+        std::swap( pulse[0], pulse[1] );
+    }
+
+    /* Cells that need no pulse, e.g., a zero pulse width, take no driver. */
+    for( int type = 0; type < 2; type++ )
+    {
+        if( pulse[type] == 0 )
+            remaining[type] = 0;
+    }
+
+    for( ncycle_t round = 0; iterCells != 0 && round <= iterations; round++ )
+    {
+        ncycle_t roundPulse = (round == 0) ? firstPulse : repeatPulse;
+        ncounter_t waves = (iterCells + activeDrivers - 1) / activeDrivers;
+        ncounter_t lastWave = iterCells - (waves - 1) * activeDrivers;
+
+        if( recordIterations && round != 0 )
+            writeIterationStarts.insert( pulseStart + elapsed );
+
+        /* Drivers idle during the last wave of this round. */
+        ncounter_t idleDrivers = activeDrivers - lastWave;
+        ncycle_t idleTime = roundPulse;
+
+        for( int type = 0; type < 2 && idleDrivers != 0; type++ )
+        {
+            ncounter_t perDriver = (pulse[type] == 0) ? 0 : idleTime / pulse[type];
+
+            if( perDriver == 0 || remaining[type] == 0 )
+                continue;
+
+            ncounter_t placed = MIN( remaining[type], idleDrivers * perDriver );
+            ncounter_t fullDrivers = placed / perDriver;
+            ncounter_t partial = placed % perDriver;
+
+            remaining[type] -= placed;
+
+            /* 
+             *  Fill the time left on each driver with the shorter pulse. Full
+             *  drivers and the partially filled driver have different gaps.
+             */
+            if( type == 0 && remaining[1] != 0 && pulse[1] != 0 )
+            {
+                ncounter_t untouched = idleDrivers - fullDrivers - (partial ? 1 : 0);
+                ncounter_t shortFit = fullDrivers * ((idleTime - perDriver * pulse[0]) / pulse[1])
+                                    + untouched * (idleTime / pulse[1]);
+
+                if( partial )
+                    shortFit += (idleTime - partial * pulse[0]) / pulse[1];
+
+                remaining[1] -= MIN( remaining[1], shortFit );
+                idleDrivers = 0;
+            }
+        }
+
+        elapsed += waves * roundPulse;
+    }
+
+    /* Pack the rest longest first onto the least loaded drivers. */
+    ncounter_t tailCells = remaining[0] + remaining[1];
+
+    if( tailCells != 0 )
+    {
+        ncounter_t drivers = MIN( activeDrivers, tailCells );
+        std::priority_queue<ncycle_t, std::vector<ncycle_t>, std::greater<ncycle_t> > loads;
+        ncycle_t tail = 0;
+
+        if( recordIterations && elapsed != 0 )
+            writeIterationStarts.insert( pulseStart + elapsed );
+
+        for( ncounter_t driver = 0; driver < drivers; driver++ )
+            loads.push( 0 );
+
+        for( int type = 0; type < 2; type++ )
+        {
+            for( ncounter_t cell = 0; cell < remaining[type]; cell++ )
+            {
+                ncycle_t load = loads.top( ) + pulse[type];
+
+                loads.pop( );
+                loads.push( load );
+                tail = MAX( tail, load );
+            }
+        }
+
+        elapsed += tail;
+    }
+
+    return elapsed;
 }
 
 ncycle_t SubArray::NextIssuable( NVMainRequest *request )
@@ -1336,6 +1744,8 @@ bool SubArray::IssueCommand( NVMainRequest *req )
 
     bool rv = false;
 
+    Materialize( );
+
     if( !IsIssuable( req ) )
     {
         std::cerr << "NVMain Error: Command " << req->type << " can not be " 
@@ -1380,6 +1790,48 @@ bool SubArray::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+/*
+ *  Functional access without timing or energy: writes update the stored
+ *  data, the data encoder and the endurance model; CIM reads compute their
+ *  result from the stored operand rows.
+ */
+bool SubArray::IssueAtomic( NVMainRequest *req )
+{
+    uint64_t row;
+
+    Materialize( );
+
+    req->address.GetTranslatedAddress( &row, NULL, NULL, NULL, NULL, NULL );
+
+    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    {
+        if( p->FunctionalCIM )
+            StoreFunctionalData( req );
+
+        if( dataEncoder )
+            dataEncoder->Write( req );
+
+        UpdateEndurance( req );
+    }
+    else if( req->type == READ || req->type == READ_PRECHARGE )
+    {
+        if( p->FunctionalCIM && req->isCIM )
+        {
+            ComputeCIMResult( req, row );
+            ReadCIMResult( req );
+        }
+        else if( p->FunctionalCIM )
+        {
+            LoadFunctionalData( req );
+        }
+
+        if( dataEncoder )
+            dataEncoder->Read( req );
+    }
+
+    return true;
+}
+
 bool SubArray::RequestComplete( NVMainRequest *req )
 {
     //FIXMEif( req->isCIM && req->type == ACTIVATE )
@@ -1534,6 +1986,7 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
             /* Model the endurance */
             hardError = false;
             
+            endrModel->ClearFailedUnits( );
             extraLatency = endrModel->Write( request, oldData );
             if( extraLatency < 0 )
             {
@@ -1544,10 +1997,24 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
 
             latency = static_cast<ncycle_t>(extraLatency);
 
+            if( faultModel )
+            {
+                /* The error is hard only if a failed unit can't be corrected. */
+                const std::vector<uint64_t>& failedUnits = endrModel->GetFailedUnits( );
+                std::vector<uint64_t>::const_iterator it;
+
+                hardError = false;
+                for( it = failedUnits.begin( ); it != failedUnits.end( ); it++ )
+                {
+                    if( !faultModel->Fault( request->address, *it ) )
+                        hardError = true;
+                }
+
+                latency += faultModel->Write( request );
+            }
+
             if( hardError )
             {
-                // TODO: Get extra latency from fault model
-                // latency += ...;
                 std::cout << "WARNING: Write to 0x" << std::hex 
                     << request->address.GetPhysicalAddress( )
                     << std::dec << " resulted in a hard error! " << std::endl;
@@ -1593,6 +2060,13 @@ ncounter_t SubArray::GetId( )
 
 void SubArray::CalculateStats( )
 {
+    /* Untouched subarrays are accounted by the bank. */
+    if( !materialized )
+        return;
+
+    if( dataEncoder )
+        dataEncoder->CalculateStats( );
+
     worstCaseEndurance = endrModel->GetWorstLife( );
     averageEndurance = endrModel->GetAverageLife( );
 
@@ -1600,6 +2074,7 @@ void SubArray::CalculateStats( )
 
     /* Print a histogram as a python-style dict. */
     mlcTimingHisto = PyDictHistogram<uint64_t, uint64_t>( mlcTimingMap );
+    packedWriteHisto = PyDictHistogram<uint64_t, uint64_t>( packedWriteMap );
     cancelCountHisto = PyDictHistogram<uint64_t, uint64_t>( cancelCountMap );
     wpPauseHisto = PyDictHistogram<double, uint64_t>( wpPauseMap );
     wpCancelHisto = PyDictHistogram<double, uint64_t>( wpCancelMap );
@@ -1614,6 +2089,157 @@ void SubArray::Cycle( ncycle_t )
 {
 }
 
+/*
+ *  Count the 1 bits in a line using the selected kernel. With
+ *  BitCountSelfCheck the result is compared against the reference code.
+ */
+ncounter_t SubArray::CountOnes( const uint8_t *data, ncounter_t bytes )
+{
+    ncounter_t count = bitCounter->countOnes( data, bytes );
+
+    if( p->BitCountSelfCheck )
+    {
+        std::vector<uint32_t> words( (bytes + 3) / 4, 0 );
+        if( bytes > 0 )
+            memcpy( &words[0], data, bytes );
+
+        ncounter_t reference = CountBitsMLC1( 1, &words[0], words.size( ) );
+
+        if( count != reference )
+        {
+            std::cerr << "NVMain Error: " << bitCounter->name << " bit count kernel "
+                      << "counted " << count << " ones, expected " << reference 
+                      << "!" << std::endl;
+            exit(1);
+        }
+    }
+
+    return count;
+}
+
+/*
+ *  Count the 00, 01, 10 and 11 cells of a 2-bit MLC line using the
+ *  selected kernel, optionally checked against the reference code.
+ */
+void SubArray::CountMLC2Cells( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] )
+{
+    bitCounter->countMLC2Cells( data, bytes, counts );
+
+    if( p->BitCountSelfCheck )
+    {
+        std::vector<uint32_t> words( (bytes + 3) / 4, 0 );
+        if( bytes > 0 )
+            memcpy( &words[0], data, bytes );
+
+        for( uint8_t value = 0; value < 4; value++ )
+        {
+            ncounter_t reference = CountBitsMLC2( value, &words[0], words.size( ) );
+
+            /* The zero padding of the last word only adds 00 cells. */
+            if( value == 0 )
+                reference -= words.size( ) * 16 - bytes * 4;
+
+            if( counts[value] != reference )
+            {
+                std::cerr << "NVMain Error: " << bitCounter->name << " bit count kernel "
+                          << "counted " << counts[value] << " cells of value " 
+                          << static_cast<int>(value) << ", expected " << reference 
+                          << "!" << std::endl;
+                exit(1);
+            }
+        }
+    }
+}
+
+/*
+ *  The old data of a write, at least bytes long. Old data that is missing
+ *  or shorter reads as zeros.
+ */
+const uint8_t *SubArray::GetOldData( NVMainRequest *request, ncounter_t bytes )
+{
+    NVMDataBlock& oldData = request->oldData;
+
+    if( oldData.IsValid( ) && oldData.rawData != NULL && oldData.GetSize( ) >= bytes )
+        return oldData.rawData;
+
+    paddedOldData.assign( bytes + 1, 0 );
+
+    if( oldData.IsValid( ) && oldData.rawData != NULL )
+        memcpy( &paddedOldData[0], oldData.rawData, oldData.GetSize( ) );
+
+    return &paddedOldData[0];
+}
+
+/*
+ *  Count the cells of a line that a differential write programs: those
+ *  going to 0 in counts[0] and to 1 in counts[1].
+ */
+void SubArray::CountWrittenCells( NVMainRequest *request, ncounter_t bytes, ncounter_t counts[2] )
+{
+    const uint8_t *data = request->data.rawData;
+    const uint8_t *oldData = GetOldData( request, bytes );
+
+    bitCounter->countWrittenCells( data, oldData, bytes, counts );
+
+    if( p->BitCountSelfCheck )
+    {
+        ncounter_t reference[2] = { 0, 0 };
+
+        for( ncounter_t bit = 0; bit < bytes * 8; bit++ )
+        {
+            int newBit = (data[bit / 8] >> (bit % 8)) & 0x1;
+            int oldBit = (oldData[bit / 8] >> (bit % 8)) & 0x1;
+
+            if( newBit != oldBit )
+                reference[newBit]++;
+        }
+
+        if( counts[0] != reference[0] || counts[1] != reference[1] )
+        {
+            std::cerr << "NVMain Error: " << bitCounter->name << " bit count kernel "
+                      << "counted " << counts[0] << "/" << counts[1] << " written "
+                      << "cells, expected " << reference[0] << "/" << reference[1]
+                      << "!" << std::endl;
+            exit(1);
+        }
+    }
+}
+
+/* As above for 2-bit MLC cells, counted by their new value. */
+void SubArray::CountMLC2WrittenCells( NVMainRequest *request, ncounter_t bytes, ncounter_t counts[4] )
+{
+    const uint8_t *data = request->data.rawData;
+    const uint8_t *oldData = GetOldData( request, bytes );
+
+    bitCounter->countMLC2WrittenCells( data, oldData, bytes, counts );
+
+    if( p->BitCountSelfCheck )
+    {
+        ncounter_t reference[4] = { 0, 0, 0, 0 };
+
+        for( ncounter_t cell = 0; cell < bytes * 4; cell++ )
+        {
+            int newCell = (data[cell / 4] >> ((cell % 4) * 2)) & 0x3;
+            int oldCell = (oldData[cell / 4] >> ((cell % 4) * 2)) & 0x3;
+
+            if( newCell != oldCell )
+                reference[newCell]++;
+        }
+
+        for( int value = 0; value < 4; value++ )
+        {
+            if( counts[value] != reference[value] )
+            {
+                std::cerr << "NVMain Error: " << bitCounter->name << " bit count kernel "
+                          << "counted " << counts[value] << " written cells of value " 
+                          << value << ", expected " << reference[value] 
+                          << "!" << std::endl;
+                exit(1);
+            }
+        }
+    }
+}
+
 /*
  *  Count the appearances for "value" for 2-bit MLC where value
  *  can be 0 (binary 00), 1 (binary 01), 2 (binary 10) or 3
@@ -1686,3 +2312,143 @@ ncounter_t NO_OPT SubArray::CountBitsMLC1( uint8_t value, uint32_t *data, ncount
 
     return count;
 }
+
+/*
+ *  Checkpoints are taken drained, so no write can be in progress and only
+ *  timing, row buffer, functional data and model state is saved.
+ */
+void SubArray::CreateCheckpoint( std::string dir )
+{
+    if( isWriting || !writeBackRequests.empty( ) )
+    {
+        std::cerr << "NVMain Error: " << StatName( ) << " cannot be checkpointed "
+                  << "while a write is in progress." << std::endl;
+        exit(1);
+    }
+
+    CheckpointWriter writer( dir, StatName( ) );
+
+    writer.Write( MATHeight );
+    writer.Write( functionalRowWords );
+    writer.Write( materialized );
+
+    writer.Write( state );
+    writer.Write( nextCommand );
+    writer.Write( openRow );
+    writer.Write( lastActivate );
+    writer.Write( nextActivate );
+    writer.Write( nextPrecharge );
+    writer.Write( nextRead );
+    writer.Write( nextWrite );
+    writer.Write( nextPowerDown );
+    writer.Write( writeCycle );
+    writer.Write( writeEnd );
+    writer.Write( writeStart );
+    writer.Write( writeIterationStarts );
+    writer.Write( nextActivatePreWrite );
+    writer.Write( nextPrechargePreWrite );
+    writer.Write( nextReadPreWrite );
+    writer.Write( nextWritePreWrite );
+    writer.Write( nextPowerDownPreWrite );
+    writer.Write( dataCycles );
+    writer.Write( idleTimer );
+    writer.Write( pulseSeed );
+
+    writer.Write( packedWriteMap );
+    writer.Write( mlcTimingMap );
+    writer.Write( cancelCountMap );
+    writer.Write( wpPauseMap );
+    writer.Write( wpCancelMap );
+
+    functionalData.WriteCheckpoint( writer );
+
+    writer.Write( cimLatch != NULL );
+    if( cimLatch != NULL )
+        writer.WriteArray( cimLatch, functionalRowWords );
+
+    writer.Write( endrModel != NULL );
+    if( endrModel != NULL )
+        endrModel->WriteCheckpoint( writer );
+
+    writer.Write( dataEncoder != NULL );
+    if( dataEncoder != NULL )
+        dataEncoder->WriteCheckpoint( writer );
+
+    writer.Write( faultModel != NULL );
+    if( faultModel != NULL )
+        faultModel->WriteCheckpoint( writer );
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void SubArray::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader reader( dir, StatName( ) );
+    ncounter_t savedHeight, savedRowWords;
+    bool savedMaterialized, hasModel;
+
+    reader.Read( savedHeight );
+    reader.Expect( savedHeight, MATHeight, "MATHeight" );
+    reader.Read( savedRowWords );
+    reader.Expect( savedRowWords, functionalRowWords, "functional row words" );
+
+    /* Models and stats of a used subarray must exist before they are filled. */
+    reader.Read( savedMaterialized );
+    if( savedMaterialized )
+        Materialize( );
+
+    reader.Read( state );
+    reader.Read( nextCommand );
+    reader.Read( openRow );
+    reader.Read( lastActivate );
+    reader.Read( nextActivate );
+    reader.Read( nextPrecharge );
+    reader.Read( nextRead );
+    reader.Read( nextWrite );
+    reader.Read( nextPowerDown );
+    reader.Read( writeCycle );
+    reader.Read( writeEnd );
+    reader.Read( writeStart );
+    reader.Read( writeIterationStarts );
+    reader.Read( nextActivatePreWrite );
+    reader.Read( nextPrechargePreWrite );
+    reader.Read( nextReadPreWrite );
+    reader.Read( nextWritePreWrite );
+    reader.Read( nextPowerDownPreWrite );
+    reader.Read( dataCycles );
+    reader.Read( idleTimer );
+    reader.Read( pulseSeed );
+
+    reader.Read( packedWriteMap );
+    reader.Read( mlcTimingMap );
+    reader.Read( cancelCountMap );
+    reader.Read( wpPauseMap );
+    reader.Read( wpCancelMap );
+
+    functionalData.ReadCheckpoint( reader );
+
+    reader.Read( hasModel );
+    if( hasModel )
+    {
+        if( cimLatch == NULL )
+            cimLatch = new uint64_t[functionalRowWords];
+        reader.ReadArray( cimLatch, functionalRowWords );
+    }
+
+    reader.Read( hasModel );
+    reader.Expect( hasModel, endrModel != NULL, "an endurance model" );
+    if( hasModel )
+        endrModel->ReadCheckpoint( reader );
+
+    reader.Read( hasModel );
+    reader.Expect( hasModel, dataEncoder != NULL, "a data encoder" );
+    if( hasModel )
+        dataEncoder->ReadCheckpoint( reader );
+
+    reader.Read( hasModel );
+    reader.Expect( hasModel, faultModel != NULL, "a fault model" );
+    if( hasModel )
+        faultModel->ReadCheckpoint( reader );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
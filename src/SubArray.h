@@ -36,14 +36,20 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 
 #include "src/NVMObject.h"
 #include "src/Config.h"
 #include "src/EnduranceModel.h"
+#include "src/FaultModel.h"
 #include "src/DataEncoder.h"
+#include "src/EnergyModel.h"
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/Params.h"
+#include "src/BitCountKernels.h"
+#include "src/FunctionalMemory.h"
+#include "src/WriteDriverPool.h"
 
 #include <iostream>
 
@@ -91,6 +97,7 @@ class SubArray : public NVMObject
 
     bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     bool IssueCommand( NVMainRequest *req );
+    bool IssueAtomic( NVMainRequest *req );
     bool RequestComplete( NVMainRequest *req );
     ncycle_t NextIssuable( NVMainRequest *request );
 
@@ -122,6 +129,16 @@ class SubArray : public NVMObject
     void Cycle( ncycle_t );
     bool IsWriting( ) { return isWriting; }
 
+    /* False until the first command when LazySubArrays is set. */
+    bool IsMaterialized( ) { return materialized; }
+    void Materialize( );
+
+    /* Relocates the functional contents of a row, e.g., for wear leveling. */
+    void MoveFunctionalRow( uint64_t sourceRow, uint64_t destRow );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     Config *conf;
     ncounter_t psInterval;
@@ -181,19 +198,40 @@ class SubArray : public NVMObject
     double burstEnergy;
     double writeEnergy;
     double refreshEnergy;
+    double cimEnergy;
+
+    /* Savings of differential writes over programming every cell. */
+    ncounter_t silentWrites;
+    double writeEnergySaved;
+    ncounter_t writeCyclesSaved;
+    std::vector<uint8_t> paddedOldData;
 
     uint64_t worstCaseEndurance, averageEndurance;
 
     ncounter_t reads, cim_reads, writes, activates, cim_activates, precharges, cim_precharges, refreshes;
+    ncounter_t cimResultOnes;
     ncounter_t idleTimer;
 
     ncounter_t openRow;
 
     DataEncoder *dataEncoder;
     EnduranceModel *endrModel;
+    FaultModel *faultModel;
+    EnergyModel *energyModel;
+    const BitCountKernel *bitCounter;
 
     ncounter_t subArrayId;
  
+    ncounter_t writeDrivers;
+    unsigned int pulseSeed;
+    ncounter_t activeDrivers;
+    WriteDriverPool *driverPool;
+    ncycle_t pulseStart;
+    ncounter_t driverWaits;
+    ncycle_t driverWaitCycles;
+    std::map<uint64_t, uint64_t> packedWriteMap;
+    std::string packedWriteHisto;
+
     std::map<uint64_t, uint64_t> mlcTimingMap;
     std::map<uint64_t, uint64_t> cancelCountMap;
     std::map<double, uint64_t> wpPauseMap;
@@ -203,11 +241,46 @@ class SubArray : public NVMObject
     std::string wpPauseHisto;
     std::string wpCancelHisto;
 
+    /*
+     *  Functional CIM data path: the contents of each touched row are kept
+     *  in a paged store, one row every functionalRowWords words, so CIM
+     *  operations return the actual bitwise result. A column that was never
+     *  written takes its value from the first read of it.
+     */
+    ncounter_t wordBytes;
+    ncounter_t functionalRowWords;
+    FunctionalMemory functionalData;
+    std::vector<uint64_t> cimOperands;
+    uint64_t *cimLatch;
+
+    bool materialized;
+    bool createModels;
+    bool statsRequested;
+
+    uint64_t FunctionalAddress( uint64_t row, uint64_t col );
+    void StoreFunctionalData( NVMainRequest *request );
+    void LoadFunctionalData( NVMainRequest *request );
+    void ComputeCIMResult( NVMainRequest *request, uint64_t row );
+    void ReadCIMResult( NVMainRequest *request );
+
     ncycle_t WriteCellData( NVMainRequest *request );
+    ncycle_t PackWritePulses( ncounter_t iterCells, ncycle_t firstPulse,
+                              ncycle_t repeatPulse, ncycle_t iterations,
+                              ncounter_t singleCells[2], ncycle_t singlePulse[2],
+                              bool recordIterations );
     void CheckWritePausing( );
 
     ncycle_t UpdateEndurance( NVMainRequest *request );
 
+    ncounter_t CountOnes( const uint8_t *data, ncounter_t bytes );
+    void CountMLC2Cells( const uint8_t *data, ncounter_t bytes, ncounter_t counts[4] );
+    const uint8_t *GetOldData( NVMainRequest *request, ncounter_t bytes );
+    void CountWrittenCells( NVMainRequest *request, ncounter_t bytes, ncounter_t counts[2] );
+    void CountMLC2WrittenCells( NVMainRequest *request, ncounter_t bytes, ncounter_t counts[4] );
+    ncycle_t SLCWriteTime( ncounter_t writeCount0, ncounter_t writeCount1 );
+    ncycle_t HoldWriteDrivers( ncounter_t cells, ncycle_t writeTime );
+
+    /* Reference bit counting used to check the kernels. */
     ncounter_t Count32MLC2( uint8_t value, uint32_t data );
     ncounter_t CountBitsMLC2( uint8_t value, uint32_t *data, ncounter_t words );
     ncounter_t Count32MLC1( uint32_t data );
@@ -0,0 +1,403 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Telemetry.h"
+#include "src/Config.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace NVM;
+
+namespace {
+
+const uint32_t telemetryVersion = 1;
+
+}
+
+Telemetry::Telemetry( )
+{
+    header = NULL;
+    values = NULL;
+    blockSize = 0;
+    mapped = false;
+
+    interval = 0;
+    clock = 1.0;
+
+    lastWallNanoseconds = 0;
+    lastCycle = 0;
+    lastCIMCompleted = 0;
+
+    serverSocket = -1;
+    stopServer = false;
+}
+
+Telemetry::~Telemetry( )
+{
+    if( server.joinable( ) )
+    {
+        stopServer = true;
+        server.join( );
+    }
+
+    if( serverSocket >= 0 )
+    {
+        close( serverSocket );
+        unlink( path.c_str( ) );
+    }
+
+    /* A mapped snapshot file is left behind with the final values. */
+    if( mapped )
+        munmap( header, blockSize );
+    else
+        delete [] reinterpret_cast<uint64_t *>( header );
+}
+
+/*
+ *  TelemetryStats is a list of substrings separated by commas; numeric
+ *  stats of this memory whose names contain one of them are published
+ *  along with the fixed fields. Stats are selected once, at creation.
+ */
+Telemetry *Telemetry::CreateTelemetry( Config *conf, Stats *stats, const std::string& owner )
+{
+    std::string mode = "none";
+    if( conf->KeyExists( "TelemetryMode" ) )
+        mode = conf->GetString( "TelemetryMode" );
+
+    if( mode == "none" )
+        return NULL;
+
+    if( mode != "shm" && mode != "socket" )
+    {
+        std::cerr << "NVMain Error: Unknown TelemetryMode `" << mode 
+                  << "'. Use none, shm or socket." << std::endl;
+        exit(1);
+    }
+
+    if( !conf->KeyExists( "TelemetryPath" ) )
+    {
+        std::cerr << "NVMain Error: TelemetryMode " << mode 
+                  << " requires a TelemetryPath." << std::endl;
+        exit(1);
+    }
+
+    Telemetry *telemetry = new Telemetry( );
+
+    telemetry->path = conf->GetString( "TelemetryPath" );
+    telemetry->clock = static_cast<double>( conf->GetValue( "CLK" ) );
+
+    telemetry->interval = 100000;
+    if( conf->KeyExists( "TelemetryInterval" ) )
+        telemetry->interval = conf->GetValueUL( "TelemetryInterval" );
+
+    if( telemetry->interval == 0 )
+    {
+        std::cerr << "NVMain Error: TelemetryInterval must be at least 1." << std::endl;
+        exit(1);
+    }
+
+    std::vector<std::string> filters;
+    if( conf->KeyExists( "TelemetryStats" ) )
+    {
+        std::stringstream filterList( conf->GetString( "TelemetryStats" ) );
+        std::string filter;
+
+        while( std::getline( filterList, filter, ',' ) )
+        {
+            if( !filter.empty( ) )
+                filters.push_back( filter );
+        }
+    }
+
+    std::vector<std::string> names;
+    std::string prefix = owner + ".";
+    std::string energySuffix = ".totalEnergy";
+
+    for( size_t i = 0; i < stats->GetStatCount( ); i++ )
+    {
+        StatBase *stat = stats->GetStatByIndex( i );
+        std::string name = stat->GetName( );
+
+        if( name.compare( 0, prefix.size( ), prefix ) != 0 || stat->GetColumnCount( ) == 0 )
+            continue;
+
+        if( name.size( ) > energySuffix.size( ) 
+            && name.compare( name.size( ) - energySuffix.size( ), energySuffix.size( ), energySuffix ) == 0 )
+        {
+            telemetry->energyStats.push_back( stat );
+        }
+
+        bool selected = false;
+        for( size_t f = 0; f < filters.size( ) && !selected; f++ )
+            selected = ( name.find( filters[f] ) != std::string::npos );
+
+        if( !selected )
+            continue;
+
+        for( size_t c = 0; c < stat->GetColumnCount( ); c++ )
+        {
+            std::string suffix = stat->GetColumnSuffix( c );
+
+            telemetry->selectedStats.push_back( std::make_pair( stat, c ) );
+            names.push_back( suffix.empty( ) ? name : name + "." + suffix );
+        }
+    }
+
+    telemetry->CreateBlock( names, (mode == "shm") );
+
+    if( mode == "socket" )
+        telemetry->StartServer( );
+
+    telemetry->startTime = std::chrono::steady_clock::now( );
+
+    return telemetry;
+}
+
+void Telemetry::CreateBlock( const std::vector<std::string>& names, bool shared )
+{
+    size_t nameBytes = 0;
+
+    for( size_t i = 0; i < names.size( ); i++ )
+        nameBytes += names[i].size( ) + 1;
+
+    blockSize = sizeof(TelemetryHeader) + names.size( ) * sizeof(double) + nameBytes;
+
+    if( shared )
+    {
+        int fd = open( path.c_str( ), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+        if( fd < 0 || ftruncate( fd, static_cast<off_t>( blockSize ) ) != 0 )
+        {
+            std::cerr << "NVMain Error: Could not create TelemetryPath `" 
+                      << path << "'." << std::endl;
+            exit(1);
+        }
+
+        void *block = mmap( NULL, blockSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        close( fd );
+
+        if( block == MAP_FAILED )
+        {
+            std::cerr << "NVMain Error: Could not map TelemetryPath `" 
+                      << path << "'." << std::endl;
+            exit(1);
+        }
+
+        header = static_cast<TelemetryHeader *>( block );
+        mapped = true;
+    }
+    else
+    {
+        header = reinterpret_cast<TelemetryHeader *>( 
+                    new uint64_t[(blockSize + sizeof(uint64_t) - 1) / sizeof(uint64_t)]( ) );
+    }
+
+    values = reinterpret_cast<double *>( header + 1 );
+
+    header->version = telemetryVersion;
+    header->statCount = static_cast<uint32_t>( names.size( ) );
+    header->nameBytes = static_cast<uint32_t>( nameBytes );
+
+    char *nameTable = reinterpret_cast<char *>( values + names.size( ) );
+    for( size_t i = 0; i < names.size( ); i++ )
+    {
+        memcpy( nameTable, names[i].c_str( ), names[i].size( ) + 1 );
+        nameTable += names[i].size( ) + 1;
+    }
+
+    /* Readers check the magic, so it is written last. */
+    std::atomic_thread_fence( std::memory_order_release );
+    memcpy( header->magic, "NVMX", 4 );
+}
+
+void Telemetry::Publish( const TelemetrySample& sample )
+{
+    uint64_t wallNanoseconds = static_cast<uint64_t>( 
+            std::chrono::duration_cast<std::chrono::nanoseconds>( 
+                std::chrono::steady_clock::now( ) - startTime ).count( ) );
+
+    double wallSeconds = static_cast<double>( wallNanoseconds - lastWallNanoseconds ) / 1e9;
+    double simSeconds = static_cast<double>( sample.cycle - lastCycle ) / (clock * 1e6);
+
+    double energy = 0.0;
+    for( size_t i = 0; i < energyStats.size( ); i++ )
+        energy += energyStats[i]->GetColumn( 0 );
+
+    /* Odd sequence: readers retry until the update is complete. */
+    uint64_t sequence = header->sequence;
+    __atomic_store_n( &header->sequence, sequence + 1, __ATOMIC_RELAXED );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    header->cycle = sample.cycle;
+    header->wallNanoseconds = wallNanoseconds;
+    if( wallSeconds > 0.0 )
+        header->cyclesPerSecond = static_cast<double>( sample.cycle - lastCycle ) / wallSeconds;
+    header->requestsCompleted = sample.requestsCompleted;
+    header->cimCompleted = sample.cimCompleted;
+    if( simSeconds > 0.0 )
+        header->cimPerSecond = static_cast<double>( sample.cimCompleted - lastCIMCompleted ) / simSeconds;
+    header->queueDepth = sample.queueDepth;
+    header->energy = energy;
+
+    for( size_t i = 0; i < selectedStats.size( ); i++ )
+        values[i] = selectedStats[i].first->GetColumn( selectedStats[i].second );
+
+    __atomic_store_n( &header->sequence, sequence + 2, __ATOMIC_RELEASE );
+
+    lastWallNanoseconds = wallNanoseconds;
+    lastCycle = sample.cycle;
+    lastCIMCompleted = sample.cimCompleted;
+}
+
+void Telemetry::StartServer( )
+{
+    struct sockaddr_un address;
+
+    if( path.size( ) >= sizeof(address.sun_path) )
+    {
+        std::cerr << "NVMain Error: TelemetryPath `" << path 
+                  << "' is too long for a socket." << std::endl;
+        exit(1);
+    }
+
+    memset( &address, 0, sizeof(address) );
+    address.sun_family = AF_UNIX;
+    strncpy( address.sun_path, path.c_str( ), sizeof(address.sun_path) - 1 );
+
+    unlink( path.c_str( ) );
+
+    serverSocket = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+    if( serverSocket < 0 
+        || bind( serverSocket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address) ) != 0
+        || listen( serverSocket, 4 ) != 0 )
+    {
+        std::cerr << "NVMain Error: Could not listen on TelemetryPath `" 
+                  << path << "'." << std::endl;
+        exit(1);
+    }
+
+    server = std::thread( &Telemetry::Serve, this );
+}
+
+void Telemetry::Serve( )
+{
+    struct pollfd listener;
+
+    listener.fd = serverSocket;
+    listener.events = POLLIN;
+
+    /* Wake up periodically to notice when the simulation is done. */
+    while( !stopServer )
+    {
+        listener.revents = 0;
+
+        if( poll( &listener, 1, 100 ) <= 0 || !(listener.revents & POLLIN) )
+            continue;
+
+        int client = accept( serverSocket, NULL, NULL );
+
+        if( client >= 0 )
+        {
+            WriteSnapshot( client );
+            close( client );
+        }
+    }
+}
+
+void Telemetry::WriteSnapshot( int client )
+{
+    std::vector<uint64_t> copy( (blockSize + sizeof(uint64_t) - 1) / sizeof(uint64_t) );
+    TelemetryHeader *snapshot = reinterpret_cast<TelemetryHeader *>( &copy[0] );
+
+    /* Seqlock read: copy until no update overlapped the copy. */
+    while( true )
+    {
+        uint64_t before = __atomic_load_n( &header->sequence, __ATOMIC_ACQUIRE );
+
+        if( (before & 1) == 0 )
+        {
+            memcpy( snapshot, header, blockSize );
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            if( __atomic_load_n( &header->sequence, __ATOMIC_RELAXED ) == before )
+                break;
+        }
+
+        std::this_thread::yield( );
+    }
+
+    std::stringstream text;
+    const double *snapshotValues = reinterpret_cast<const double *>( snapshot + 1 );
+    const char *name = reinterpret_cast<const char *>( snapshotValues + snapshot->statCount );
+
+    text.precision( 15 );
+    text << "sequence " << snapshot->sequence << "\n"
+         << "cycle " << snapshot->cycle << "\n"
+         << "wallSeconds " << static_cast<double>( snapshot->wallNanoseconds ) / 1e9 << "\n"
+         << "cyclesPerSecond " << snapshot->cyclesPerSecond << "\n"
+         << "requestsCompleted " << snapshot->requestsCompleted << "\n"
+         << "cimCompleted " << snapshot->cimCompleted << "\n"
+         << "cimPerSecond " << snapshot->cimPerSecond << "\n"
+         << "queueDepth " << snapshot->queueDepth << "\n"
+         << "energy " << snapshot->energy << "\n";
+
+    for( uint32_t i = 0; i < snapshot->statCount; i++ )
+    {
+        text << name << " " << snapshotValues[i] << "\n";
+        name += strlen( name ) + 1;
+    }
+
+    std::string reply = text.str( );
+    size_t sent = 0;
+
+    while( sent < reply.size( ) )
+    {
+        ssize_t rv = send( client, reply.data( ) + sent, reply.size( ) - sent, MSG_NOSIGNAL );
+
+        if( rv <= 0 )
+            break;
+
+        sent += static_cast<size_t>( rv );
+    }
+}
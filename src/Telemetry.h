@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_TELEMETRY_H__
+#define __NVM_TELEMETRY_H__
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/Stats.h"
+#include "include/NVMTypes.h"
+
+namespace NVM {
+
+class Config;
+
+/*
+ *  Fixed part of a telemetry snapshot. It is followed by statCount doubles
+ *  holding the stats selected with TelemetryStats, then by nameBytes of
+ *  their names, each terminated by '\0'.
+ *
+ *  The simulation thread is the only writer. It makes sequence odd, updates
+ *  the snapshot and makes sequence even again, so readers copy the snapshot
+ *  and retry if sequence was odd or changed in the meantime. The writer
+ *  never waits for a reader.
+ */
+struct TelemetryHeader
+{
+    char magic[4];                 /* "NVMX" */
+    uint32_t version;
+    uint32_t statCount;
+    uint32_t nameBytes;
+    uint64_t sequence;
+    uint64_t cycle;                /* Memory cycles simulated */
+    uint64_t wallNanoseconds;      /* Wall clock time since the first snapshot */
+    double cyclesPerSecond;        /* Simulation speed over the last interval */
+    uint64_t requestsCompleted;    /* Requests returned to the front end */
+    uint64_t cimCompleted;         /* CIM requests among them */
+    double cimPerSecond;           /* CIM completions per simulated second */
+    uint64_t queueDepth;           /* Requests waiting in the controllers */
+    double energy;                 /* Sum of the ranks' totalEnergy */
+};
+
+/* Values the owner passes in with each snapshot. */
+struct TelemetrySample
+{
+    ncycle_t cycle;
+    ncounter_t requestsCompleted;
+    ncounter_t cimCompleted;
+    ncounter_t queueDepth;
+};
+
+/*
+ *  Publishes a snapshot of the simulation every TelemetryInterval cycles
+ *  so long runs can be watched while they execute. TelemetryMode selects
+ *  where it goes:
+ *
+ *    shm    - TelemetryPath is a file (e.g., under /dev/shm) holding the
+ *             snapshot, which readers map read-only.
+ *    socket - TelemetryPath is a Unix domain socket. A server thread
+ *             answers each connection with the latest snapshot as
+ *             "name value" lines and closes it. A socket left behind by
+ *             an earlier run is replaced.
+ *
+ *  Scripts/TelemetryReader.py reads either one.
+ */
+class Telemetry
+{
+  public:
+    ~Telemetry( );
+
+    /* Returns NULL unless TelemetryMode is shm or socket. */
+    static Telemetry *CreateTelemetry( Config *conf, Stats *stats, const std::string& owner );
+
+    ncycle_t GetInterval( ) { return interval; }
+
+    void Publish( const TelemetrySample& sample );
+
+  private:
+    Telemetry( );
+
+    TelemetryHeader *header;
+    double *values;
+    size_t blockSize;
+    bool mapped;
+
+    std::string path;
+    ncycle_t interval;
+    double clock;
+
+    std::vector<StatBase *> energyStats;
+    /* Stat handle and column of each selected value. */
+    std::vector<std::pair<StatBase *, size_t> > selectedStats;
+
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t lastWallNanoseconds;
+    ncycle_t lastCycle;
+    ncounter_t lastCIMCompleted;
+
+    int serverSocket;
+    std::thread server;
+    std::atomic<bool> stopServer;
+
+    void CreateBlock( const std::vector<std::string>& names, bool shared );
+    void StartServer( );
+    void Serve( );
+    void WriteSnapshot( int client );
+};
+
+};
+
+#endif
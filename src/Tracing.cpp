@@ -0,0 +1,258 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Tracing.h"
+#include "src/Config.h"
+#include "include/NVMainRequest.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace NVM;
+
+std::atomic<uint32_t> Tracer::nextInstance( 0 );
+
+namespace {
+
+const char *eventNames[TRACE_EVENT_COUNT] = {
+    "MakeActivate",
+    "MakePrecharge",
+    "CommandIssue",
+    "CommandBlocked",
+    "CIMWakeup",
+    "CIMDecode",
+    "CIMCached",
+    "CIMSchedule",
+    "CIMStall",
+    "Issuable",
+    "Enqueue",
+    "Complete",
+    "Drain"
+};
+
+/* File header of a binary trace dump, followed by the records. */
+struct TraceFileHeader
+{
+    char magic[4];           /* "NVMT" */
+    uint32_t recordSize;
+    uint64_t recordCount;
+    uint64_t instance;       /* Tracer that wrote the file */
+};
+
+/* 
+ *  Tracers still alive at exit. The memory system is never torn down, so
+ *  their rings are written from here.
+ */
+struct TracerRegistry
+{
+    std::mutex lock;
+    std::set<Tracer *> tracers;
+
+    ~TracerRegistry( )
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        std::set<Tracer *>::iterator it;
+
+        for( it = tracers.begin( ); it != tracers.end( ); it++ )
+            (*it)->Dump( );
+    }
+};
+
+TracerRegistry traceRegistry;
+
+}
+
+Tracer::Tracer( ) : head( 0 )
+{
+    categoryMask = 0;
+    instance = nextInstance.fetch_add( 1 );
+    dumpInterval = 0;
+    echo = false;
+
+    std::lock_guard<std::mutex> guard( traceRegistry.lock );
+    traceRegistry.tracers.insert( this );
+}
+
+Tracer::~Tracer( )
+{
+    {
+        std::lock_guard<std::mutex> guard( traceRegistry.lock );
+        traceRegistry.tracers.erase( this );
+    }
+
+    Dump( );
+}
+
+/*
+ *  TraceCategories is a list of category names (command, cim, queue or
+ *  all) separated by commas. With TraceEcho each record is also printed
+ *  to stdout when it is added. TraceDumpInterval writes the ring to
+ *  TraceFile.<cycle> every so many cycles while the simulation runs.
+ */
+void Tracer::SetConfig( Config *conf )
+{
+    categoryMask = 0;
+
+    if( conf->KeyExists( "TraceCategories" ) )
+    {
+        std::stringstream categoryList( conf->GetString( "TraceCategories" ) );
+        std::string category;
+
+        while( std::getline( categoryList, category, ',' ) )
+        {
+            if( category == "command" )
+                categoryMask |= TRACE_COMMAND;
+            else if( category == "cim" )
+                categoryMask |= TRACE_CIM;
+            else if( category == "queue" )
+                categoryMask |= TRACE_QUEUE;
+            else if( category == "all" )
+                categoryMask |= TRACE_ALL;
+            else if( category != "none" && !category.empty( ) )
+                std::cout << "NVMain Warning: Unknown trace category `" 
+                          << category << "'." << std::endl;
+        }
+    }
+
+    ncounter_t bufferSize = 65536;
+    if( conf->KeyExists( "TraceBufferSize" ) )
+        bufferSize = conf->GetValueUL( "TraceBufferSize" );
+
+    if( bufferSize == 0 )
+    {
+        std::cerr << "NVMain Error: TraceBufferSize must be at least 1." << std::endl;
+        exit(1);
+    }
+
+    if( conf->KeyExists( "TraceFile" ) )
+        filename = conf->GetString( "TraceFile" );
+
+    if( conf->KeyExists( "TraceEcho" ) )
+        echo = conf->GetBool( "TraceEcho" );
+
+    if( conf->KeyExists( "TraceDumpInterval" ) )
+        dumpInterval = conf->GetValueUL( "TraceDumpInterval" );
+
+    if( dumpInterval != 0 && filename.empty( ) )
+    {
+        std::cerr << "NVMain Error: TraceDumpInterval needs a TraceFile." << std::endl;
+        exit(1);
+    }
+
+    /* Only allocate the ring when something will be traced. */
+    if( categoryMask != 0 && records.size( ) != bufferSize )
+    {
+        records.assign( bufferSize, TraceRecord( ) );
+        head = 0;
+    }
+}
+
+void Tracer::Record( uint32_t category, TraceEvent event, ncycle_t cycle,
+                     NVMainRequest *request, uint64_t arg )
+{
+    uint64_t index = head.fetch_add( 1, std::memory_order_relaxed );
+    TraceRecord& record = records[index % records.size( )];
+
+    record.cycle = cycle;
+    record.address = ( request ) ? request->address.GetPhysicalAddress( ) : 0;
+    record.arg = arg;
+    record.category = category;
+    record.event = static_cast<uint16_t>( event );
+    record.type = ( request ) ? static_cast<uint16_t>( request->type ) : 0;
+
+    if( echo )
+    {
+        std::cout << cycle << " trace " << instance << ": " << GetEventName( event )
+                  << ( ( request && request->isCIM ) ? " CIM" : "" )
+                  << " type " << record.type << " address 0x" << std::hex 
+                  << record.address << std::dec << " arg " << arg << std::endl;
+    }
+}
+
+/*
+ *  Writes the records in the ring, oldest first. Writing does not clear the
+ *  ring, so it can be dumped again later.
+ */
+bool Tracer::Dump( std::string path )
+{
+    FILE *traceFile = fopen( path.c_str( ), "wb" );
+
+    if( traceFile == NULL )
+    {
+        std::cerr << "NVMain Warning: Could not open trace file `" << path
+                  << "'." << std::endl;
+        return false;
+    }
+
+    uint64_t last = head.load( );
+    uint64_t capacity = records.size( );
+    uint64_t first = ( last > capacity ) ? last - capacity : 0;
+
+    TraceFileHeader header;
+    std::memcpy( header.magic, "NVMT", 4 );
+    header.recordSize = sizeof(TraceRecord);
+    header.recordCount = last - first;
+    header.instance = instance;
+
+    bool success = ( fwrite( &header, sizeof(header), 1, traceFile ) == 1 );
+
+    for( uint64_t index = first; index < last && success; index++ )
+    {
+        TraceRecord& record = records[index % capacity];
+
+        success = ( fwrite( &record, sizeof(TraceRecord), 1, traceFile ) == 1 );
+    }
+
+    fclose( traceFile );
+
+    return success;
+}
+
+bool Tracer::Dump( )
+{
+    if( filename.empty( ) )
+        return false;
+
+    return Dump( filename );
+}
+
+const char *Tracer::GetEventName( TraceEvent event )
+{
+    return ( event < TRACE_EVENT_COUNT ) ? eventNames[event] : "Unknown";
+}
@@ -0,0 +1,149 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVM_TRACING_H__
+#define __NVM_TRACING_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "include/NVMTypes.h"
+
+namespace NVM {
+
+class Config;
+class NVMainRequest;
+
+/* Trace categories, enabled at runtime with the TraceCategories key. */
+enum TraceCategory
+{
+    TRACE_COMMAND = 0x1,  /* Commands created and issued by the controller */
+    TRACE_CIM     = 0x2,  /* Compute-in-memory request handling */
+    TRACE_QUEUE   = 0x4,  /* Transaction queue and scheduler decisions */
+    TRACE_ALL     = 0x7
+};
+
+/* What happened. Records hold this id instead of a formatted message. */
+enum TraceEvent
+{
+    TRACE_MAKE_ACTIVATE,     /* arg: - */
+    TRACE_MAKE_PRECHARGE,    /* arg: - */
+    TRACE_COMMAND_ISSUE,     /* arg: command queue */
+    TRACE_COMMAND_BLOCKED,   /* arg: fail reason */
+    TRACE_CIM_WAKEUP,        /* arg: command queue */
+    TRACE_CIM_DECODE,        /* arg: mux level */
+    TRACE_CIM_CACHED,        /* arg: command queue */
+    TRACE_CIM_SCHEDULE,      /* arg: command queue */
+    TRACE_CIM_STALL,         /* arg: command queue */
+    TRACE_ISSUABLE,          /* arg: - */
+    TRACE_ENQUEUE,           /* arg: transaction queue */
+    TRACE_COMPLETE,          /* arg: - */
+    TRACE_DRAIN,             /* arg: 1 when draining writes */
+    TRACE_EVENT_COUNT
+};
+
+/* One trace entry as stored in the ring and written by Dump( ). */
+struct TraceRecord
+{
+    uint64_t cycle;
+    uint64_t address;
+    uint64_t arg;
+    uint32_t category;
+    uint16_t event;
+    uint16_t type;           /* OpType of the request, if any */
+};
+
+/*
+ *  Binary trace ring of one simulated memory system. NVMain creates it and
+ *  every module below reaches it through GetTracer( ), so simulations in
+ *  the same process (e.g., sweep points) each have their own ring and
+ *  instance number. The newest TraceBufferSize records are kept and
+ *  written to TraceFile at exit, every TraceDumpInterval cycles, or on
+ *  request with Dump( ).
+ */
+class Tracer
+{
+  public:
+    Tracer( );
+    ~Tracer( );
+
+    void SetConfig( Config *conf );
+
+    bool Enabled( uint32_t category ) const { return ( categoryMask & category ) != 0; }
+
+    /* The request may be NULL for events which are not about a request. */
+    void Record( uint32_t category, TraceEvent event, ncycle_t cycle,
+                 NVMainRequest *request, uint64_t arg );
+
+    bool Dump( std::string filename );
+    bool Dump( );
+
+    uint32_t GetInstance( ) const { return instance; }
+    std::string GetTraceFile( ) const { return filename; }
+    ncycle_t GetDumpInterval( ) const { return dumpInterval; }
+
+    static const char *GetEventName( TraceEvent event );
+
+  private:
+    uint32_t categoryMask;
+    uint32_t instance;
+    std::vector<TraceRecord> records;
+    std::atomic<uint64_t> head;
+    std::string filename;
+    ncycle_t dumpInterval;
+    bool echo;
+
+    static std::atomic<uint32_t> nextInstance;
+};
+
+};
+
+/*
+ *  Build with NVM_NO_TRACING (scons --disable-tracing) to compile the trace
+ *  points out entirely. Otherwise a disabled category costs one test. Trace
+ *  points are used in NVMObject members, which provide GetTracer( ).
+ */
+#ifdef NVM_NO_TRACING
+#define NVM_TRACE( CATEGORY, EVENT, CYCLE, REQUEST, ARG ) do { } while( 0 )
+#else
+#define NVM_TRACE( CATEGORY, EVENT, CYCLE, REQUEST, ARG )                    \
+    do {                                                                     \
+        NVM::Tracer *tracer_ = GetTracer( );                                 \
+        if( tracer_ != NULL && tracer_->Enabled( CATEGORY ) )                \
+            tracer_->Record( CATEGORY, EVENT, CYCLE, REQUEST, ARG );         \
+    } while( 0 )
+#endif
+
+#endif
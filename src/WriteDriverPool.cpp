@@ -0,0 +1,107 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/WriteDriverPool.h"
+
+using namespace NVM;
+
+WriteDriverPool::WriteDriverPool( )
+{
+    drivers = 0;
+    busyDrivers = 0;
+}
+
+WriteDriverPool::~WriteDriverPool( )
+{
+}
+
+void WriteDriverPool::SetDrivers( ncounter_t drivers )
+{
+    this->drivers = drivers;
+    busyDrivers = 0;
+    releases.clear( );
+}
+
+void WriteDriverPool::Release( ncycle_t now )
+{
+    while( !releases.empty( ) && releases.begin( )->first <= now )
+    {
+        busyDrivers -= releases.begin( )->second;
+        releases.erase( releases.begin( ) );
+    }
+}
+
+/*
+ *  Returns the number of drivers free for a write that wants to start at
+ *  'start', the current cycle. If every driver is busy, 'start' is moved to
+ *  the cycle enough drivers are released. Releases after the current cycle
+ *  are only looked ahead at; they stay held for the writes asked about
+ *  before that cycle.
+ *
+ *  A reservation counts as busy from the cycle it is made, even if its
+ *  write waits for drivers, so a later write never takes drivers that an
+ *  earlier one will use.
+ */
+ncounter_t WriteDriverPool::Acquire( ncycle_t& start )
+{
+    Release( start );
+
+    ncounter_t freedDrivers = 0;
+    std::multimap<ncycle_t, ncounter_t>::iterator it = releases.begin( );
+
+    while( busyDrivers >= drivers + freedDrivers && it != releases.end( ) )
+    {
+        start = it->first;
+
+        for( ; it != releases.end( ) && it->first == start; ++it )
+            freedDrivers += it->second;
+    }
+
+    if( busyDrivers >= drivers + freedDrivers )
+        return 0;
+
+    return drivers + freedDrivers - busyDrivers;
+}
+
+/*
+ *  Holds 'count' drivers from now until cycle 'end'. Call with the start
+ *  cycle returned by Acquire( ) and no more drivers than it returned.
+ */
+void WriteDriverPool::Reserve( ncounter_t count, ncycle_t end )
+{
+    if( count == 0 )
+        return;
+
+    busyDrivers += count;
+    releases.insert( std::pair<ncycle_t, ncounter_t>( end, count ) );
+}
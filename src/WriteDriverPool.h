@@ -0,0 +1,71 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_WRITEDRIVERPOOL_H__
+#define __NVMAIN_WRITEDRIVERPOOL_H__
+
+#include <map>
+#include "include/NVMTypes.h"
+
+namespace NVM {
+
+/*
+ *  Write drivers shared by all subarrays of a chip. A write takes as many
+ *  free drivers as it can use and holds them until its last pulse ends;
+ *  writes that find no free driver wait for the next one to be released.
+ */
+class WriteDriverPool
+{
+  public:
+    WriteDriverPool( );
+    ~WriteDriverPool( );
+
+    void SetDrivers( ncounter_t drivers );
+    ncounter_t GetDrivers( ) { return drivers; }
+
+    ncounter_t Acquire( ncycle_t& start );
+    void Reserve( ncounter_t count, ncycle_t end );
+
+  private:
+    ncounter_t drivers;
+    ncounter_t busyDrivers;
+
+    /* Drivers held by in-flight writes, keyed by the cycle they are freed. */
+    std::multimap<ncycle_t, ncounter_t> releases;
+
+    void Release( ncycle_t now );
+};
+
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/DecodedTrace/DecodedTraceReader.h"
+#include <cstring>
+
+using namespace NVM;
+
+DecodedTrace::DecodedTrace( )
+{
+    traceFile = "";
+}
+
+DecodedTrace::~DecodedTrace( )
+{
+
+}
+
+void DecodedTrace::Load( GenericTraceReader *reader, bool keepData )
+{
+    TraceLine line;
+
+    traceFile = reader->GetTraceFile( );
+
+    while( reader->GetNextAccess( &line ) )
+    {
+        Access access;
+
+        access.address = line.GetAddress( ).GetPhysicalAddress( );
+        access.cycle = line.GetCycle( );
+        access.threadId = line.GetThreadId( );
+        access.operandRows = line.GetOperandRows( );
+        access.operation = line.GetOperation( );
+        access.dataOffset = payload.size( );
+        access.dataSize = access.oldDataSize = 0;
+        access.dataValid = access.oldDataValid = false;
+
+        if( keepData )
+        {
+            StoreBlock( line.GetData( ), access.dataSize, access.dataValid );
+            StoreBlock( line.GetOldData( ), access.oldDataSize, access.oldDataValid );
+        }
+
+        accesses.push_back( access );
+    }
+}
+
+void DecodedTrace::StoreBlock( NVMDataBlock& block, uint32_t& size, bool& valid )
+{
+    valid = block.IsValid( );
+    size = 0;
+
+    if( block.rawData != NULL && block.GetSize( ) > 0 )
+    {
+        size = static_cast<uint32_t>( block.GetSize( ) );
+        payload.insert( payload.end( ), block.rawData, block.rawData + size );
+    }
+}
+
+void DecodedTrace::LoadBlock( NVMDataBlock& block, uint32_t size, bool valid,
+                              size_t& offset ) const
+{
+    if( size > 0 )
+    {
+        block.SetSize( size );
+        memcpy( block.rawData, &payload[offset], size );
+        offset += size;
+    }
+
+    block.SetValid( valid );
+}
+
+std::string DecodedTrace::GetTraceFile( ) const
+{
+    return traceFile;
+}
+
+size_t DecodedTrace::GetLength( ) const
+{
+    return accesses.size( );
+}
+
+void DecodedTrace::GetLine( size_t index, TraceLine *line ) const
+{
+    const Access& access = accesses[index];
+    NVMAddress address;
+    NVMDataBlock dataBlock;
+    NVMDataBlock oldDataBlock;
+    size_t offset = access.dataOffset;
+
+    address.SetPhysicalAddress( access.address );
+    LoadBlock( dataBlock, access.dataSize, access.dataValid, offset );
+    LoadBlock( oldDataBlock, access.oldDataSize, access.oldDataValid, offset );
+
+    line->SetLine( address, access.operation, access.cycle, dataBlock, 
+                   oldDataBlock, access.threadId );
+    line->SetOperandRows( access.operandRows );
+}
+
+DecodedTraceReader::DecodedTraceReader( const DecodedTrace *decoded )
+{
+    this->decoded = decoded;
+    position = 0;
+}
+
+DecodedTraceReader::~DecodedTraceReader( )
+{
+
+}
+
+void DecodedTraceReader::SetTraceFile( std::string /*file*/ )
+{
+    /* The trace was already decoded; the file cannot change. */
+}
+
+std::string DecodedTraceReader::GetTraceFile( )
+{
+    return decoded->GetTraceFile( );
+}
+
+bool DecodedTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( position >= decoded->GetLength( ) )
+    {
+        /* Same "dummy" line the file readers hand back at the end. */
+        NVMAddress nAddress;
+        NVMDataBlock dataBlock;
+        NVMDataBlock oldDataBlock;
+
+        nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+        nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
+        return false;
+    }
+
+    decoded->GetLine( position, nextAccess );
+    position++;
+
+    return true;
+}
+
+int DecodedTraceReader::GetNextNAccesses( unsigned int N, 
+                                          std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
@@ -0,0 +1,106 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __DECODEDTRACEREADER_H__
+#define __DECODEDTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  A whole trace decoded into memory by one of the regular trace readers.
+ *  Nothing changes after Load( ), so any number of DecodedTraceReaders may
+ *  replay it at the same time, e.g., one per configuration in a sweep.
+ */
+class DecodedTrace
+{
+  public:
+    DecodedTrace( );
+    ~DecodedTrace( );
+
+    /* Decode every line from reader. Data blocks are dropped unless keepData. */
+    void Load( GenericTraceReader *reader, bool keepData );
+
+    std::string GetTraceFile( ) const;
+    size_t GetLength( ) const;
+    void GetLine( size_t index, TraceLine *line ) const;
+
+  private:
+    struct Access
+    {
+        uint64_t address;
+        ncycle_t cycle;
+        ncounters_t threadId;
+        ncounter_t operandRows;
+        OpType operation;
+        uint32_t dataSize;
+        uint32_t oldDataSize;
+        bool dataValid;
+        bool oldDataValid;
+        size_t dataOffset;
+    };
+
+    std::string traceFile;
+    std::vector<Access> accesses;
+    std::vector<uint8_t> payload;
+
+    void StoreBlock( NVMDataBlock& block, uint32_t& size, bool& valid );
+    void LoadBlock( NVMDataBlock& block, uint32_t size, bool valid, 
+                    size_t& offset ) const;
+};
+
+/* Replays a DecodedTrace from the beginning; each reader has its own position. */
+class DecodedTraceReader : public GenericTraceReader
+{
+  public:
+    DecodedTraceReader( const DecodedTrace *decoded );
+    ~DecodedTraceReader( );
+    
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+    
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccess );
+  
+  private:
+    const DecodedTrace *decoded;
+    size_t position;
+};
+
+};
+
+#endif
@@ -68,6 +68,9 @@ std::string NVMainTraceReader::GetTraceFile( )
  *  This trace is printed from nvmain.cpp. The format is:
  *
  *  CYCLE OP ADDRESS DATA THREADID
+ *
+ *  CIM operations may append the number of operand rows to activate to
+ *  the operation, e.g., "AND_IN_ARRAY:4".
  */
 bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
 {
@@ -98,6 +101,7 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
     NVMDataBlock dataBlock;
     NVMDataBlock oldDataBlock;
     unsigned int threadId = 0;
+    ncounter_t operandRows = 0;
     
     /* There are no more lines in the trace... Send back a "dummy" line */
     getline( trace, fullLine );
@@ -138,6 +142,14 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
                 cycle = atoi( field.c_str( ) );
             else if( fieldId == 1 )
             {
+                size_t rowsPos = field.find( ':' );
+
+                if( rowsPos != std::string::npos )
+                {
+                    operandRows = strtoul( field.substr( rowsPos + 1 ).c_str( ), NULL, 10 );
+                    field = field.substr( 0, rowsPos );
+                }
+
                 if( field == "R" )
                     operation = READ;
                 else if( field == "W" )
@@ -270,6 +282,7 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
     nAddress.SetPhysicalAddress( address );
 
     nextAccess->SetLine( nAddress, operation, cycle, dataBlock, oldDataBlock, threadId );
+    nextAccess->SetOperandRows( operandRows );
 
     return true;
 }
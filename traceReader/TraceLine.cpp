@@ -45,6 +45,7 @@ TraceLine::TraceLine( )
     operation = NOP;
     cycle = 0;
     threadId = 0;
+    operandRows = 0;
 }
 
 TraceLine::~TraceLine( )
@@ -94,3 +95,14 @@ ncounters_t TraceLine::GetThreadId( )
 {
     return threadId;
 }
+
+/* Number of rows a CIM operation activates. 0 means use the config default. */
+void TraceLine::SetOperandRows( ncounter_t rows )
+{
+    operandRows = rows;
+}
+
+ncounter_t TraceLine::GetOperandRows( )
+{
+    return operandRows;
+}
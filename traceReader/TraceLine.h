@@ -57,6 +57,9 @@ class TraceLine
     NVMDataBlock& GetOldData( );
     ncounters_t GetThreadId( );
 
+    void SetOperandRows( ncounter_t rows );
+    ncounter_t GetOperandRows( );
+
   private:
     NVMAddress address;
     OpType operation;
@@ -64,6 +67,7 @@ class TraceLine
     NVMDataBlock data;
     NVMDataBlock oldData;
     ncounters_t threadId;
+    ncounter_t operandRows;
 };
 
 };
@@ -0,0 +1,158 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceSim/Sampling.h"
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+using namespace NVM;
+
+/* Two-sided 95% Student's t values for 1 to 30 degrees of freedom. */
+static const double tTable95[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+SampleResults::SampleResults( )
+{
+
+}
+
+SampleResults::~SampleResults( )
+{
+
+}
+
+void SampleResults::SetMetrics( const std::vector<std::string>& metricNames )
+{
+    names = metricNames;
+}
+
+size_t SampleResults::GetMetricCount( ) const
+{
+    return names.size( );
+}
+
+void SampleResults::AddWindow( uint64_t index, const std::vector<double>& values )
+{
+    windows[index] = values;
+}
+
+std::string SampleResults::Encode( uint64_t index, const std::vector<double>& values )
+{
+    std::stringstream line;
+
+    line << std::setprecision( std::numeric_limits<double>::digits10 + 2 ) << index;
+    for( size_t i = 0; i < values.size( ); i++ )
+        line << " " << values[i];
+    line << "\n";
+
+    return line.str( );
+}
+
+bool SampleResults::Decode( const std::string& line )
+{
+    std::istringstream fields( line );
+    std::vector<double> values( names.size( ) );
+    uint64_t index;
+
+    if( !(fields >> index) )
+        return false;
+
+    for( size_t i = 0; i < values.size( ); i++ )
+    {
+        if( !(fields >> values[i]) )
+            return false;
+    }
+
+    AddWindow( index, values );
+
+    return true;
+}
+
+void SampleResults::Summarize( size_t metric, double& mean, double& halfWidth )
+{
+    std::map<uint64_t, std::vector<double> >::iterator it;
+    double sum = 0.0, sumSquares = 0.0;
+    double n = static_cast<double>( windows.size( ) );
+
+    mean = 0.0;
+    halfWidth = 0.0;
+
+    if( windows.empty( ) )
+        return;
+
+    for( it = windows.begin( ); it != windows.end( ); it++ )
+        sum += it->second[metric];
+    mean = sum / n;
+
+    if( windows.size( ) < 2 )
+        return;
+
+    for( it = windows.begin( ); it != windows.end( ); it++ )
+        sumSquares += ( it->second[metric] - mean ) * ( it->second[metric] - mean );
+
+    size_t df = windows.size( ) - 1;
+    double t = ( df <= 30 ) ? tTable95[df - 1] : 1.96;
+
+    halfWidth = t * sqrt( sumSquares / ( n - 1.0 ) ) / sqrt( n );
+}
+
+void SampleResults::Print( std::ostream& stream, uint64_t totalRequests )
+{
+    stream << "sampling.windows " << windows.size( ) << std::endl;
+    stream << "sampling.requests " << totalRequests << std::endl;
+
+    for( size_t i = 0; i < names.size( ); i++ )
+    {
+        double mean, halfWidth;
+
+        Summarize( i, mean, halfWidth );
+
+        stream << "sampling." << names[i] << " " << mean << std::endl;
+        stream << "sampling." << names[i] << ".ci95 " << halfWidth << std::endl;
+
+        if( names[i] == "cyclesPerRequest" )
+        {
+            double requests = static_cast<double>( totalRequests );
+
+            stream << "sampling.estimatedCycles " << mean * requests << std::endl;
+            stream << "sampling.estimatedCycles.ci95 " << halfWidth * requests 
+                   << std::endl;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __TRACESIM_SAMPLING_H__
+#define __TRACESIM_SAMPLING_H__
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  Results of a sampled simulation (SamplePeriod). Each detailed window
+ *  gives one value per metric. The report has the mean over all windows and
+ *  a 95% confidence interval.
+ */
+class SampleResults
+{
+  public:
+    SampleResults( );
+    ~SampleResults( );
+
+    void SetMetrics( const std::vector<std::string>& metricNames );
+    size_t GetMetricCount( ) const;
+
+    void AddWindow( uint64_t index, const std::vector<double>& values );
+
+    /* Forked windows send their values back as a single line of text. */
+    static std::string Encode( uint64_t index, const std::vector<double>& values );
+    bool Decode( const std::string& line );
+
+    /* Whole-trace estimates are the per-request means scaled by requests. */
+    void Print( std::ostream& stream, uint64_t totalRequests );
+
+  private:
+    std::vector<std::string> names;
+    std::map<uint64_t, std::vector<double> > windows;
+
+    void Summarize( size_t metric, double& mean, double& halfWidth );
+};
+
+};
+
+#endif
@@ -35,12 +35,22 @@
 #include <cmath>
 #include <stdlib.h>
 #include <fstream>
+#include <thread>
+#include <map>
+#include <algorithm>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "src/Config.h"
+#include "src/Checkpoint.h"
 #include "src/TranslationMethod.h"
 #include "traceReader/TraceReaderFactory.h"
+#include "traceReader/DecodedTrace/DecodedTraceReader.h"
 #include "src/AddressTranslator.h"
 #include "Decoders/DecoderFactory.h"
 #include "src/MemoryController.h"
@@ -52,6 +62,7 @@
 #include "src/EventQueue.h"
 #include "NVM/nvmain.h"
 #include "traceSim/traceMain.h"
+#include "traceSim/Sampling.h"
 
 using namespace NVM;
 
@@ -62,9 +73,18 @@ int main( int argc, char *argv[] )
     return traceRunner->RunTrace( argc, argv );
 }
 
+/* System construction touches process-wide state, so it is never concurrent. */
+std::mutex TraceMain::setupMutex;
+
 TraceMain::TraceMain( )
 {
+    outstandingRequests = 0;
 
+    measuring = false;
+    measureStart = 0;
+    lastCompletion = 0;
+    measuredRequests = 0;
+    measuredLatency = 0.0;
 }
 
 TraceMain::~TraceMain( )
@@ -74,19 +94,10 @@ TraceMain::~TraceMain( )
 
 int TraceMain::RunTrace( int argc, char *argv[] )
 {
-    Stats *stats = new Stats( );
     Config *config = new Config( );
     GenericTraceReader *trace = NULL;
-    TraceLine *tl = new TraceLine( );
-    SimInterface *simInterface = new NullInterface( );
-    NVMain *nvmain = new NVMain( );
-    EventQueue *mainEventQueue = new EventQueue( );
-    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
-    TagGenerator *tagGenerator = new TagGenerator( 1000 );
-    bool IgnoreData = false;
-
     uint64_t simulateCycles;
-    uint64_t currentCycle;
+    int rv;
     
     if( argc < 4 )
     {
@@ -104,12 +115,6 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << std::endl << std::endl;
 
     config->Read( argv[1] );
-    config->SetSimInterface( simInterface );
-    SetEventQueue( mainEventQueue );
-    SetGlobalEventQueue( globalEventQueue );
-    SetStats( stats );
-    SetTagGenerator( tagGenerator );
-    std::ofstream statStream;
 
     /* Allow for overriding config parameter values for trace simulations from command line. */
     if( argc > 4 )
@@ -128,12 +133,71 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         }
     }
 
+    if( argc == 3 )
+        simulateCycles = 0;
+    else
+        simulateCycles = atoi( argv[3] );
+
+    if( config->KeyExists( "SweepGrid" ) )
+    {
+        rv = RunSweep( config, argv[2], simulateCycles );
+
+        delete config;
+
+        return rv;
+    }
+
+    std::ofstream statStream;
+
     if( config->KeyExists( "StatsFile" ) )
     {
         statStream.open( config->GetString( "StatsFile" ).c_str(), 
                          std::ofstream::out | std::ofstream::app );
     }
 
+    if( config->KeyExists( "TraceReader" ) )
+        trace = TraceReaderFactory::CreateNewTraceReader( 
+                config->GetString( "TraceReader" ) );
+    else
+        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    trace->SetTraceFile( argv[2] );
+
+    std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
+    rv = Simulate( config, trace, simulateCycles, refStream );
+
+    delete config;
+
+    return rv;
+}
+
+/*
+ *  Builds a memory system from config and feeds it the trace. Each call uses
+ *  its own TraceMain, event queues and stats, so separate TraceMains may
+ *  simulate on separate threads once their setup is done.
+ */
+int TraceMain::Simulate( Config *config, GenericTraceReader *trace,
+                         uint64_t simulateCycles, std::ostream& statStream )
+{
+    Stats *stats = new Stats( );
+    TraceLine *tl = new TraceLine( );
+    SimInterface *simInterface = new NullInterface( );
+    NVMain *nvmain = new NVMain( );
+    EventQueue *mainEventQueue = new EventQueue( );
+    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
+    TagGenerator *tagGenerator = new TagGenerator( 1000 );
+    bool IgnoreData = false;
+
+    uint64_t currentCycle;
+
+    std::unique_lock<std::mutex> setupLock( setupMutex );
+
+    config->SetSimInterface( simInterface );
+    SetEventQueue( mainEventQueue );
+    SetGlobalEventQueue( globalEventQueue );
+    SetStats( stats );
+    SetTagGenerator( tagGenerator );
+
     if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
     {
         IgnoreData = true;
@@ -173,19 +237,6 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << "traceMain (" << (void*)(this) << ")" << std::endl;
     nvmain->PrintHierarchy( );
 
-    if( config->KeyExists( "TraceReader" ) )
-        trace = TraceReaderFactory::CreateNewTraceReader( 
-                config->GetString( "TraceReader" ) );
-    else
-        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
-
-    trace->SetTraceFile( argv[2] );
-
-    if( argc == 3 )
-        simulateCycles = 0;
-    else
-        simulateCycles = atoi( argv[3] );
-
     std::cout << "*** Simulating " << simulateCycles << " input cycles. (";
 
     /*
@@ -197,9 +248,120 @@ int TraceMain::RunTrace( int argc, char *argv[] )
 
     std::cout << simulateCycles << " memory cycles) ***" << std::endl;
 
+    /* Settings used per request are read once here, not in the loop. */
+    bool ignoreTraceCycle = ( config->KeyExists( "IgnoreTraceCycle" ) 
+                              && config->GetBool( "IgnoreTraceCycle" ) );
+
+    /* 
+     *  Warm-up skipping: save the whole system once the trace reaches
+     *  CheckpointCycle, or start from a saved system with CheckpointRestore.
+     */
+    std::string checkpointDir = "";
+    uint64_t checkpointCycle = 0;
+    bool checkpointRestore = false;
+    uint64_t traceLines = 0;
+
+    if( config->KeyExists( "CheckpointDirectory" ) )
+        checkpointDir = config->GetString( "CheckpointDirectory" );
+    if( config->KeyExists( "CheckpointCycle" ) )
+        checkpointCycle = config->GetValueUL( "CheckpointCycle" );
+    if( config->KeyExists( "CheckpointRestore" ) )
+        checkpointRestore = config->GetBool( "CheckpointRestore" );
+
+    if( (checkpointCycle != 0 || checkpointRestore) && checkpointDir == "" )
+    {
+        std::cerr << "NVMain Error: CheckpointCycle and CheckpointRestore "
+                  << "require a CheckpointDirectory." << std::endl;
+        exit(1);
+    }
+
+    /* Everything is configured now, so any key still unread is suspect. */
+    config->CheckKeys( );
+
+    setupLock.unlock( );
+
     currentCycle = 0;
+
+    if( checkpointRestore )
+    {
+        nvmain->RestoreCheckpoint( checkpointDir );
+
+        CheckpointReader reader( checkpointDir, "traceMain" );
+        ncycle_t globalCycle;
+
+        reader.Read( globalCycle );
+        reader.Read( currentCycle );
+        reader.Read( traceLines );
+
+        globalEventQueue->SetCurrentCycle( globalCycle );
+
+        /* Trace readers only go forward, so skip the lines already issued. */
+        for( uint64_t line = 0; line < traceLines; line++ )
+        {
+            if( !trace->GetNextAccess( tl ) )
+            {
+                std::cerr << "NVMain Error: The trace ends before the "
+                          << traceLines << " lines issued when the checkpoint "
+                          << "was taken." << std::endl;
+                exit(1);
+            }
+        }
+
+        std::cout << "Restored checkpoint from " << checkpointDir 
+                  << " at cycle " << currentCycle << "." << std::endl;
+    }
+
+    if( config->KeyExists( "SamplePeriod" ) )
+    {
+        if( checkpointCycle != 0 )
+        {
+            std::cerr << "NVMain Error: CheckpointCycle can not be used with "
+                      << "SamplePeriod." << std::endl;
+            exit(1);
+        }
+
+        int rv = SimulateSampled( config, trace, globalEventQueue, simulateCycles,
+                                  IgnoreData, ignoreTraceCycle, statStream );
+
+        delete stats;
+
+        return rv;
+    }
+
     while( currentCycle <= simulateCycles || simulateCycles == 0 )
     {
+        if( checkpointCycle != 0 && currentCycle >= checkpointCycle 
+            && !checkpointRestore )
+        {
+            /* 
+             *  Stop issuing until every request is done, including those
+             *  the hooks issue on their own, then save.
+             */
+            while( outstandingRequests > 0 || !HooksIdle( ) )
+            {
+                globalEventQueue->Cycle( 1 );
+                currentCycle = globalEventQueue->GetCurrentCycle( );
+            }
+
+            /* Let the controllers clean up the last completed commands. */
+            globalEventQueue->Cycle( 1 );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+
+            mkdir( checkpointDir.c_str( ), 0755 );
+            nvmain->CreateCheckpoint( checkpointDir );
+
+            CheckpointWriter writer( checkpointDir, "traceMain" );
+
+            writer.Write( globalEventQueue->GetCurrentCycle( ) );
+            writer.Write( currentCycle );
+            writer.Write( traceLines );
+
+            std::cout << "Saved checkpoint to " << checkpointDir 
+                      << " at cycle " << currentCycle << "." << std::endl;
+
+            checkpointCycle = 0;
+        }
+
         if( !trace->GetNextAccess( tl ) )
         {
             /* Force all modules to drain requests. */
@@ -223,72 +385,18 @@ int TraceMain::RunTrace( int argc, char *argv[] )
             break;
         }
 
-        NVMainRequest *request = new NVMainRequest( );
-        
-        request->address = tl->GetAddress( );
-        request->type = tl->GetOperation( );
-        request->bulkCmd = CMD_NOP;
-        request->threadId = tl->GetThreadId( );
-        if( !IgnoreData ) request->data = tl->GetData( );
-        if( !IgnoreData ) request->oldData = tl->GetOldData( );
-        request->status = MEM_REQUEST_INCOMPLETE;
-        request->owner = (NVMObject *)this;
+        traceLines++;
+
+        NVMainRequest *request = MakeRequest( tl, IgnoreData );
         
         /* 
          * If you want to ignore the cycles used in the trace file, just set
          * the cycle to 0. 
          */
-        if( config->KeyExists( "IgnoreTraceCycle" ) 
-                && config->GetString( "IgnoreTraceCycle" ) == "true" )
+        if( ignoreTraceCycle )
             tl->SetLine( tl->GetAddress( ), tl->GetOperation( ), 0, 
                          tl->GetData( ), tl->GetOldData( ), tl->GetThreadId( ) );
         
-        // commented by MSON
-        //FIXMEif( request->type != READ && request->type != WRITE )
-        //FIXME    std::cout << "traceMain: Unknown Operation: " << request->type 
-        //FIXME        << std::endl;
-        
-        // added by MSON
-        if (request->type == NOT_IN_ARRAY || request->type == AND_IN_ARRAY || request->type == AND_IN_LATCH || request->type == OR_IN_LATCH 
-                || request->type == NAND_IN_LATCH || request->type == NOR_IN_LATCH || request->type == XOR_IN_LATCH)
-        {
-            //FIXMEstd::cout << "traceMain received CIM request!" << std::endl;
-            request->isCIM = true;
-            switch (request->type)
-            {
-                case NOT_IN_ARRAY:
-                    request->type = READ;
-                    request->isNOT_IN_ARRAY = true;
-                    break;
-                case AND_IN_ARRAY:
-                    request->type = READ;
-                    request->isAND_IN_ARRAY = true;
-                    break;
-                case AND_IN_LATCH:
-                    request->type = READ;
-                    request->isAND_IN_LATCH = true;
-                    break;
-                case OR_IN_LATCH:
-                    request->type = READ;
-                    request->isOR_IN_LATCH = true;
-                    break;
-                case NAND_IN_LATCH:
-                    request->type = READ;
-                    request->isNAND_IN_LATCH = true;
-                    break;
-                case NOR_IN_LATCH:
-                    request->type = READ;
-                    request->isNOR_IN_LATCH = true;
-                    break;
-                case XOR_IN_LATCH:
-                    request->type = READ;
-                    request->isXOR_IN_LATCH = true;
-                    break;
-                default:
-                    std::cout << "traceMain: CIM request type is not supported: " << request->type << std::endl; 
-            }
-        }
-        
         /* 
          * If the next operation occurs after the requested number of cycles,
          * we can quit. 
@@ -339,8 +447,7 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     }       
 
     GetChild( )->CalculateStats( );
-    std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
-    stats->PrintAll( refStream );
+    stats->PrintAll( statStream );
 
     std::cout << "Exiting at cycle " << currentCycle << " because simCycles " 
         << simulateCycles << " reached." << std::endl; 
@@ -348,12 +455,689 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         std::cout << "Note: " << outstandingRequests << " requests still in-flight."
                   << std::endl;
 
-    delete config;
     delete stats;
 
     return 0;
 }
 
+/*
+ *  Sweep mode: SweepGrid names a file listing one parameter per line followed
+ *  by the values to try, e.g., "ClosePage 0 1 2". Every combination of values
+ *  is one point, run as an independent system on top of the base config. The
+ *  trace is decoded once and shared by all points, which run on SweepThreads
+ *  threads. Point N prints its stats to SweepOutput.N.txt and the settings of
+ *  each point are listed in SweepOutput.index.
+ */
+int TraceMain::RunSweep( Config *config, std::string traceFile, 
+                         uint64_t simulateCycles )
+{
+    SweepJob job;
+    std::vector<std::string> gridKeys;
+    std::vector<std::vector<std::string> > gridValues;
+    std::string gridFile = config->GetString( "SweepGrid" );
+
+    /* Same rule as CONFIG_CHANNEL: relative paths start at the config file. */
+    if( gridFile[0] != '/' )
+        gridFile = NVM::GetFilePath( config->GetFileName( ) ) + gridFile;
+
+    std::ifstream grid( gridFile.c_str( ) );
+
+    if( !grid.is_open( ) )
+    {
+        std::cerr << "NVMain Error: Could not read sweep grid: " << gridFile
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string line;
+
+    while( getline( grid, line ) )
+    {
+        std::istringstream lineStream( line.substr( 0, line.find( ';' ) ) );
+        std::string key, value;
+        std::vector<std::string> values;
+
+        if( !(lineStream >> key) )
+            continue;
+
+        while( lineStream >> value )
+            values.push_back( value );
+
+        if( values.empty( ) )
+        {
+            std::cerr << "NVMain Error: Sweep parameter " << key 
+                      << " has no values." << std::endl;
+            exit(1);
+        }
+
+        gridKeys.push_back( key );
+        gridValues.push_back( values );
+    }
+
+    /* Enumerate every combination; the last parameter changes fastest. */
+    job.points.resize( 1 );
+
+    for( size_t keyIdx = 0; keyIdx < gridKeys.size( ); keyIdx++ )
+    {
+        std::vector<SweepPoint> expanded;
+
+        for( size_t pointIdx = 0; pointIdx < job.points.size( ); pointIdx++ )
+        {
+            for( size_t valueIdx = 0; valueIdx < gridValues[keyIdx].size( ); valueIdx++ )
+            {
+                SweepPoint point = job.points[pointIdx];
+
+                point.push_back( std::make_pair( gridKeys[keyIdx], 
+                                                 gridValues[keyIdx][valueIdx] ) );
+                expanded.push_back( point );
+            }
+        }
+
+        job.points.swap( expanded );
+    }
+
+    job.outputPrefix = "sweep";
+    if( config->KeyExists( "SweepOutput" ) )
+        job.outputPrefix = config->GetString( "SweepOutput" );
+
+    std::string indexFile = job.outputPrefix + ".index";
+    std::ofstream index( indexFile.c_str( ), std::ofstream::out | std::ofstream::trunc );
+
+    if( !index.is_open( ) )
+    {
+        std::cerr << "NVMain Error: Could not write sweep index: " << indexFile
+                  << std::endl;
+        exit(1);
+    }
+
+    for( size_t pointIdx = 0; pointIdx < job.points.size( ); pointIdx++ )
+    {
+        index << pointIdx;
+        for( size_t keyIdx = 0; keyIdx < job.points[pointIdx].size( ); keyIdx++ )
+        {
+            index << " " << job.points[pointIdx][keyIdx].first << "="
+                  << job.points[pointIdx][keyIdx].second;
+        }
+        index << std::endl;
+    }
+
+    index.close( );
+
+    /* Decode the trace once. Data is only kept if some point could use it. */
+    GenericTraceReader *reader;
+    DecodedTrace decoded;
+
+    if( config->KeyExists( "TraceReader" ) )
+        reader = TraceReaderFactory::CreateNewTraceReader( 
+                config->GetString( "TraceReader" ) );
+    else
+        reader = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    reader->SetTraceFile( traceFile );
+    decoded.Load( reader, !( config->KeyExists( "IgnoreData" ) 
+                             && config->GetBool( "IgnoreData" ) ) );
+    delete reader;
+
+    unsigned int threadCount = std::thread::hardware_concurrency( );
+
+    if( config->KeyExists( "SweepThreads" ) && config->GetValue( "SweepThreads" ) > 0 )
+        threadCount = static_cast<unsigned int>( config->GetValue( "SweepThreads" ) );
+
+    if( threadCount == 0 )
+        threadCount = 1;
+    if( threadCount > job.points.size( ) )
+        threadCount = static_cast<unsigned int>( job.points.size( ) );
+
+    std::cout << "*** Sweeping " << job.points.size( ) << " configurations over "
+              << decoded.GetLength( ) << " trace lines on " << threadCount
+              << " threads ***" << std::endl;
+
+    job.baseConfig = config;
+    job.trace = &decoded;
+    job.simulateCycles = simulateCycles;
+    job.nextPoint = 0;
+
+    std::vector<std::thread> workers;
+
+    for( unsigned int threadIdx = 0; threadIdx < threadCount; threadIdx++ )
+        workers.push_back( std::thread( &TraceMain::SweepWorker, &job ) );
+
+    for( unsigned int threadIdx = 0; threadIdx < threadCount; threadIdx++ )
+        workers[threadIdx].join( );
+
+    return 0;
+}
+
+void TraceMain::SweepWorker( SweepJob *job )
+{
+    size_t pointIdx;
+
+    while( (pointIdx = job->nextPoint++) < job->points.size( ) )
+    {
+        const SweepPoint& point = job->points[pointIdx];
+        Config *pointConfig;
+
+        {
+            std::lock_guard<std::mutex> guard( setupMutex );
+
+            pointConfig = new Config( *job->baseConfig );
+
+            std::cout << "Sweep point " << pointIdx << ":";
+            for( size_t keyIdx = 0; keyIdx < point.size( ); keyIdx++ )
+            {
+                pointConfig->SetValue( point[keyIdx].first, point[keyIdx].second );
+                std::cout << " " << point[keyIdx].first << "=" << point[keyIdx].second;
+            }
+            std::cout << std::endl;
+
+            /* Points run side by side, so each writes its own files. */
+            const char *fileKeys[] = { "TraceFile", "EnduranceBackingFile", 
+                                       "FunctionalBackingFile", "StatsSeriesFile",
+                                       "TelemetryPath", "CheckpointDirectory" };
+
+            for( size_t keyIdx = 0; keyIdx < sizeof(fileKeys) / sizeof(fileKeys[0]); keyIdx++ )
+            {
+                if( pointConfig->KeyExists( fileKeys[keyIdx] ) )
+                {
+                    std::stringstream fileName;
+
+                    fileName << pointConfig->GetString( fileKeys[keyIdx] ) << "." << pointIdx;
+                    pointConfig->SetValue( fileKeys[keyIdx], fileName.str( ) );
+                }
+            }
+        }
+
+        std::stringstream statName;
+        statName << job->outputPrefix << "." << pointIdx << ".txt";
+
+        std::ofstream statStream( statName.str( ).c_str( ), 
+                                  std::ofstream::out | std::ofstream::trunc );
+
+        if( !statStream.is_open( ) )
+        {
+            std::cerr << "NVMain Error: Could not write sweep stats: " 
+                      << statName.str( ) << std::endl;
+            exit(1);
+        }
+
+        /* 
+         *  As in a normal run the system is never torn down (NVMain has no
+         *  complete teardown), so memory use grows with the point count.
+         */
+        DecodedTraceReader reader( job->trace );
+        TraceMain *runner = new TraceMain( );
+
+        runner->Simulate( pointConfig, &reader, job->simulateCycles, statStream );
+    }
+}
+
+/*
+ *  Sampled simulation for traces too long to simulate in detail. Out of
+ *  every SamplePeriod trace lines, the last SampleWarmup + SampleLength run
+ *  in detail and the lines before them are fast-forwarded as atomic
+ *  requests, which keep the stored data, encoders and wear up to date but
+ *  take no time. Each window reports the average latency and cycles per
+ *  request of its last SampleLength lines, plus any stats matching
+ *  SampleStats; the report has their means and 95% confidence intervals.
+ *
+ *  With SampleFork, every window runs in a child process started from a
+ *  copy-on-write snapshot of the system, so the windows run in parallel
+ *  while this process keeps fast-forwarding.
+ */
+int TraceMain::SimulateSampled( Config *config, GenericTraceReader *trace, 
+                                GlobalEventQueue *globalEventQueue, 
+                                uint64_t simulateCycles, bool ignoreData, 
+                                bool ignoreTraceCycle, std::ostream& statStream )
+{
+    uint64_t samplePeriod = config->GetValueUL( "SamplePeriod" );
+    uint64_t sampleLength = 1000;
+    uint64_t sampleWarmup = 0;
+    bool sampleFork = false;
+    unsigned int sampleProcesses = 0;
+
+    if( config->KeyExists( "SampleLength" ) )
+        sampleLength = config->GetValueUL( "SampleLength" );
+    if( config->KeyExists( "SampleWarmup" ) )
+        sampleWarmup = config->GetValueUL( "SampleWarmup" );
+    if( config->KeyExists( "SampleFork" ) )
+        sampleFork = config->GetBool( "SampleFork" );
+    if( config->KeyExists( "SampleProcesses" ) )
+        sampleProcesses = static_cast<unsigned int>( config->GetValueUL( "SampleProcesses" ) );
+
+    if( sampleProcesses == 0 )
+        sampleProcesses = std::max( 1u, std::thread::hardware_concurrency( ) );
+
+    /* A forked window would write through the shared mapping into ours. */
+    if( sampleFork && ( config->KeyExists( "EnduranceBackingFile" ) 
+                        || config->KeyExists( "FunctionalBackingFile" ) ) )
+    {
+        std::cerr << "NVMain Error: SampleFork can not be used with "
+                  << "EnduranceBackingFile or FunctionalBackingFile." << std::endl;
+        exit(1);
+    }
+
+    if( sampleLength == 0 || sampleWarmup + sampleLength > samplePeriod )
+    {
+        std::cerr << "NVMain Error: SampleWarmup + SampleLength must be between "
+                  << "1 and SamplePeriod (" << samplePeriod << ")." << std::endl;
+        exit(1);
+    }
+
+    /* A child's output would be interleaved with this process' output. */
+    if( sampleFork && ( config->KeyExists( "StatsSeriesFile" ) 
+                        || ( config->KeyExists( "TelemetryMode" ) 
+                             && config->GetString( "TelemetryMode" ) != "none" ) ) )
+    {
+        std::cerr << "NVMain Error: SampleFork can not be used with "
+                  << "StatsSeriesFile or TelemetryMode." << std::endl;
+        exit(1);
+    }
+
+    /* Stats reported per window, selected like TelemetryStats. */
+    std::vector<std::pair<StatBase *, size_t> > sampleStats;
+    std::vector<std::string> metricNames;
+
+    metricNames.push_back( "averageLatency" );
+    metricNames.push_back( "cyclesPerRequest" );
+
+    if( config->KeyExists( "SampleStats" ) )
+    {
+        std::stringstream filterList( config->GetString( "SampleStats" ) );
+        std::vector<std::string> filters;
+        std::string filter;
+
+        while( std::getline( filterList, filter, ',' ) )
+        {
+            if( !filter.empty( ) )
+                filters.push_back( filter );
+        }
+
+        for( size_t i = 0; i < GetStats( )->GetStatCount( ); i++ )
+        {
+            StatBase *stat = GetStats( )->GetStatByIndex( i );
+            std::string name = stat->GetName( );
+            bool selected = false;
+
+            for( size_t f = 0; f < filters.size( ) && !selected; f++ )
+                selected = ( name.find( filters[f] ) != std::string::npos );
+
+            if( !selected )
+                continue;
+
+            for( size_t c = 0; c < stat->GetColumnCount( ); c++ )
+            {
+                std::string suffix = stat->GetColumnSuffix( c );
+
+                sampleStats.push_back( std::make_pair( stat, c ) );
+                metricNames.push_back( suffix.empty( ) ? name : name + "." + suffix );
+            }
+        }
+    }
+
+    SampleResults results;
+    results.SetMetrics( metricNames );
+
+    std::cout << "*** Sampling " << sampleWarmup << " + " << sampleLength 
+        << " of every " << samplePeriod << " requests" 
+        << ( sampleFork ? " in forked processes" : "" ) << " ***" << std::endl;
+
+    size_t windowSize = static_cast<size_t>( sampleWarmup + sampleLength );
+    std::vector<TraceLine *> window( windowSize );
+    for( size_t i = 0; i < windowSize; i++ )
+        window[i] = new TraceLine( );
+
+    /* Running children: pid and the read end of their result pipe. */
+    std::map<pid_t, int> children;
+
+    uint64_t totalRequests = 0;
+    uint64_t windowIndex = 0;
+    bool traceDone = false;
+
+    while( !traceDone )
+    {
+        /* Fast-forward to the next window. */
+        for( uint64_t line = 0; line < samplePeriod - windowSize && !traceDone; line++ )
+        {
+            if( !trace->GetNextAccess( window[0] ) 
+                || ( window[0]->GetCycle( ) > simulateCycles && simulateCycles != 0 ) )
+            {
+                traceDone = true;
+                break;
+            }
+
+            NVMainRequest *request = MakeRequest( window[0], ignoreData );
+            GetChild( )->IssueAtomic( request );
+            delete request;
+
+            totalRequests++;
+        }
+
+        /* Buffer the window; a forked child must not share the trace file. */
+        size_t count = 0;
+        while( count < windowSize && !traceDone )
+        {
+            if( !trace->GetNextAccess( window[count] ) 
+                || ( window[count]->GetCycle( ) > simulateCycles && simulateCycles != 0 ) )
+            {
+                traceDone = true;
+                break;
+            }
+
+            count++;
+        }
+
+        totalRequests += count;
+
+        if( count <= sampleWarmup )
+            break;
+
+        if( sampleFork )
+        {
+            int resultPipe[2];
+
+            while( children.size( ) >= sampleProcesses )
+                CollectSample( children, results );
+
+            std::cout.flush( );
+            statStream.flush( );
+
+            pid_t pid = -1;
+            if( pipe( resultPipe ) == 0 )
+                pid = fork( );
+
+            if( pid < 0 )
+            {
+                std::cerr << "NVMain Error: Could not fork a sample window process."
+                          << std::endl;
+                exit(1);
+            }
+            else if( pid == 0 )
+            {
+                std::vector<double> values;
+                std::string result;
+
+                close( resultPipe[0] );
+
+                if( RunWindow( window, count, static_cast<size_t>( sampleWarmup ),
+                               globalEventQueue, ignoreData, ignoreTraceCycle, 
+                               sampleStats, values ) )
+                {
+                    result = SampleResults::Encode( windowIndex, values );
+                }
+
+                size_t written = 0;
+                while( written < result.size( ) )
+                {
+                    ssize_t bytes = write( resultPipe[1], result.data( ) + written, 
+                                           result.size( ) - written );
+                    if( bytes <= 0 )
+                        break;
+                    written += static_cast<size_t>( bytes );
+                }
+
+                std::cout.flush( );
+                _exit( 0 );
+            }
+
+            close( resultPipe[1] );
+            children[pid] = resultPipe[0];
+
+            /* This process only keeps the functional state up to date. */
+            for( size_t i = 0; i < count; i++ )
+            {
+                NVMainRequest *request = MakeRequest( window[i], ignoreData );
+                GetChild( )->IssueAtomic( request );
+                delete request;
+            }
+        }
+        else
+        {
+            std::vector<double> values;
+
+            if( RunWindow( window, count, static_cast<size_t>( sampleWarmup ),
+                           globalEventQueue, ignoreData, ignoreTraceCycle, 
+                           sampleStats, values ) )
+            {
+                results.AddWindow( windowIndex, values );
+            }
+        }
+
+        windowIndex++;
+    }
+
+    while( !children.empty( ) )
+        CollectSample( children, results );
+
+    for( size_t i = 0; i < windowSize; i++ )
+        delete window[i];
+
+    GetChild( )->CalculateStats( );
+    GetStats( )->PrintAll( statStream );
+    results.Print( statStream, totalRequests );
+
+    std::cout << "Exiting after " << totalRequests << " requests in " 
+        << windowIndex << " sample periods." << std::endl;
+
+    return 0;
+}
+
+/*
+ *  Waits for a sample window process to finish and adds its results. The
+ *  pipe is drained before the child is reaped: a child whose results do
+ *  not fit in the pipe buffer cannot exit until they are read.
+ */
+void TraceMain::CollectSample( std::map<pid_t, int>& children, SampleResults& results )
+{
+    std::vector<struct pollfd> fds;
+    std::map<pid_t, int>::iterator it;
+
+    for( it = children.begin( ); it != children.end( ); it++ )
+    {
+        struct pollfd fd;
+
+        fd.fd = it->second;
+        fd.events = POLLIN;
+        fd.revents = 0;
+        fds.push_back( fd );
+    }
+
+    /* Take the first child with results ready, or the oldest if poll fails. */
+    it = children.begin( );
+
+    if( poll( &fds[0], fds.size( ), -1 ) > 0 )
+    {
+        for( size_t i = 0; i < fds.size( ); i++ )
+        {
+            if( fds[i].revents != 0 )
+                break;
+
+            it++;
+        }
+
+        if( it == children.end( ) )
+            it = children.begin( );
+    }
+
+    std::string result;
+    char buffer[4096];
+    ssize_t bytes;
+
+    while( ( bytes = read( it->second, buffer, sizeof(buffer) ) ) != 0 )
+    {
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes < 0 )
+            break;
+
+        result.append( buffer, static_cast<size_t>( bytes ) );
+    }
+
+    close( it->second );
+    waitpid( it->first, NULL, 0 );
+
+    if( !results.Decode( result ) )
+        std::cout << "Warning: A sample window process returned no results." 
+                  << std::endl;
+
+    children.erase( it );
+}
+
+/*
+ *  Runs one sample window in detail from the current cycle. The trace cycles
+ *  are taken relative to the window's first line, since no time passes
+ *  while fast-forwarding. Stats are reset when measuring starts, after the
+ *  first warmup lines, and the window is drained before it is measured.
+ */
+bool TraceMain::RunWindow( std::vector<TraceLine *>& lines, size_t count, 
+                           size_t warmup, GlobalEventQueue *globalEventQueue, 
+                           bool ignoreData, bool ignoreTraceCycle,
+                           std::vector<std::pair<StatBase *, size_t> >& sampleStats,
+                           std::vector<double>& values )
+{
+    ncycle_t windowStart = globalEventQueue->GetCurrentCycle( );
+    ncycle_t traceStart = lines[0]->GetCycle( );
+
+    measuring = false;
+    measuredRequests = 0;
+    measuredLatency = 0.0;
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( i == warmup )
+        {
+            GetStats( )->ResetAll( );
+
+            measuring = true;
+            measureStart = GetEventQueue( )->GetCurrentCycle( );
+            lastCompletion = measureStart;
+        }
+
+        if( !ignoreTraceCycle && lines[i]->GetCycle( ) > traceStart )
+        {
+            ncycle_t issueCycle = windowStart + lines[i]->GetCycle( ) - traceStart;
+
+            if( issueCycle > globalEventQueue->GetCurrentCycle( ) )
+                globalEventQueue->Cycle( issueCycle - globalEventQueue->GetCurrentCycle( ) );
+        }
+
+        NVMainRequest *request = MakeRequest( lines[i], ignoreData );
+
+        while( !GetChild( )->IsIssuable( request ) )
+            globalEventQueue->Cycle( 1 );
+
+        /* Not every controller sets this, and latency is measured from it. */
+        request->arrivalCycle = GetEventQueue( )->GetCurrentCycle( );
+
+        outstandingRequests++;
+        GetChild( )->IssueCommand( request );
+    }
+
+    while( outstandingRequests > 0 )
+        globalEventQueue->Cycle( 1 );
+
+    measuring = false;
+
+    if( measuredRequests == 0 )
+        return false;
+
+    values.clear( );
+    values.push_back( measuredLatency / static_cast<double>( measuredRequests ) );
+    values.push_back( static_cast<double>( lastCompletion - measureStart ) 
+                      / static_cast<double>( measuredRequests ) );
+
+    GetChild( )->CalculateStats( );
+
+    for( size_t i = 0; i < sampleStats.size( ); i++ )
+        values.push_back( sampleStats[i].first->GetColumn( sampleStats[i].second ) );
+
+    return true;
+}
+
+NVMainRequest *TraceMain::MakeRequest( TraceLine *tl, bool ignoreData )
+{
+    NVMainRequest *request = new NVMainRequest( );
+    
+    request->address = tl->GetAddress( );
+    request->type = tl->GetOperation( );
+    request->bulkCmd = CMD_NOP;
+    request->threadId = tl->GetThreadId( );
+    if( !ignoreData ) request->data = tl->GetData( );
+    if( !ignoreData ) request->oldData = tl->GetOldData( );
+    request->status = MEM_REQUEST_INCOMPLETE;
+    request->owner = (NVMObject *)this;
+    
+    // commented by MSON
+    //FIXMEif( request->type != READ && request->type != WRITE )
+    //FIXME    std::cout << "traceMain: Unknown Operation: " << request->type 
+    //FIXME        << std::endl;
+    
+    // added by MSON
+    if (request->type == NOT_IN_ARRAY || request->type == AND_IN_ARRAY || request->type == AND_IN_LATCH || request->type == OR_IN_LATCH 
+            || request->type == NAND_IN_LATCH || request->type == NOR_IN_LATCH || request->type == XOR_IN_LATCH)
+    {
+        //FIXMEstd::cout << "traceMain received CIM request!" << std::endl;
+        request->isCIM = true;
+        request->cimOperandRows = tl->GetOperandRows( );
+        switch (request->type)
+        {
+            case NOT_IN_ARRAY:
+                request->type = READ;
+                request->isNOT_IN_ARRAY = true;
+                break;
+            case AND_IN_ARRAY:
+                request->type = READ;
+                request->isAND_IN_ARRAY = true;
+                break;
+            case AND_IN_LATCH:
+                request->type = READ;
+                request->isAND_IN_LATCH = true;
+                break;
+            case OR_IN_LATCH:
+                request->type = READ;
+                request->isOR_IN_LATCH = true;
+                break;
+            case NAND_IN_LATCH:
+                request->type = READ;
+                request->isNAND_IN_LATCH = true;
+                break;
+            case NOR_IN_LATCH:
+                request->type = READ;
+                request->isNOR_IN_LATCH = true;
+                break;
+            case XOR_IN_LATCH:
+                request->type = READ;
+                request->isXOR_IN_LATCH = true;
+                break;
+            default:
+                std::cout << "traceMain: CIM request type is not supported: " << request->type << std::endl; 
+        }
+    }
+
+    return request;
+}
+
+/*
+ *  Hooks that issue requests of their own, e.g. to move a Start-Gap gap,
+ *  report whether any are still in flight.
+ */
+bool TraceMain::HooksIdle( )
+{
+    std::vector<NVMObject *>::iterator it;
+
+    for( int i = 0; i < static_cast<int>(NVMHOOK_COUNT); i++ )
+    {
+        std::vector<NVMObject *>& hookList = GetHooks( static_cast<HookType>(i) );
+
+        for( it = hookList.begin( ); it != hookList.end( ); it++ )
+        {
+            if( !(*it)->Idle( ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
 void TraceMain::Cycle( ncycle_t /*steps*/ )
 {
 
@@ -366,6 +1150,13 @@ bool TraceMain::RequestComplete( NVMainRequest* request )
 
     outstandingRequests--;
 
+    if( measuring && request->arrivalCycle >= measureStart )
+    {
+        lastCompletion = GetEventQueue( )->GetCurrentCycle( );
+        measuredLatency += static_cast<double>( lastCompletion - request->arrivalCycle );
+        measuredRequests++;
+    }
+
     delete request;
 
     return true;
@@ -39,10 +39,39 @@
 
 #include "src/NVMObject.h"
 
+#include <sys/types.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
 
 namespace NVM {
 
 
+class Config;
+class DecodedTrace;
+class GenericTraceReader;
+class GlobalEventQueue;
+class SampleResults;
+class TraceLine;
+
+/* Settings that make up one point of a configuration sweep. */
+typedef std::vector<std::pair<std::string, std::string> > SweepPoint;
+
+struct SweepJob
+{
+    Config *baseConfig;
+    const DecodedTrace *trace;
+    uint64_t simulateCycles;
+    std::string outputPrefix;
+    std::vector<SweepPoint> points;
+    std::atomic<size_t> nextPoint;
+};
+
 class TraceMain : public NVMObject
 {
   public:
@@ -50,6 +79,8 @@ class TraceMain : public NVMObject
     ~TraceMain( );
 
     int RunTrace( int argc, char *argv[] );
+    int Simulate( Config *config, GenericTraceReader *trace, 
+                  uint64_t simulateCycles, std::ostream& statStream );
 
     void Cycle( ncycle_t steps );
 
@@ -57,6 +88,32 @@ class TraceMain : public NVMObject
 
   private:
     ncounter_t outstandingRequests;
+
+    /* Latency of the requests issued while a sample window is measured. */
+    bool measuring;
+    ncycle_t measureStart;
+    ncycle_t lastCompletion;
+    ncounter_t measuredRequests;
+    double measuredLatency;
+
+    static std::mutex setupMutex;
+
+    NVMainRequest *MakeRequest( TraceLine *tl, bool ignoreData );
+    bool HooksIdle( );
+
+    int SimulateSampled( Config *config, GenericTraceReader *trace, 
+                         GlobalEventQueue *globalEventQueue, 
+                         uint64_t simulateCycles, bool ignoreData, 
+                         bool ignoreTraceCycle, std::ostream& statStream );
+    bool RunWindow( std::vector<TraceLine *>& lines, size_t count, 
+                    size_t warmup, GlobalEventQueue *globalEventQueue, 
+                    bool ignoreData, bool ignoreTraceCycle,
+                    std::vector<std::pair<StatBase *, size_t> >& sampleStats,
+                    std::vector<double>& values );
+    void CollectSample( std::map<pid_t, int>& children, SampleResults& results );
+
+    int RunSweep( Config *config, std::string traceFile, uint64_t simulateCycles );
+    static void SweepWorker( SweepJob *job );
 };
 
 